@@ -1,12 +1,30 @@
 #ifndef CAFFE_OCTREE_DATABASE_LAYER_HPP_
 #define CAFFE_OCTREE_DATABASE_LAYER_HPP_
 
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <deque>
+
 #include "caffe/layers/data_layer.hpp"
 
 namespace caffe {
 
 template <typename Dtype>
 class OctreeDataBaseLayer : public DataLayer<Dtype> {
+ public:
+  // the statistics of the prefetching, the times are in milliseconds
+  struct PrefetchStats {
+    int batch_num;        // the batches built by the loaders
+    int octree_num;       // the octrees in the batches
+    double read_time;     // reading the records from the database
+    double decode_time;   // parsing, decoding and cutting the octrees
+    double merge_time;    // merging the octrees and calculating the neighbors
+    int forward_num;      // the batches taken by Forward
+    double wait_time;     // waiting for the batches in Forward
+    double queue_size;    // the sum of the prefetched batches seen by Forward
+  };
+
  public:
   explicit OctreeDataBaseLayer(const LayerParameter& param);
   virtual ~OctreeDataBaseLayer();
@@ -19,10 +37,50 @@ class OctreeDataBaseLayer : public DataLayer<Dtype> {
       const vector<Blob<Dtype>*>& top);
   virtual void Forward_gpu(const vector<Blob<Dtype>*>& bottom,
       const vector<Blob<Dtype>*>& top);
+  PrefetchStats prefetch_stats() const;
 
  protected:
+  // the buffers of one loader thread
+  struct Loader {
+    int num;                          // the octrees in the batch
+    vector<string> keys;
+    vector<string> records;           // the records read from the database
+    vector<vector<char> > octrees;    // the decoded or cut octrees
+    vector<char> octree_tmp;
+    vector<const char*> octree_ptrs;  // the octrees to be merged
+  };
+  // a record read from the database but not batched yet, refer to max_nodes
+  struct Record {
+    string key;
+    string value;
+    int node_num;
+  };
+
+  // The batches are built by loader_thread_num loaders. The records of the
+  // batches are read in turn, and the batches are pushed into prefetch_full_
+  // in the same order, so the order of the batches does not depend on the
+  // number of the loaders.
+  virtual void InternalThreadEntry();
+  // set up the Caffe context of the loader thread as InternalThread::entry
+  void LoaderThreadEntry(int id, Caffe::Brew mode, int device, int rand_seed,
+      int solver_count, int solver_rank, bool multiprocess);
+  void LoaderEntry(Loader& loader);
   virtual void load_batch(Batch<Dtype>* batch);
+  void ReadRecords(Loader& loader);
+  // read the records into the buckets until one of them is full, and move
+  // the records of that bucket into the loader
+  void PackRecords(Loader& loader);
+  void PopBucket(Loader& loader, const int b);
+  // the nodes of the octree at curr_depth_, the datum is converted into the
+  // raw octree record, so that it is parsed once
+  int NodeNum(Record& record);
+  void BuildBatch(Loader& loader, Batch<Dtype>* batch);
+  // return the consumed batch and take the next prefetched one
+  void FetchBatch();
   int RandDropDepth();
+  int BatchIndex(const Batch<Dtype>* batch) const;
+  // calculate the neighbors needed by the net which are missing in the batch
+  void UpdateNeighbor(Batch<Dtype>* batch);
 
  protected:
   // extract the feature from the deepest octree nodes
@@ -36,8 +94,27 @@ class OctreeDataBaseLayer : public DataLayer<Dtype> {
   int signal_channel_;
   bool output_octree_;
   unsigned int rand_skip_;
+  int load_flag_;       // the merged properties, -1 means all of them
+  int load_depth_;      // the depth the octrees are cut to, 0 means no cut
+  int max_nodes_;       // the nodes in a batch, 0 means batch_size_ octrees
+
+  vector<Loader> loaders_;
+  boost::mutex read_mutex_;        // guards the cursor and read_seq_
+  int read_seq_;                   // the sequence number of the next batch read
+  vector<std::deque<Record> > buckets_;  // guarded by read_mutex_
+  vector<int> bucket_nodes_;       // the nodes of the records in each bucket
+  boost::mutex push_mutex_;
+  boost::condition_variable push_cv_;
+  int push_seq_;                   // the sequence number of the next batch pushed
+
+  mutable boost::mutex stats_mutex_;
+  PrefetchStats stats_;
 
-  vector<vector<char> > octree_buffer_;
+  // the depths of the neighbors calculated in load_batch (bit d for the depth
+  // d), which are learned from the layers of the net in the first forward,
+  // and the depths with valid neighbors of each prefetch batch
+  std::atomic<int> neigh_mask_;
+  vector<int> batch_neigh_mask_;
 
   // dropout
   //bool dropout_;
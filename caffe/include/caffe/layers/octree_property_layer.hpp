@@ -45,6 +45,8 @@ class OctreePropertyLayer : public Layer<Dtype> {
   int signal_channel_;
   vector<OctreeInfo::PropType> ptypes_;
   OctreeParser octree_batch_;
+  // the dequantized fp16 or int8/int16 data properties
+  vector<shared_ptr<Blob<Dtype> > > data_buffer_;
 };
 
 }  // namespace caffe
@@ -0,0 +1,190 @@
+#ifndef CAFFE_UTIL_MORTON_HPP_
+#define CAFFE_UTIL_MORTON_HPP_
+
+// Morton (z-order) encoding of the octree keys, keep in sync with
+// ocnn/octree/include/octree/morton.h. The key of a node at depth d
+// interleaves the bits of its coordinates as ...x1y1z1x0y0z0, i.e. the bit i
+// of x/y/z goes to the bit 3i+2/3i+1/3i of the key, so that a 32-bit key can
+// hold at most 10 levels. The *64 functions work on 64-bit keys, which can
+// hold at most 21 levels.
+//
+// The scalar functions use the BMI2 instructions pdep/pext when the compiler
+// targets them (-mbmi2 or -march=native), and the branch-free shift-and-mask
+// sequence otherwise. The batched functions always use the shift-and-mask
+// sequence, which the compiler can vectorize.
+
+#include <cstdint>
+
+#if defined(__BMI2__) && !defined(__CUDA_ARCH__)
+#include <immintrin.h>
+#define CAFFE_MORTON_USE_BMI2
+#endif
+
+#ifdef __CUDACC__
+#define CAFFE_MORTON_FUNC __host__ __device__ inline
+#else
+#define CAFFE_MORTON_FUNC inline
+#endif
+
+namespace caffe {
+namespace octree {
+
+// spread the lower 10 bits of v, inserting two 0 bits between every two bits
+CAFFE_MORTON_FUNC uint32_t morton_spread(uint32_t v) {
+  v &= 0x000003FFu;
+  v = (v | (v << 16)) & 0x030000FFu;
+  v = (v | (v <<  8)) & 0x0300F00Fu;
+  v = (v | (v <<  4)) & 0x030C30C3u;
+  v = (v | (v <<  2)) & 0x09249249u;
+  return v;
+}
+
+// the inverse of morton_spread: gather every third bit of v
+CAFFE_MORTON_FUNC uint32_t morton_compact(uint32_t v) {
+  v &= 0x09249249u;
+  v = (v ^ (v >>  2)) & 0x030C30C3u;
+  v = (v ^ (v >>  4)) & 0x0300F00Fu;
+  v = (v ^ (v >>  8)) & 0x030000FFu;
+  v = (v ^ (v >> 16)) & 0x000003FFu;
+  return v;
+}
+
+// x, y, z should be less than 1024
+CAFFE_MORTON_FUNC uint32_t morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+#ifdef CAFFE_MORTON_USE_BMI2
+  return _pdep_u32(x, 0x24924924u) | _pdep_u32(y, 0x12492492u) |
+      _pdep_u32(z, 0x09249249u);
+#else
+  return (morton_spread(x) << 2) | (morton_spread(y) << 1) | morton_spread(z);
+#endif
+}
+
+CAFFE_MORTON_FUNC void morton_decode(uint32_t key, uint32_t& x, uint32_t& y, uint32_t& z) {
+#ifdef CAFFE_MORTON_USE_BMI2
+  x = _pext_u32(key, 0x24924924u);
+  y = _pext_u32(key, 0x12492492u);
+  z = _pext_u32(key, 0x09249249u);
+#else
+  x = morton_compact(key >> 2);
+  y = morton_compact(key >> 1);
+  z = morton_compact(key);
+#endif
+}
+
+// the max depth of the keys encoded by the 32-bit functions
+const int kMortonDepth32 = 10;
+
+// spread the lower 21 bits of v, inserting two 0 bits between every two bits
+CAFFE_MORTON_FUNC uint64_t morton_spread64(uint64_t v) {
+  v &= 0x00000000001FFFFFull;
+  v = (v | (v << 32)) & 0x001F00000000FFFFull;
+  v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+  v = (v | (v <<  8)) & 0x100F00F00F00F00Full;
+  v = (v | (v <<  4)) & 0x10C30C30C30C30C3ull;
+  v = (v | (v <<  2)) & 0x1249249249249249ull;
+  return v;
+}
+
+CAFFE_MORTON_FUNC uint64_t morton_compact64(uint64_t v) {
+  v &= 0x1249249249249249ull;
+  v = (v ^ (v >>  2)) & 0x10C30C30C30C30C3ull;
+  v = (v ^ (v >>  4)) & 0x100F00F00F00F00Full;
+  v = (v ^ (v >>  8)) & 0x001F0000FF0000FFull;
+  v = (v ^ (v >> 16)) & 0x001F00000000FFFFull;
+  v = (v ^ (v >> 32)) & 0x00000000001FFFFFull;
+  return v;
+}
+
+// x, y, z should be less than 2^21
+CAFFE_MORTON_FUNC uint64_t morton_encode64(uint32_t x, uint32_t y, uint32_t z) {
+#ifdef CAFFE_MORTON_USE_BMI2
+  return _pdep_u64(x, 0x4924924924924924ull) |
+      _pdep_u64(y, 0x2492492492492492ull) | _pdep_u64(z, 0x1249249249249249ull);
+#else
+  return (morton_spread64(x) << 2) | (morton_spread64(y) << 1) | morton_spread64(z);
+#endif
+}
+
+CAFFE_MORTON_FUNC void morton_decode64(uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z) {
+#ifdef CAFFE_MORTON_USE_BMI2
+  x = static_cast<uint32_t>(_pext_u64(key, 0x4924924924924924ull));
+  y = static_cast<uint32_t>(_pext_u64(key, 0x2492492492492492ull));
+  z = static_cast<uint32_t>(_pext_u64(key, 0x1249249249249249ull));
+#else
+  x = static_cast<uint32_t>(morton_compact64(key >> 2));
+  y = static_cast<uint32_t>(morton_compact64(key >> 1));
+  z = static_cast<uint32_t>(morton_compact64(key));
+#endif
+}
+
+// only the lower `depth` bits of pt[0], pt[1], pt[2] are encoded
+CAFFE_MORTON_FUNC uint32_t morton_encode(const uint32_t* pt, const int depth) {
+  const uint32_t mask = (1u << depth) - 1u;
+  return morton_encode(pt[0] & mask, pt[1] & mask, pt[2] & mask);
+}
+
+// only the lower `3 * depth` bits of the key are decoded
+CAFFE_MORTON_FUNC void morton_decode(uint32_t* pt, const uint32_t key, const int depth) {
+  morton_decode(key & ((1u << 3 * depth) - 1u), pt[0], pt[1], pt[2]);
+}
+
+CAFFE_MORTON_FUNC uint64_t morton_encode64(const uint32_t* pt, const int depth) {
+  const uint32_t mask = (1u << depth) - 1u;
+  return morton_encode64(pt[0] & mask, pt[1] & mask, pt[2] & mask);
+}
+
+CAFFE_MORTON_FUNC void morton_decode64(uint32_t* pt, const uint64_t key, const int depth) {
+  morton_decode64(key & ((1ull << 3 * depth) - 1ull), pt[0], pt[1], pt[2]);
+}
+
+// batched version: pt is an array of num x 3 coordinates
+inline void morton_encode(uint32_t* key, const uint32_t* pt, const int num,
+    const int depth) {
+  const uint32_t mask = (1u << depth) - 1u;
+  for (int i = 0; i < num; ++i) {
+    key[i] = (morton_spread(pt[3 * i] & mask) << 2) |
+        (morton_spread(pt[3 * i + 1] & mask) << 1) |
+        morton_spread(pt[3 * i + 2] & mask);
+  }
+}
+
+inline void morton_decode(uint32_t* pt, const uint32_t* key, const int num,
+    const int depth) {
+  const uint32_t mask = (1u << 3 * depth) - 1u;
+  for (int i = 0; i < num; ++i) {
+    const uint32_t k = key[i] & mask;
+    pt[3 * i] = morton_compact(k >> 2);
+    pt[3 * i + 1] = morton_compact(k >> 1);
+    pt[3 * i + 2] = morton_compact(k);
+  }
+}
+
+// the key type of the 64-bit batched functions is a template parameter, since
+// uint64_t and unsigned long long are distinct types on some platforms
+template <typename Key>
+inline void morton_encode64(Key* key, const uint32_t* pt, const int num,
+    const int depth) {
+  const uint32_t mask = (1u << depth) - 1u;
+  for (int i = 0; i < num; ++i) {
+    key[i] = (morton_spread64(pt[3 * i] & mask) << 2) |
+        (morton_spread64(pt[3 * i + 1] & mask) << 1) |
+        morton_spread64(pt[3 * i + 2] & mask);
+  }
+}
+
+template <typename Key>
+inline void morton_decode64(uint32_t* pt, const Key* key, const int num,
+    const int depth) {
+  const uint64_t mask = (1ull << 3 * depth) - 1ull;
+  for (int i = 0; i < num; ++i) {
+    const uint64_t k = key[i] & mask;
+    pt[3 * i] = static_cast<uint32_t>(morton_compact64(k >> 2));
+    pt[3 * i + 1] = static_cast<uint32_t>(morton_compact64(k >> 1));
+    pt[3 * i + 2] = static_cast<uint32_t>(morton_compact64(k));
+  }
+}
+
+} // namespace octree
+} // namespace caffe
+
+#endif // CAFFE_UTIL_MORTON_HPP_
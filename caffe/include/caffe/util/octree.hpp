@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_map>
 #include "caffe/blob.hpp"
+#include "caffe/util/morton.hpp"
 #include "caffe/util/octree_info.hpp"
 #include "caffe/util/octree_parser.hpp"
 
@@ -32,6 +33,14 @@ class Octree {
   static shared_ptr<Blob<float> > get_workspace(float, int id = 0);
   static shared_ptr<Blob<double> > get_workspace(double, int id = 0);
   static shared_ptr<Blob<int> > get_ni(const vector<int>& kernel_size);
+  // the neighbors of a full layer of one octree, which only depend on the
+  // depth and are computed on the first call
+  static const vector<int>& get_full_neigh(int depth);
+  // the layers reading the neighbors of the octree declare the depths when
+  // they are set up, so that the data layers only calculate those neighbors;
+  // the mask holds the bit d for the depth d, 0 means no layer declared it
+  static void add_neigh_depth(int depth) { Get().neigh_mask_ |= 1 << depth; }
+  static int get_neigh_depth_mask() { return Get().neigh_mask_; }
 
  protected:
   void init_neigh_index();
@@ -41,6 +50,7 @@ class Octree {
   int curr_depth_;
   int batch_size_;
   int workspace_sz_;
+  int neigh_mask_;
   Blob<float> octree_;
   Blob<double> octreed_;
 
@@ -51,6 +61,8 @@ class Octree {
   // used to calculate the neighbor information
   Blob<int> parent_;
   Blob<int> displacement_;
+  // the cached neighbors of the full layers, indexed by depth
+  vector<vector<int> > full_neigh_;
 
   // workspace is used as the temporary buffer of
   // gemm in octree_base_conv to save memory.
@@ -60,11 +72,27 @@ class Octree {
  private:
   // The private constructor to avoid duplicate instantiation.
   Octree() : depth_(0), curr_depth_(0), batch_size_(1), workspace_sz_(256 * 1024 * 1024),
-    octree_(), parent_(), displacement_(), workspace_(), workspaced_() { init_neigh_index(); }
+    neigh_mask_(0), octree_(), parent_(), displacement_(), workspace_(), workspaced_() { init_neigh_index(); }
 };
 
 namespace octree {
 
+// The keys stored in the octree blobs pack the xyz coordinates and the batch
+// index: 8 bits each in the 32-bit keys (key channel 1), and 16 bits each in
+// the 64-bit keys (key channel 2), which are used when the depth is larger
+// than 8 or the batch size is larger than 256. The functions handling keys
+// are instantiated for both key types.
+template <typename Key> struct KeyTrait {};
+template <> struct KeyTrait<unsigned int> {
+  typedef unsigned char Coord;
+};
+template <> struct KeyTrait<unsigned long long> {
+  typedef unsigned short Coord;
+};
+inline int key_channel(const int depth, const int batch_size) {
+  return (depth > 8 || batch_size > 256) ? 2 : 1;
+}
+
 template<typename Dtype>
 void pad_forward_cpu(Dtype* Y, const int Hy,
     const int Cy, const Dtype* X, const int Hx, const int* label);
@@ -106,19 +134,45 @@ void calc_neigh_gpu(int* neigh_split, const int* neigh,
     const int* children, const int node_num);
 void calc_neigh_cpu(int* neigh, const int depth, const int batch_size);
 void calc_neigh_gpu(int* neigh, const int depth, const int batch_size);
+// The depths whose neighbors are needed to get the ones at the depths in
+// neigh_mask (bit d for the depth d): the neighbors below the full layer are
+// derived from the ones of the parent depth
+int neigh_depth_closure(const int neigh_mask, const int depth, const int full_layer);
+// calculate the neighbors of the octree at the depths in neigh_mask which are
+// not in done_mask, return the depths with valid neighbors afterwards
+int update_neigh_cpu(OctreeParser& octree, const int neigh_mask,
+    const int done_mask = 0);
 // calculate neighborhood information with the hash table
-void calc_neighbor(int* neigh, const unsigned* key, const int node_num,
+template <typename Key>
+void calc_neighbor(int* neigh, const Key* key, const int node_num,
     const int displacement = 0);
 
-void generate_key_gpu(unsigned int* key_split, const unsigned int* key,
+template <typename Key>
+void generate_key_gpu(Key* key_split, const Key* key,
     const int* children, const int node_num);
-void generate_key_cpu(unsigned int* key_split, const unsigned int* key,
+template <typename Key>
+void generate_key_cpu(Key* key_split, const Key* key,
     const int* children, const int node_num);
-void generate_key_gpu(unsigned int* key, const int depth, const int batch_size);
-void generate_key_cpu(unsigned int* key, const int depth, const int batch_size);
-
-void xyz2key_cpu(unsigned int* key, const unsigned int* xyz, const int num, const int depth);
-void xyz2key_gpu(unsigned int* key, const unsigned int* xyz, const int num, const int depth);
+template <typename Key>
+void generate_key_gpu(Key* key, const int depth, const int batch_size);
+template <typename Key>
+void generate_key_cpu(Key* key, const int depth, const int batch_size);
+
+template <typename Key>
+void xyz2key_cpu(Key* key, const Key* xyz, const int num, const int depth);
+
+// Copy num keys of the batch_idx^th octree into a merged batch, and set the
+// batch index in the highest Coord of the output keys. The input keys have
+// key_channel_in and the output keys have key_channel (1: 32 bits, 2: 64 bits).
+// When 32-bit keys are widened, the xyz bytes of key2xyz keys are widened to
+// shorts, and the bits of Morton keys are kept. The Morton key of an octree of
+// depth d takes the lower 3 * d bits, which are below the batch index since d
+// is at most 8 for the 32-bit output and at most 13 for the 64-bit output.
+void merge_keys_cpu(unsigned int* des, const int key_channel,
+    const unsigned int* src, const int key_channel_in, const int num,
+    const int batch_idx, const bool key2xyz);
+template <typename Key>
+void xyz2key_gpu(Key* key, const Key* xyz, const int num, const int depth);
 
 template <typename Dtype>
 void generate_label_cpu(int* label_data, int& top_h, const Dtype* bottom_data,
@@ -127,9 +181,6 @@ template <typename Dtype>
 void generate_label_gpu(int* label_data, int& top_h, const Dtype* bottom_data,
     const int bottom_h, const int mask);
 
-inline void compute_key(unsigned int& key, const unsigned int* pt, const int depth);
-inline void compute_pt(unsigned int* pt, const unsigned int& key, const int depth);
-
 void octree_dropout(vector<char>& octree_output, const string& octree_input,
     const int depth_dropout, const float threshold = 0.5f, const int channel = 3);
 void aoctree_dropout(vector<char>& octree_output, const string& octree_input,
@@ -137,17 +188,37 @@ void aoctree_dropout(vector<char>& octree_output, const string& octree_input,
 
 template <typename Dtype>
 void merge_octrees(Blob<Dtype>& octree_output,  const vector<vector<char> >& octrees);
+// the same as above, but the octrees are merged from where they are stored,
+// and the neighbors are only calculated at the depths in neigh_mask (refer to
+// update_neigh_cpu), the others are left as they are; only the properties in
+// content_flags (refer to content_flag) besides key and child are merged, the
+// others are left out of the batch
+template <typename Dtype>
+void merge_octrees(Blob<Dtype>& octree_output, const vector<const char*>& octrees,
+    const int neigh_mask = -1, const int content_flags = -1);
 
 template <typename Dtype>
 void set_octree_parser(OctreeParser& octree_parser, const Blob<Dtype>& octree_in);
 
-void search_key_cpu(int* idx, const int unsigned* key, const int n_key,
-    const unsigned int* query, const int n_query);
-void search_key_gpu(int* idx, const int unsigned* key, const int n_key,
-    const unsigned int* query, const int n_query);
+template <typename Key>
+void search_key_cpu(int* idx, const Key* key, const int n_key,
+    const Key* query, const int n_query);
+template <typename Key>
+void search_key_gpu(int* idx, const Key* key, const int n_key,
+    const Key* query, const int n_query);
 
 int content_flag(string str);
 
+// Cut the octree down to depth_out: the deeper layers are dropped, and the
+// nodes of depth_out become the leaves. The properties at all depths are
+// sliced; the ones only at the finest depth are pooled to depth_out, i.e. the
+// features are averaged and the labels are voted over the non-empty finest
+// nodes covered, and the split labels are recomputed from the structure. The
+// averaged normals, the first 3 feature channels, are renormalized, and the
+// node displacement can not be pooled.
+void truncate_octree(vector<char>& octree_out, const char* octree_in,
+    const int depth_out);
+
 } // namespace octree
 } // namespace caffe
 
@@ -0,0 +1,62 @@
+#ifndef CAFFE_UTIL_OCTREE_ARCHIVE_HPP_
+#define CAFFE_UTIL_OCTREE_ARCHIVE_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace caffe {
+namespace octree {
+
+// The reader of the octree archive written by the octree library
+// (ocnn/octree/include/octree/octree_archive.h), which packs many octrees
+// into one file: the header, the octrees, the index and the entry names.
+extern const char kArchiveMagicStr[16];
+
+struct ArchiveHeader {
+  char magic[16];
+  uint64_t index_offset;
+  int num;
+  int reserved;
+};
+
+struct ArchiveEntry {
+  uint64_t offset;
+  uint64_t size;
+  int label;
+  int pose;
+  int name_pos;
+  int name_len;
+};
+
+// the layout is shared with the archives written by the octree library
+static_assert(sizeof(ArchiveHeader) == 32, "The size of ArchiveHeader is changed");
+static_assert(sizeof(ArchiveEntry) == 32, "The size of ArchiveEntry is changed");
+
+class OctreeArchive {
+ public:
+  // load the index, the octrees are read on demand by read()
+  bool open(const string& filename);
+  void close();
+
+  int size() const { return static_cast<int>(entries_.size()); }
+  int label(const int i) const { return entries_[i].label; }
+  int pose(const int i) const { return entries_[i].pose; }
+  string name(const int i) const;
+  // read the i^th octree, which may be in the compact format
+  bool read(const int i, string& data);
+
+ protected:
+  std::ifstream infile_;
+  vector<ArchiveEntry> entries_;
+  string names_;
+};
+
+}  // namespace octree
+}  // namespace caffe
+
+#endif  // CAFFE_UTIL_OCTREE_ARCHIVE_HPP_
@@ -0,0 +1,32 @@
+#ifndef CAFFE_UTIL_OCTREE_CODEC_HPP_
+#define CAFFE_UTIL_OCTREE_CODEC_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "caffe/util/octree_info.hpp"
+
+using std::vector;
+
+namespace caffe {
+namespace octree {
+
+// The decoder of the compact octree format written by the octree library
+// (ocnn/octree/include/octree/octree_codec.h): the structure is stored as
+// the occupancy masks of 8 sibling nodes, and all data is range coded.
+extern const char kCompactMagicStr[16];
+
+// return true if the data starts with kCompactMagicStr
+bool is_compact_octree(const char* data, const size_t sz);
+
+// decode the compact octree into the original serialized layout
+bool decompress_octree(vector<char>& buffer, const char* data, const size_t sz);
+
+// read the header of the octree in the original or the compact format without
+// decoding it, return false if the data is too short
+bool read_octree_info(OctreeInfo& info, const char* data, const size_t sz);
+
+}  // namespace octree
+}  // namespace caffe
+
+#endif  // CAFFE_UTIL_OCTREE_CODEC_HPP_
@@ -34,6 +34,7 @@ class OctreeParser {
 
   const char* ptr_cpu(const PropType ptype, const int depth) const;
   const unsigned int* key_cpu(const int depth) const;
+  const uint64* key64_cpu(const int depth) const;  // when the key channel is 2
   const int* children_cpu(const int depth) const;
   const int* neighbor_cpu(const int depth) const;
   const float* feature_cpu(const int depth) const;
@@ -42,6 +43,7 @@ class OctreeParser {
 
   const char* ptr_gpu(const PropType ptype, const int depth) const;
   const unsigned int* key_gpu(const int depth) const;
+  const uint64* key64_gpu(const int depth) const;
   const int* children_gpu(const int depth) const;
   const int* neighbor_gpu(const int depth) const;
   const float* feature_gpu(const int depth) const;
@@ -50,6 +52,7 @@ class OctreeParser {
 
   char* mutable_ptr_cpu(const PropType ptype, const int depth);
   unsigned int* mutable_key_cpu(const int depth);
+  uint64* mutable_key64_cpu(const int depth);
   int* mutable_children_cpu(const int depth);
   int* mutable_neighbor_cpu(const int depth);
   float* mutable_feature_cpu(const int depth);
@@ -58,6 +61,7 @@ class OctreeParser {
 
   char* mutable_ptr_gpu(const PropType ptype, const int depth);
   unsigned int* mutable_key_gpu(const int depth);
+  uint64* mutable_key64_gpu(const int depth);
   int* mutable_children_gpu(const int depth);
   int* mutable_neighbor_gpu(const int depth);
   float* mutable_feature_gpu(const int depth);
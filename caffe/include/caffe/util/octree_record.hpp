@@ -0,0 +1,36 @@
+#ifndef CAFFE_UTIL_OCTREE_RECORD_HPP_
+#define CAFFE_UTIL_OCTREE_RECORD_HPP_
+
+#include <cstddef>
+#include <string>
+
+using std::string;
+
+namespace caffe {
+namespace octree {
+
+// The raw database record of an octree: a RecordHeader followed by the octree
+// bytes, which replaces the Datum protobuf so that the octree can be merged
+// from the record without parsing and copying it. The header is 16 bytes, so
+// the octree keeps the alignment of the record. The magic string is never the
+// start of a serialized Datum ('_' is an invalid protobuf tag), so both kinds
+// of records can be told apart in one database.
+extern const char kRecordMagicStr[8];
+
+struct RecordHeader {
+  char magic[8];
+  int label;
+  int size;     // the size of the octree in bytes
+};
+
+void pack_octree_record(string& record, const char* octree, const int size,
+    const int label);
+
+// return false if the record is not a raw octree record
+bool parse_octree_record(const char* record, const size_t record_size,
+    const char** octree, int* size, int* label);
+
+}  // namespace octree
+}  // namespace caffe
+
+#endif  // CAFFE_UTIL_OCTREE_RECORD_HPP_
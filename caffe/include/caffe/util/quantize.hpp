@@ -0,0 +1,144 @@
+#ifndef CAFFE_UTIL_QUANTIZE_HPP_
+#define CAFFE_UTIL_QUANTIZE_HPP_
+
+// The element types of the data properties of the octree. The integer types
+// store round((value - offset) / scale), and are dequantized as
+// element * scale + offset. On the host, the fp16 values are converted with
+// the F16C and AVX instructions when the compiler targets both (-mf16c -mavx
+// or -march=native), and with the bit manipulations otherwise.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__F16C__) && defined(__AVX__) && !defined(__CUDA_ARCH__)
+#include <immintrin.h>
+#define CAFFE_QUANTIZE_USE_F16C
+#endif
+
+#ifdef __CUDACC__
+#define CAFFE_QUANTIZE_FUNC __host__ __device__ inline
+#else
+#define CAFFE_QUANTIZE_FUNC inline
+#endif
+
+namespace caffe {
+namespace octree {
+
+enum DataType { kFloat32 = 0, kFloat16 = 1, kInt16 = 2, kInt8 = 3 };
+const int kDataTypeNum = 4;
+
+CAFFE_QUANTIZE_FUNC int sizeof_dtype(const DataType dtype) {
+  return dtype == kFloat32 ? 4 : (dtype == kInt8 ? 1 : 2);
+}
+
+// the largest magnitude of the integer types
+CAFFE_QUANTIZE_FUNC int dtype_max(const DataType dtype) {
+  return dtype == kInt8 ? 127 : 32767;
+}
+
+CAFFE_QUANTIZE_FUNC float half_to_float(const uint16_t h) {
+  const uint32_t shifted_exp = 0x7C00u << 13;
+  uint32_t u = (h & 0x7FFFu) << 13;
+  const uint32_t exp = u & shifted_exp;
+  u += (127u - 15u) << 23;
+  if (exp == shifted_exp) {
+    u += (128u - 16u) << 23;           // Inf/NaN
+  } else if (exp == 0) {
+    u += 1u << 23;                     // denormal: renormalize
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    f -= 6.103515625e-05f;             // 2^-14
+    memcpy(&u, &f, sizeof(u));
+  }
+  u |= static_cast<uint32_t>(h & 0x8000u) << 16;
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// round to the nearest even
+CAFFE_QUANTIZE_FUNC uint16_t float_to_half(const float val) {
+  const uint32_t f32_inf = 255u << 23;
+  const uint32_t f16_max = (127u + 16) << 23;
+  const uint32_t denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+  uint32_t u;
+  memcpy(&u, &val, sizeof(u));
+  const uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+
+  uint16_t h;
+  if (u >= f16_max) {
+    h = u > f32_inf ? 0x7E00 : 0x7C00;  // NaN or Inf
+  } else if (u < (113u << 23)) {
+    float f, magic;
+    memcpy(&f, &u, sizeof(f));
+    memcpy(&magic, &denorm_magic, sizeof(magic));
+    f += magic;
+    memcpy(&u, &f, sizeof(u));
+    h = static_cast<uint16_t>(u - denorm_magic);
+  } else {
+    uint32_t mant_odd = (u >> 13) & 1u;
+    u += ((15u - 127u) << 23) + 0xFFFu;
+    u += mant_odd;
+    h = static_cast<uint16_t>(u >> 13);
+  }
+  return h | static_cast<uint16_t>(sign >> 16);
+}
+
+// the i^th element of src converted to float
+CAFFE_QUANTIZE_FUNC float dequantize_one(const void* src, const int i,
+    const DataType dtype, const float scale, const float offset) {
+  switch (dtype) {
+    case kFloat16: return half_to_float(static_cast<const uint16_t*>(src)[i]);
+    case kInt16: return static_cast<const int16_t*>(src)[i] * scale + offset;
+    case kInt8: return static_cast<const int8_t*>(src)[i] * scale + offset;
+    default: return static_cast<const float*>(src)[i];
+  }
+}
+
+// convert num elements of the type dtype in src to Dtype
+template <typename Dtype>
+void dequantize_cpu(Dtype* des, const void* src, const int num,
+    const DataType dtype, const float scale, const float offset) {
+  int i = 0;
+  switch (dtype) {
+    case kFloat16: {
+      const uint16_t* s = static_cast<const uint16_t*>(src);
+#ifdef CAFFE_QUANTIZE_USE_F16C
+      float buf[8];
+      for (; i + 8 <= num; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        _mm256_storeu_ps(buf, _mm256_cvtph_ps(h));
+        for (int k = 0; k < 8; ++k) des[i + k] = buf[k];
+      }
+#endif
+      for (; i < num; ++i) des[i] = half_to_float(s[i]);
+      break;
+    }
+    case kInt16: {
+      const int16_t* s = static_cast<const int16_t*>(src);
+      for (; i < num; ++i) des[i] = s[i] * scale + offset;
+      break;
+    }
+    case kInt8: {
+      const int8_t* s = static_cast<const int8_t*>(src);
+      for (; i < num; ++i) des[i] = s[i] * scale + offset;
+      break;
+    }
+    default: {
+      const float* s = static_cast<const float*>(src);
+      for (; i < num; ++i) des[i] = s[i];
+      break;
+    }
+  }
+}
+
+template <typename Dtype>
+void dequantize_gpu(Dtype* des, const void* src, const int num,
+    const DataType dtype, const float scale, const float offset);
+
+} // namespace octree
+} // namespace caffe
+
+#endif // CAFFE_UTIL_QUANTIZE_HPP_
@@ -0,0 +1,63 @@
+#ifndef CAFFE_UTIL_THREAD_POOL_HPP_
+#define CAFFE_UTIL_THREAD_POOL_HPP_
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace caffe {
+
+// A pool of persistent threads for the data parallel loops of the octree
+// utilities, which avoids creating and joining threads on every call. The
+// calling thread works together with the pool, and the tasks are handed out
+// one by one, so that the threads are balanced if the tasks are uneven.
+// Run() can be called from several threads at once, e.g. by the prefetching
+// threads of different data layers; the calls are queued as jobs, and the
+// idle workers help with the oldest job that still has tasks left.
+class ThreadPool {
+ public:
+  // thread_num includes the calling thread, so thread_num - 1 threads are
+  // created; 0 means the number of the hardware threads
+  explicit ThreadPool(int thread_num = 0);
+  ~ThreadPool();
+
+  int thread_num() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Call fn(t) for each t in [0, task_num), and return when all of them are
+  // done. The calling thread works on its own job only.
+  void Run(const int task_num, const std::function<void(int)>& fn);
+
+  // The pool shared by the octree utilities, which has at most 8 threads
+  // unless it is changed by SetGlobalThreadNum()
+  static std::shared_ptr<ThreadPool> Global();
+  static void SetGlobalThreadNum(const int thread_num);
+
+ protected:
+  struct Job {
+    Job(const int n, const std::function<void(int)>& f)
+      : fn(f), task_num(n), next_task(0), active(0) {}
+    const std::function<void(int)>& fn;
+    const int task_num;
+    std::atomic<int> next_task;
+    int active;                   // the workers running the tasks of the job
+  };
+
+  void WorkerLoop();
+  static void DoTasks(Job& job);
+  void RemoveJob(const std::shared_ptr<Job>& job);  // with mutex_ locked
+
+  std::vector<std::shared_ptr<boost::thread> > workers_;
+  boost::mutex mutex_;
+  boost::condition_variable cv_start_;
+  boost::condition_variable cv_done_;
+  std::list<std::shared_ptr<Job> > jobs_;  // the jobs with tasks left
+  bool stop_;
+};
+
+}  // namespace caffe
+
+#endif  // CAFFE_UTIL_THREAD_POOL_HPP_
@@ -40,6 +40,7 @@ void Octree2ColLayer<Dtype>::LayerSetUp(const vector<Blob<Dtype>*>& bottom,
       << "Error in " << this->layer_param_.name() << ": "
           << "The octree depth of bottom blob should be set coreectly.";
   curr_depth_ = this->layer_param_.octree_param().curr_depth();
+  Octree::add_neigh_depth(curr_depth_);
 
   // channels & kernel_dim_
   channels_ = bottom[0]->shape(1);
@@ -57,6 +57,12 @@ void OctreeBaseConvLayer<Dtype>::LayerSetUp(const vector<Blob<Dtype>*>& bottom,
   //	else Octree::set_curr_depth(curr_depth_ - 1);
   //}
 
+  // the neighbors used by octree2col, refer to workspace_depth_
+  if (!is_1x1_) {
+    bool upsample = is_deconvolution_layer() && stride_ == 2;
+    Octree::add_neigh_depth(upsample ? curr_depth_ + 1 : curr_depth_);
+  }
+
   // channels & num_output_
   channels_ = conv_in_channels_ = bottom[0]->shape(1);
   num_output_ = conv_out_channels_ = conv_param.num_output();
@@ -2,12 +2,16 @@
 #include "caffe/layers/octree_property_layer.hpp"
 #include "caffe/util/benchmark.hpp"
 #include "caffe/util/octree.hpp"
+#include "caffe/util/octree_codec.hpp"
+#include "caffe/util/octree_record.hpp"
+#include "caffe/util/thread_pool.hpp"
 
 namespace caffe {
 
 template <typename Dtype>
 OctreeDataBaseLayer<Dtype>::OctreeDataBaseLayer(const LayerParameter& param)
-  : DataLayer<Dtype>(param) {}
+  : DataLayer<Dtype>(param), read_seq_(0), push_seq_(0), stats_(),
+    neigh_mask_(-1) {}
 
 template <typename Dtype>
 OctreeDataBaseLayer<Dtype>::~OctreeDataBaseLayer() {
@@ -21,12 +25,44 @@ void OctreeDataBaseLayer<Dtype>::DataLayerSetUp(const vector<Blob<Dtype>*>& bott
   CHECK(this->layer_param_.has_octree_param()) << "The octree_param must be set";
   signal_channel_ = this->layer_param_.octree_param().signal_channel();
   curr_depth_ = this->layer_param_.octree_param().curr_depth();
+  load_flag_ = -1;
+  if (this->layer_param_.octree_param().has_load_flag()) {
+    // the keys, children and features are always needed by this layer
+    load_flag_ = octree::content_flag(this->layer_param_.octree_param().load_flag()) |
+        OctreeInfo::kKey | OctreeInfo::kChild | OctreeInfo::kFeature;
+  }
+  load_depth_ = this->layer_param_.octree_param().load_depth();
+  CHECK(load_depth_ == 0 || curr_depth_ <= load_depth_)
+      << "The curr_depth should not be larger than the load_depth";
+  const int merge_thread_num = this->layer_param_.octree_param().merge_thread_num();
+  if (merge_thread_num > 0) ThreadPool::SetGlobalThreadNum(merge_thread_num);
 
   rand_skip_ = this->layer_param_.data_param().rand_skip();
   batch_size_ = this->layer_param_.data_param().batch_size();
   CHECK_GT(batch_size_, 0) << "Positive batch size required";
   Octree::set_batchsize(batch_size_);
-  octree_buffer_.resize(batch_size_);
+  batch_neigh_mask_.assign(this->prefetch_.size(), 0);
+
+  // the octrees are packed by the nodes in buckets
+  max_nodes_ = this->layer_param_.octree_param().max_nodes();
+  const int bucket_num = this->layer_param_.octree_param().size_bucket_num();
+  CHECK(max_nodes_ > 0 || bucket_num <= 1)
+      << "The size_bucket_num is only used with the max_nodes";
+  buckets_.resize(std::max(bucket_num, 1));
+  bucket_nodes_.assign(buckets_.size(), 0);
+
+  // more loaders than the prefetched batches would be idle
+  int loader_num = this->layer_param_.octree_param().loader_thread_num();
+  CHECK_GT(loader_num, 0) << "The loader_thread_num should be positive";
+  loader_num = std::min<int>(loader_num, this->prefetch_.size());
+  loaders_.resize(loader_num);
+  for (Loader& loader : loaders_) {
+    loader.keys.resize(batch_size_);
+    loader.records.resize(batch_size_);
+    loader.octrees.resize(batch_size_);
+    loader.octree_ptrs.resize(batch_size_);
+    loader.num = 0;
+  }
 
   output_octree_ = top.size() == 3;
 
@@ -72,18 +108,236 @@ void OctreeDataBaseLayer<Dtype>::DataLayerSetUp(const vector<Blob<Dtype>*>& bott
   //}
 }
 
-template<typename Dtype>
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::InternalThreadEntry() {
+  read_seq_ = 0;
+  push_seq_ = 0;
+  if (loaders_.size() == 1) {
+    LoaderEntry(loaders_[0]);
+    return;
+  }
+
+  // The loaders run with the mode, device and solver of this thread, as the
+  // Caffe context is thread local; the solver count and rank select the
+  // records of this solver in Skip(). This thread only waits to be interrupted
+  // by StopInternalThread(): a loader waiting for read_mutex_ can not be
+  // interrupted, so this thread does not load by itself.
+  int device = 0;
+#ifndef CPU_ONLY
+  CUDA_CHECK(cudaGetDevice(&device));
+#endif
+  const Caffe::Brew mode = Caffe::mode();
+  const int solver_count = Caffe::solver_count();
+  const int solver_rank = Caffe::solver_rank();
+  const bool multiprocess = Caffe::multiprocess();
+  vector<shared_ptr<boost::thread> > threads;
+  for (int i = 0; i < loaders_.size(); ++i) {
+    const int rand_seed = caffe_rng_rand();
+    threads.push_back(shared_ptr<boost::thread>(new boost::thread(
+        &OctreeDataBaseLayer<Dtype>::LoaderThreadEntry, this, i, mode, device,
+        rand_seed, solver_count, solver_rank, multiprocess)));
+  }
+  try {
+    while (true) boost::this_thread::sleep(boost::posix_time::seconds(3600));
+  } catch (boost::thread_interrupted&) {
+    // Interrupted exception is expected on shutdown
+  }
+
+  // all the loaders are interrupted before joining, since the ones waiting
+  // for read_mutex_ only move on after the holder is interrupted
+  for (int i = 0; i < threads.size(); ++i) threads[i]->interrupt();
+  for (int i = 0; i < threads.size(); ++i) threads[i]->join();
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::LoaderThreadEntry(int id, Caffe::Brew mode,
+    int device, int rand_seed, int solver_count, int solver_rank,
+    bool multiprocess) {
+#ifndef CPU_ONLY
+  CUDA_CHECK(cudaSetDevice(device));
+#endif
+  Caffe::set_mode(mode);
+  Caffe::set_random_seed(rand_seed);
+  Caffe::set_solver_count(solver_count);
+  Caffe::set_solver_rank(solver_rank);
+  Caffe::set_multiprocess(multiprocess);
+  LoaderEntry(loaders_[id]);
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::LoaderEntry(Loader& loader) {
+#ifndef CPU_ONLY
+  cudaStream_t stream;
+  if (Caffe::mode() == Caffe::GPU) {
+    CUDA_CHECK(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  }
+#endif
+
+  try {
+    while (!boost::this_thread::interruption_requested()) {
+      // The free batch is taken before the sequence number, so the loader of
+      // the oldest batch in flight always holds a batch and can not be starved
+      // by the loaders waiting for their turns to push.
+      Batch<Dtype>* batch = nullptr;
+      int seq = 0;
+      {
+        boost::mutex::scoped_lock lock(read_mutex_);
+        batch = this->prefetch_free_.pop();
+        seq = read_seq_++;
+        ReadRecords(loader);
+      }
+
+      BuildBatch(loader, batch);
+#ifndef CPU_ONLY
+      if (Caffe::mode() == Caffe::GPU) {
+        batch->data_.data().get()->async_gpu_push(stream);
+        if (this->output_labels_) {
+          batch->label_.data().get()->async_gpu_push(stream);
+        }
+        CUDA_CHECK(cudaStreamSynchronize(stream));
+      }
+#endif
+
+      {
+        boost::mutex::scoped_lock lock(push_mutex_);
+        while (push_seq_ != seq) push_cv_.wait(lock);
+        this->prefetch_full_.push(batch);
+        push_seq_++;
+      }
+      push_cv_.notify_all();
+    }
+  } catch (boost::thread_interrupted&) {
+    // Interrupted exception is expected on shutdown
+  }
+
+#ifndef CPU_ONLY
+  if (Caffe::mode() == Caffe::GPU) {
+    CUDA_CHECK(cudaStreamDestroy(stream));
+  }
+#endif
+}
+
+template <typename Dtype>
 void OctreeDataBaseLayer<Dtype>::load_batch(Batch<Dtype>* batch) {
-  CPUTimer batch_timer;
-  batch_timer.Start();
+  ReadRecords(loaders_[0]);
+  BuildBatch(loaders_[0], batch);
+}
+
+// The records are copied out of the database: db::Cursor returns the value by
+// copy (LevelDB has no stable pointer to it), the records of max_nodes wait in
+// the buckets after the cursor moved on, and the batches are built outside of
+// read_mutex_. So each record is copied once, and the copy is counted in
+// read_time; the datum records are unpacked in place by BuildBatch.
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::ReadRecords(Loader& loader) {
+  CPUTimer timer;
+  timer.Start();
+  if (max_nodes_ > 0) {
+    PackRecords(loader);
+  } else {
+    for (int i = 0; i < batch_size_; ++i) {
+      while (this->Skip()) this->Next();
+      loader.keys[i] = this->cursor_->key();
+      loader.records[i] = this->cursor_->value();
+      this->Next();
+    }
+    loader.num = batch_size_;
+  }
+  timer.Stop();
+
+  boost::mutex::scoped_lock lock(stats_mutex_);
+  stats_.read_time += timer.MilliSeconds();
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::PackRecords(Loader& loader) {
+  while (true) {
+    Record record;
+    while (this->Skip()) this->Next();
+    record.key = this->cursor_->key();
+    record.value = this->cursor_->value();
+    this->Next();
+    record.node_num = NodeNum(record);
+
+    int b = 0;
+    while (b + 1 < buckets_.size() &&
+        (static_cast<int64_t>(record.node_num) << (b + 1)) <= max_nodes_) {
+      b++;
+    }
+
+    // an octree with more than max_nodes nodes makes a batch by itself
+    std::deque<Record>& bucket = buckets_[b];
+    if (!bucket.empty() && bucket_nodes_[b] + record.node_num > max_nodes_) {
+      PopBucket(loader, b);
+      bucket_nodes_[b] = record.node_num;
+      bucket.push_back(std::move(record));
+      return;
+    }
+    bucket_nodes_[b] += record.node_num;
+    bucket.push_back(std::move(record));
+    if (bucket.size() == batch_size_ || bucket_nodes_[b] >= max_nodes_) {
+      PopBucket(loader, b);
+      return;
+    }
+  }
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::PopBucket(Loader& loader, const int b) {
+  std::deque<Record>& bucket = buckets_[b];
+  loader.num = bucket.size();
+  for (int i = 0; i < loader.num; ++i) {
+    loader.keys[i].swap(bucket[i].key);
+    loader.records[i].swap(bucket[i].value);
+  }
+  bucket.clear();
+  bucket_nodes_[b] = 0;
+}
+
+template <typename Dtype>
+int OctreeDataBaseLayer<Dtype>::NodeNum(Record& record) {
+  const char* data = nullptr;
+  int size = 0, label = 0;
+  if (!octree::parse_octree_record(record.value.data(), record.value.size(),
+      &data, &size, &label)) {
+    Datum datum;
+    datum.ParseFromString(record.value);
+    octree::pack_octree_record(record.value, datum.data().data(),
+        datum.data().size(), datum.label());
+    octree::parse_octree_record(record.value.data(), record.value.size(),
+        &data, &size, &label);
+  }
+
+  OctreeInfo info;
+  CHECK(octree::read_octree_info(info, data, size))
+      << "Invalid octree: " << record.key;
+  return info.node_num(std::min(curr_depth_, info.depth()));
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::BuildBatch(Loader& loader, Batch<Dtype>* batch) {
+  CPUTimer timer;
+  timer.Start();
 
   Datum datum;
   Dtype* label_data = nullptr;
-  if (this->output_labels_) label_data = batch->label_.mutable_cpu_data();
-  for (int i = 0; i < batch_size_; ++i) {
-    // get a datum
-    while (this->Skip()) this->Next();
-    datum.ParseFromString(this->cursor_->value());
+  if (this->output_labels_) {
+    batch->label_.Reshape(vector<int> { loader.num });
+    label_data = batch->label_.mutable_cpu_data();
+  }
+  loader.octree_ptrs.resize(loader.num);
+  for (int i = 0; i < loader.num; ++i) {
+    // the record is a raw octree record or a datum
+    string& record = loader.records[i];
+    const char* data = nullptr;
+    int size = 0, label = 0;
+    if (!octree::parse_octree_record(record.data(), record.size(), &data, &size, &label)) {
+      datum.ParseFromString(record);
+      record.swap(*datum.mutable_data());
+      data = record.data();
+      size = record.size();
+      label = datum.label();
+    }
 
     //// dropout octree nodes
     //if (dropout_) {
@@ -96,18 +350,33 @@ void OctreeDataBaseLayer<Dtype>::load_batch(Batch<Dtype>* batch) {
     //  }
     //}
 
-    // copy data
-    int n = datum.data().size();
-    octree_buffer_[i].resize(n);
-    memcpy(octree_buffer_[i].data(), datum.data().data(), n);
-    if (this->output_labels_) label_data[i] = static_cast<Dtype>(datum.label());
-
-    // update cursor
-    this->Next();
+    // the octree is merged from the record, unless it is compact or only the
+    // layers up to load_depth_ are kept
+    const char* octree = data;
+    vector<char>& buffer = loader.octrees[i];
+    if (octree::is_compact_octree(data, size)) {
+      CHECK(octree::decompress_octree(buffer, data, size))
+          << "Invalid compact octree: " << loader.keys[i];
+      octree = buffer.data();
+    }
+    if (load_depth_ > 0) {
+      octree::truncate_octree(loader.octree_tmp, octree, load_depth_);
+      buffer.swap(loader.octree_tmp);
+      octree = buffer.data();
+    }
+    loader.octree_ptrs[i] = octree;
+    if (this->output_labels_) label_data[i] = static_cast<Dtype>(label);
   }
+  timer.Stop();
+  const double decode_time = timer.MilliSeconds();
 
-  // merge octrees
-  octree::merge_octrees<Dtype>(batch->data_, octree_buffer_);
+  // merge octrees, and calculate the neighbors needed by the net
+  timer.Start();
+  octree::merge_octrees<Dtype>(batch->data_, loader.octree_ptrs, 0, load_flag_);
+  OctreeParser octree_batch;
+  octree_batch.set_cpu(batch->data_.mutable_cpu_data());
+  batch_neigh_mask_[BatchIndex(batch)] = octree::update_neigh_cpu(octree_batch, neigh_mask_);
+  timer.Stop();
 
   //// rand skip a datum
   //static uint32 indicator = 1;
@@ -123,8 +392,41 @@ void OctreeDataBaseLayer<Dtype>::load_batch(Batch<Dtype>* batch) {
   //  indicator++;
   //}
 
-  batch_timer.Stop();
-  LOG_EVERY_N(INFO, 50) << "Prefetch batch: " << batch_timer.MilliSeconds() << " ms.";
+  boost::mutex::scoped_lock lock(stats_mutex_);
+  stats_.batch_num++;
+  stats_.octree_num += loader.num;
+  stats_.decode_time += decode_time;
+  stats_.merge_time += timer.MilliSeconds();
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::FetchBatch() {
+  if (this->prefetch_current_) this->prefetch_free_.push(this->prefetch_current_);
+  const int queue_size = this->prefetch_full_.size();
+  CPUTimer timer;
+  timer.Start();
+  this->prefetch_current_ = this->prefetch_full_.pop("Waiting for data");
+  timer.Stop();
+
+  boost::mutex::scoped_lock lock(stats_mutex_);
+  stats_.forward_num++;
+  stats_.wait_time += timer.MilliSeconds();
+  stats_.queue_size += queue_size;
+  const double n = std::max(stats_.batch_num, 1), m = stats_.forward_num;
+  LOG_EVERY_N(INFO, 50) << "Prefetch batch: " << stats_.octree_num / n
+      << " octrees, read " << stats_.read_time / n
+      << " ms, decode " << stats_.decode_time / n << " ms, merge "
+      << stats_.merge_time / n << " ms with " << loaders_.size()
+      << " loaders; queued " << stats_.queue_size / m << " of "
+      << this->prefetch_.size() << " batches, waited " << stats_.wait_time / m
+      << " ms per forward.";
+}
+
+template <typename Dtype>
+typename OctreeDataBaseLayer<Dtype>::PrefetchStats
+OctreeDataBaseLayer<Dtype>::prefetch_stats() const {
+  boost::mutex::scoped_lock lock(stats_mutex_);
+  return stats_;
 }
 
 template<typename Dtype>
@@ -142,11 +444,40 @@ int OctreeDataBaseLayer<Dtype>::RandDropDepth() {
   return 20;
 }
 
+template <typename Dtype>
+int OctreeDataBaseLayer<Dtype>::BatchIndex(const Batch<Dtype>* batch) const {
+  for (int i = 0; i < this->prefetch_.size(); ++i) {
+    if (this->prefetch_[i].get() == batch) return i;
+  }
+  LOG(FATAL) << "The batch is not prefetched by this layer";
+  return -1;
+}
+
+template <typename Dtype>
+void OctreeDataBaseLayer<Dtype>::UpdateNeighbor(Batch<Dtype>* batch) {
+  // The net is set up before the first forward, so the depths declared by its
+  // layers are known from now on. If none is declared, the neighbors of all
+  // the depths are calculated as they are read by unknown layers.
+  int neigh_mask = Octree::get_neigh_depth_mask();
+  if (neigh_mask == 0) neigh_mask = -1;
+  neigh_mask_ = neigh_mask;
+
+  // the batches prefetched before are calculated on demand
+  int& done_mask = batch_neigh_mask_[BatchIndex(batch)];
+  OctreeParser octree_batch;
+  octree_batch.set_cpu(batch->data_.cpu_data());
+  const OctreeInfo& info = octree_batch.info();
+  if (!info.has_property(OctreeInfo::kNeigh)) return;
+  int mask = octree::neigh_depth_closure(neigh_mask, info.depth(), info.full_layer());
+  if ((mask & ~done_mask) == 0) return;
+  octree_batch.set_cpu(batch->data_.mutable_cpu_data());
+  done_mask = octree::update_neigh_cpu(octree_batch, neigh_mask, done_mask);
+}
+
 template <typename Dtype>
 void OctreeDataBaseLayer<Dtype>::Forward_cpu(
     const vector<Blob<Dtype>*>& bottom, const vector<Blob<Dtype>*>& top) {
-  if (this->prefetch_current_) this->prefetch_free_.push(this->prefetch_current_);
-  this->prefetch_current_ = this->prefetch_full_.pop("Waiting for data");
+  FetchBatch();
   Blob<Dtype>& curr_octree = this->prefetch_current_->data_;
 
   // set data - top[0]
@@ -160,6 +491,9 @@ void OctreeDataBaseLayer<Dtype>::Forward_cpu(
     top[1]->set_cpu_data(this->prefetch_current_->label_.mutable_cpu_data());
   }
 
+  // calculate the neighbors needed by the net
+  UpdateNeighbor(this->prefetch_current_);
+
   // set the global octree
   Blob<Dtype>& the_octree = Octree::get_octree(Dtype(0));
   the_octree.ReshapeLike(curr_octree);
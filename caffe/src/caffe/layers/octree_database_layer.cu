@@ -6,8 +6,7 @@ namespace caffe {
 template <typename Dtype>
 void OctreeDataBaseLayer<Dtype>::Forward_gpu(
     const vector<Blob<Dtype>*>& bottom, const vector<Blob<Dtype>*>& top) {
-  if (this->prefetch_current_) this->prefetch_free_.push(this->prefetch_current_);
-  this->prefetch_current_ = this->prefetch_full_.pop("Waiting for data");
+  FetchBatch();
   Blob<Dtype>& curr_octree = this->prefetch_current_->data_;
 
   // set data - top[0]
@@ -21,6 +20,9 @@ void OctreeDataBaseLayer<Dtype>::Forward_gpu(
     top[1]->set_gpu_data(this->prefetch_current_->label_.mutable_gpu_data());
   }
 
+  // calculate the neighbors needed by the net
+  UpdateNeighbor(this->prefetch_current_);
+
   // set the global octree
   Blob<Dtype>& the_octree = Octree::get_octree(Dtype(0));
   the_octree.ReshapeLike(curr_octree);
@@ -23,18 +23,15 @@ void Octree2FullVoxelLayer<Dtype>::LayerSetUp(const vector<Blob<Dtype>*>& bottom
 template <typename Dtype>
 void Octree2FullVoxelLayer<Dtype>::Reshape(const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
-  vector<int> top_shape(5);
-  top_shape[0] = batch_size_;
-  top_shape[1] = bottom[0]->shape(1);
-  top_shape[2] = top_shape[3] = top_shape[4] = 1 << curr_depth_;
-
   if (top[0]->count() != 0) {
     bool octree_in = bottom.size() == 2;
     Blob<Dtype>& the_octree = octree_in ? *bottom[1] : Octree::get_octree(Dtype(0));
     octree::set_octree_parser(octree_batch_, the_octree);
 
-    // batch size
-    CHECK_EQ(batch_size_, octree_batch_.info().batch_size())
+    // batch size, which is taken from the octree: with max_nodes, the batches
+    // of OctreeDataBase have at most batch_size octrees
+    batch_size_ = octree_batch_.info().batch_size();
+    CHECK_LE(batch_size_, this->layer_param_.octree_param().batch_size())
         << "The batch_size_ is wrong in the layer: " << this->layer_param_.name();
 
     // check full_octree_
@@ -48,6 +45,10 @@ void Octree2FullVoxelLayer<Dtype>::Reshape(const vector<Blob<Dtype>*>& bottom,
         << "The node number is wrong in the layer: " << this->layer_param_.name();
   }
 
+  vector<int> top_shape(5);
+  top_shape[0] = batch_size_;
+  top_shape[1] = bottom[0]->shape(1);
+  top_shape[2] = top_shape[3] = top_shape[4] = 1 << curr_depth_;
   top[0]->Reshape(top_shape);
 }
 
@@ -106,17 +107,8 @@ void Octree2FullVoxelLayer<Dtype>::build_mapping(int depth) {
         // xyz index
         unsigned xyz = (n * x + y) * n + z;
 
-        // key
-        unsigned key = 0;
-        for (int i = 0; i < depth; i++) {
-          unsigned mask = 1u << i;
-          key |= ((x & mask) << (2 * i + 2)) |
-              ((y & mask) << (2 * i + 1)) |
-              ((z & mask) << (2 * i));
-        }
-
         // mapping
-        mapper_ptr[xyz] = key;
+        mapper_ptr[xyz] = octree::morton_encode(x, y, z);
       }
     }
   }
@@ -23,6 +23,8 @@ void OctreeGrowLayer<Dtype>::LayerSetUp(const vector<Blob<Dtype>*>& bottom,
     CHECK_NE(bottom[0], top[0])
         << " Error in: " << this->layer_param_.name() << ": "
         << "The bottom and top blob should not be in-place";
+    // the neighbors of the parent depth are split in Forward
+    if (curr_depth_ > 0) Octree::add_neigh_depth(curr_depth_ - 1);
   }
   if (full_octree_ && bottom.size() == 0) {
     CHECK(this->layer_param_.octree_param().has_batch_size())
@@ -90,8 +92,9 @@ void OctreeGrowLayer<Dtype>::Forward_cpu(const vector<Blob<Dtype>*>& bottom,
       // relationship is broken, so copy the data from bottom[0] to top[0]
       int nnum = oct_parser_btm_.info().total_nnum();
       int nnum_ngh = nnum * oct_parser_btm_.info().channel(OctreeInfo::kNeigh);
+      int nnum_key = nnum * oct_parser_btm_.info().channel(OctreeInfo::kKey);
       oct_parser.set_cpu(top[0]->mutable_cpu_data(), &oct_info_);
-      caffe_copy(nnum, oct_parser_btm_.key_cpu(0), oct_parser.mutable_key_cpu(0));
+      caffe_copy(nnum_key, oct_parser_btm_.key_cpu(0), oct_parser.mutable_key_cpu(0));
       caffe_copy(nnum, oct_parser_btm_.children_cpu(0), oct_parser.mutable_children_cpu(0));
       caffe_copy(nnum_ngh, oct_parser_btm_.neighbor_cpu(0), oct_parser.mutable_neighbor_cpu(0));
     } else {
@@ -109,8 +112,13 @@ void OctreeGrowLayer<Dtype>::Forward_cpu(const vector<Blob<Dtype>*>& bottom,
     octree::calc_neigh_cpu(oct_parser.mutable_neighbor_cpu(curr_depth_),
         curr_depth_, batch_size_);
 
-    octree::generate_key_cpu(oct_parser.mutable_key_cpu(curr_depth_),
-        curr_depth_, batch_size_);
+    if (oct_info_.channel(OctreeInfo::kKey) == 1) {
+      octree::generate_key_cpu(oct_parser.mutable_key_cpu(curr_depth_),
+          curr_depth_, batch_size_);
+    } else {
+      octree::generate_key_cpu(oct_parser.mutable_key64_cpu(curr_depth_),
+          curr_depth_, batch_size_);
+    }
 
     int* children = oct_parser.mutable_children_cpu(curr_depth_);
     for (int i = 0; i < node_num_; ++i) children[i] = i;
@@ -122,9 +130,15 @@ void OctreeGrowLayer<Dtype>::Forward_cpu(const vector<Blob<Dtype>*>& bottom,
         oct_parser.neighbor_cpu(curr_depth_ - 1), label_ptr,
         oct_parser.info().node_num(curr_depth_ - 1));
 
-    octree::generate_key_cpu(oct_parser.mutable_key_cpu(curr_depth_),
-        oct_parser.key_cpu(curr_depth_ - 1), label_ptr,
-        oct_parser.info().node_num(curr_depth_ - 1));
+    if (oct_info_.channel(OctreeInfo::kKey) == 1) {
+      octree::generate_key_cpu(oct_parser.mutable_key_cpu(curr_depth_),
+          oct_parser.key_cpu(curr_depth_ - 1), label_ptr,
+          oct_parser.info().node_num(curr_depth_ - 1));
+    } else {
+      octree::generate_key_cpu(oct_parser.mutable_key64_cpu(curr_depth_),
+          oct_parser.key64_cpu(curr_depth_ - 1), label_ptr,
+          oct_parser.info().node_num(curr_depth_ - 1));
+    }
 
     int* children = oct_parser.mutable_children_cpu(curr_depth_);
     for (int i = 0; i < node_num_; ++i) children[i] = i;
@@ -139,7 +153,8 @@ void OctreeGrowLayer<Dtype>::update_octreeinfo() {
     oct_info_.set_full_layer(curr_depth_);
     oct_info_.set_adaptive(false);
     oct_info_.set_key2xyz(true);   //!!! todo: key2xyz = false
-    oct_info_.set_property(OctreeInfo::kKey, 1, -1);
+    oct_info_.set_property(OctreeInfo::kKey,
+        octree::key_channel(curr_depth_, batch_size_), -1);
     oct_info_.set_property(OctreeInfo::kChild, 1, -1);
     oct_info_.set_property(OctreeInfo::kNeigh, 8, -1);
   }
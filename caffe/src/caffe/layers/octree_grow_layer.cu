@@ -16,8 +16,9 @@ void OctreeGrowLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
       // relationship is broken, so copy the data from bottom[0] to top[0]
       int nnum = oct_parser_btm_.info().total_nnum();
       int nnum_ngh = nnum * oct_parser_btm_.info().channel(OctreeInfo::kNeigh);
+      int nnum_key = nnum * oct_parser_btm_.info().channel(OctreeInfo::kKey);
       oct_parser.set_gpu(top[0]->mutable_gpu_data(), &oct_info_);
-      caffe_copy(nnum, oct_parser_btm_.key_gpu(0), oct_parser.mutable_key_gpu(0));
+      caffe_copy(nnum_key, oct_parser_btm_.key_gpu(0), oct_parser.mutable_key_gpu(0));
       caffe_copy(nnum, oct_parser_btm_.children_gpu(0), oct_parser.mutable_children_gpu(0));
       caffe_copy(nnum_ngh, oct_parser_btm_.neighbor_gpu(0), oct_parser.mutable_neighbor_gpu(0));
     } else {
@@ -35,8 +36,13 @@ void OctreeGrowLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     octree::calc_neigh_gpu(oct_parser.mutable_neighbor_gpu(curr_depth_),
         curr_depth_, batch_size_);
 
-    octree::generate_key_gpu(oct_parser.mutable_key_gpu(curr_depth_),
-        curr_depth_, batch_size_);
+    if (oct_info_.channel(OctreeInfo::kKey) == 1) {
+      octree::generate_key_gpu(oct_parser.mutable_key_gpu(curr_depth_),
+          curr_depth_, batch_size_);
+    } else {
+      octree::generate_key_gpu(oct_parser.mutable_key64_gpu(curr_depth_),
+          curr_depth_, batch_size_);
+    }
 
     int* children = oct_parser.mutable_children_gpu(curr_depth_);
     thrust::sequence(thrust::device, children, children + node_num_);
@@ -48,9 +54,15 @@ void OctreeGrowLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
         oct_parser.neighbor_gpu(curr_depth_ - 1), label_ptr,
         oct_parser.info().node_num(curr_depth_ - 1));
 
-    octree::generate_key_gpu(oct_parser.mutable_key_gpu(curr_depth_),
-        oct_parser.key_gpu(curr_depth_ - 1), label_ptr,
-        oct_parser.info().node_num(curr_depth_ - 1));
+    if (oct_info_.channel(OctreeInfo::kKey) == 1) {
+      octree::generate_key_gpu(oct_parser.mutable_key_gpu(curr_depth_),
+          oct_parser.key_gpu(curr_depth_ - 1), label_ptr,
+          oct_parser.info().node_num(curr_depth_ - 1));
+    } else {
+      octree::generate_key_gpu(oct_parser.mutable_key64_gpu(curr_depth_),
+          oct_parser.key64_gpu(curr_depth_ - 1), label_ptr,
+          oct_parser.info().node_num(curr_depth_ - 1));
+    }
 
     int* children = oct_parser.mutable_children_gpu(curr_depth_);
     thrust::sequence(thrust::device, children, children + node_num_);
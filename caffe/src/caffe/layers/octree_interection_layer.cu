@@ -28,39 +28,68 @@ __global__ void copy_backward_kernel(Dtype* bottom, const int Hbtm, const int Ct
   }
 }
 
-__global__ void validate_bsearch_kernel(int* idx, const unsigned* arr1, const int n1,
-    const unsigned* arr2, const int n2) {
+template <typename Key>
+__global__ void validate_bsearch_kernel(int* idx, const Key* arr1, const int n1,
+    const Key* arr2, const int n2) {
   CUDA_KERNEL_LOOP(i, n1) {
     int j = idx[i];
     if (j >= n2 || arr2[j] != arr1[i]) idx[i] = -1;
   }
 }
 
+// shuffle the xyz keys to the sorted keys, and search the keys in the gt keys
+template <typename Key>
+void search_shuffled_key(int* index_gt, Key* skey, const Key* key, const int num,
+    Key* skey_gt, const Key* key_gt, const int num_gt, const int depth) {
+  octree::xyz2key_gpu(skey, key, num, depth);
+  octree::xyz2key_gpu(skey_gt, key_gt, num_gt, depth);
+  thrust::lower_bound(thrust::device, skey_gt, skey_gt + num_gt,
+      skey, skey + num, index_gt);
+  validate_bsearch_kernel<Key> <<< CAFFE_GET_BLOCKS(num), CAFFE_CUDA_NUM_THREADS >>> (
+      index_gt, skey, num, skey_gt, num_gt);
+}
+
 template <typename Dtype>
 void OctreeIntersectionLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
     const vector<Blob<Dtype>*>& top) {
   /// calc shuffled key
   // TODO: optimize octree storage to remove the usage of shuffled_key_kernel
-  int num = bottom[0]->count();
-  shuffled_key_.Reshape(vector<int> { num });
-  unsigned int* skey_ptr = shuffled_key_.mutable_gpu_data();
-  const unsigned int* key_ptr = reinterpret_cast<const unsigned int*>(bottom[0]->gpu_data());
-  octree::xyz2key_gpu(skey_ptr, key_ptr, num, curr_depth_);
-
-  int num_gt = bottom[2]->count();
-  shuffled_key_gt_.Reshape(vector<int> { num_gt });
-  unsigned* skey_gt_ptr = shuffled_key_gt_.mutable_gpu_data();
-  const unsigned int* key_gt_ptr = reinterpret_cast<const unsigned int*>(bottom[2]->gpu_data());
-  octree::xyz2key_gpu(skey_gt_ptr, key_gt_ptr, num_gt, curr_depth_);
+  // The key blobs have the shape (1, key_channel, num, 1), and the keys are
+  // 64-bit if key_channel is 2. The keys are xyz keys, which are converted
+  // to the sorted Morton keys.
+  OctreeParser octree_parser;
+  octree::set_octree_parser(octree_parser, Octree::get_octree(Dtype(0)));
+  CHECK(octree_parser.info().key2xyz())
+      << "Error in " << this->layer_param_.name()
+      << ": The keys of the octree should be stored as xyz";
+  const int key_channel = bottom[0]->shape(1);
+  CHECK_EQ(key_channel, bottom[2]->shape(1))
+      << "Error in " << this->layer_param_.name()
+      << ": The key channel of the two octrees must be the same!";
+  int num = bottom[0]->count(2);
+  int num_gt = bottom[2]->count(2);
+  shuffled_key_.Reshape(vector<int> { key_channel * num });
+  shuffled_key_gt_.Reshape(vector<int> { key_channel * num_gt });
 
   /// intersection
   //// version 2.0
   index_gt_.Reshape(vector<int> {num});
   int* index_gt_ptr = index_gt_.mutable_gpu_data();
-  thrust::lower_bound(thrust::device, skey_gt_ptr, skey_gt_ptr + num_gt,
-      skey_ptr, skey_ptr + num, index_gt_ptr);
-  validate_bsearch_kernel <<< CAFFE_GET_BLOCKS(num), CAFFE_CUDA_NUM_THREADS >>> (
-      index_gt_ptr, skey_ptr, num, skey_gt_ptr, num_gt);
+  if (key_channel == 1) {
+    search_shuffled_key(index_gt_ptr, shuffled_key_.mutable_gpu_data(),
+        reinterpret_cast<const unsigned int*>(bottom[0]->gpu_data()), num,
+        shuffled_key_gt_.mutable_gpu_data(),
+        reinterpret_cast<const unsigned int*>(bottom[2]->gpu_data()), num_gt,
+        curr_depth_);
+  } else {
+    typedef unsigned long long uint64;
+    search_shuffled_key(index_gt_ptr,
+        reinterpret_cast<uint64*>(shuffled_key_.mutable_gpu_data()),
+        reinterpret_cast<const uint64*>(bottom[0]->gpu_data()), num,
+        reinterpret_cast<uint64*>(shuffled_key_gt_.mutable_gpu_data()),
+        reinterpret_cast<const uint64*>(bottom[2]->gpu_data()), num_gt,
+        curr_depth_);
+  }
   index_.Reshape(vector<int> {num});
   int* index_ptr = index_.mutable_gpu_data();
   thrust::sequence(thrust::device, index_ptr, index_ptr + num);
@@ -25,7 +25,9 @@ void OctreePoolingLayer<Dtype>::Reshape(const vector<Blob<Dtype>*>& bottom,
   CHECK(bottom[0] != top[0]) << "In-place computation is not allowed";
 
   if (top[0]->count() == 0) {
-    // a workaround for the first time reshape
+    // a workaround for the first time reshape, the octree is not known yet,
+    // so the batch size of the data layer is used, which is the largest one
+    // with max_nodes; the later reshapes follow the octree
     vector<int> top_shape = bottom[0]->shape();
     top_shape[2] = (curr_depth_ < 3) ?
         Octree::get_batchsize() * (1 << 3 * (curr_depth_ - 1)) : 8;
@@ -27,6 +27,11 @@ void OctreePropertyLayer<Dtype>::LayerSetUp(const vector<Blob<Dtype>*>& bottom,
   CHECK_EQ(blob_num, top.size())
       << "Error in " << this->layer_param_.name()
       << ": the content_flag and top blob size should be consistent!";
+
+  data_buffer_.resize(blob_num);
+  for (int i = 0; i < blob_num; ++i) {
+    data_buffer_[i].reset(new Blob<Dtype>());
+  }
 }
 
 template <typename Dtype>
@@ -71,7 +76,15 @@ void OctreePropertyLayer<Dtype>::Forward_cpu(const vector<Blob<Dtype>*>& bottom,
   for (int i = 0; i < ptypes_.size(); ++i) {
     const char* ptr = octree_batch_.ptr_cpu(ptypes_[i], curr_depth_);
     CHECK(ptr != nullptr) << "The octree property does not exist: " << ptypes_[i];
-    if (sizeof(Dtype) == 8 && IsDataProperty(ptypes_[i])) {
+    const OctreeInfo& info = octree_batch_.info();
+    const octree::DataType dtype = info.dtype(ptypes_[i]);
+    if (IsDataProperty(ptypes_[i]) && dtype != octree::kFloat32) {
+      Blob<Dtype>& buffer = *data_buffer_[i];
+      buffer.ReshapeLike(*top[i]);
+      octree::dequantize_cpu(buffer.mutable_cpu_data(), ptr, buffer.count(), dtype,
+          info.scale(ptypes_[i]), info.offset(ptypes_[i]));
+      top[i]->set_cpu_data(buffer.mutable_cpu_data());
+    } else if (sizeof(Dtype) == 8 && IsDataProperty(ptypes_[i])) {
       Dtype* des = top[i]->mutable_cpu_data();
       const float* src = reinterpret_cast<const float*>(ptr);
       for (int j = 0; j < top[i]->count(); ++j) {
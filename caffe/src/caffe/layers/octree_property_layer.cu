@@ -11,7 +11,15 @@ void OctreePropertyLayer<Dtype>::Forward_gpu(const vector<Blob<Dtype>*>& bottom,
   for (int i = 0; i < ptypes_.size(); ++i) {
     const char* ptr = octree_batch_.ptr_gpu(ptypes_[i], curr_depth_);
     CHECK(ptr != nullptr) << "The octree property does not exist: " << ptypes_[i];
-    if (sizeof(Dtype) == 8 && IsDataProperty(ptypes_[i])) {
+    const OctreeInfo& info = octree_batch_.info();
+    const octree::DataType dtype = info.dtype(ptypes_[i]);
+    if (IsDataProperty(ptypes_[i]) && dtype != octree::kFloat32) {
+      Blob<Dtype>& buffer = *data_buffer_[i];
+      buffer.ReshapeLike(*top[i]);
+      octree::dequantize_gpu(buffer.mutable_gpu_data(), ptr, buffer.count(), dtype,
+          info.scale(ptypes_[i]), info.offset(ptypes_[i]));
+      top[i]->set_gpu_data(buffer.mutable_gpu_data());
+    } else if (sizeof(Dtype) == 8 && IsDataProperty(ptypes_[i])) {
       int num = top[i]->count();
       Dtype* des = top[i]->mutable_gpu_data();
       const float* src = reinterpret_cast<const float*>(ptr);
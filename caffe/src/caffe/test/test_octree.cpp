@@ -2138,6 +2138,607 @@ static const char octree_6[] = {
   0000, 0000, 0000, 0000, 0000, 0000, 0x80, 0x3f, 0000, 0000, 0000, 0000, 0x00
 };
 
+// this octree contains 3 points with the normals (1, 0, 0), (0, 1, 0) and
+// (0, 0, 1), the first two of which share a node of depth 3, and the 2nd level
+// is full
+static const char octree_7[] = {
+  0x5f, 0x4f, 0x43, 0x54, 0x52, 0x45, 0x45, 0x5f, 0x31, 0x2e, 0x30, 0x5f,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x05, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x04, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0x40, 0xcd, 0xcc, 0xcc, 0x3d, 0x01, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x08, 0000, 0000, 0000, 0x40, 0000, 0000, 0000,
+  0x10, 0000, 0000, 0000, 0x10, 0000, 0000, 0000, 0x10, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x09, 0000, 0000, 0000, 0x49, 0000, 0000, 0000, 0x59, 0000, 0000, 0000,
+  0x69, 0000, 0000, 0000, 0x79, 0000, 0000, 0000, 0x79, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x02, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x0b, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000, 0x05, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe,
+  0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xcc, 0x02, 0000, 0000, 0xb0, 0x04, 0000, 0000,
+  0x94, 0x06, 0000, 0000, 0x94, 0x06, 0000, 0000, 0x54, 0x07, 0000, 0000,
+  0x54, 0x07, 0000, 0000, 0x54, 0x07, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000,
+  0000, 0x01, 0x01, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000,
+  0x01, 0x01, 0000, 0000, 0x01, 0x01, 0x01, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0x01, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000, 0x01, 0x01, 0000, 0000,
+  0x01, 0x01, 0x01, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x03, 0000,
+  0000, 0x01, 0x02, 0000, 0000, 0x01, 0x03, 0000, 0x01, 0000, 0x02, 0000,
+  0x01, 0000, 0x03, 0000, 0x01, 0x01, 0x02, 0000, 0x01, 0x01, 0x03, 0000,
+  0000, 0x02, 0000, 0000, 0000, 0x02, 0x01, 0000, 0000, 0x03, 0000, 0000,
+  0000, 0x03, 0x01, 0000, 0x01, 0x02, 0000, 0000, 0x01, 0x02, 0x01, 0000,
+  0x01, 0x03, 0000, 0000, 0x01, 0x03, 0x01, 0000, 0000, 0x02, 0x02, 0000,
+  0000, 0x02, 0x03, 0000, 0000, 0x03, 0x02, 0000, 0000, 0x03, 0x03, 0000,
+  0x01, 0x02, 0x02, 0000, 0x01, 0x02, 0x03, 0000, 0x01, 0x03, 0x02, 0000,
+  0x01, 0x03, 0x03, 0000, 0x02, 0000, 0000, 0000, 0x02, 0000, 0x01, 0000,
+  0x02, 0x01, 0000, 0000, 0x02, 0x01, 0x01, 0000, 0x03, 0000, 0000, 0000,
+  0x03, 0000, 0x01, 0000, 0x03, 0x01, 0000, 0000, 0x03, 0x01, 0x01, 0000,
+  0x02, 0000, 0x02, 0000, 0x02, 0000, 0x03, 0000, 0x02, 0x01, 0x02, 0000,
+  0x02, 0x01, 0x03, 0000, 0x03, 0000, 0x02, 0000, 0x03, 0000, 0x03, 0000,
+  0x03, 0x01, 0x02, 0000, 0x03, 0x01, 0x03, 0000, 0x02, 0x02, 0000, 0000,
+  0x02, 0x02, 0x01, 0000, 0x02, 0x03, 0000, 0000, 0x02, 0x03, 0x01, 0000,
+  0x03, 0x02, 0000, 0000, 0x03, 0x02, 0x01, 0000, 0x03, 0x03, 0000, 0000,
+  0x03, 0x03, 0x01, 0000, 0x02, 0x02, 0x02, 0000, 0x02, 0x02, 0x03, 0000,
+  0x02, 0x03, 0x02, 0000, 0x02, 0x03, 0x03, 0000, 0x03, 0x02, 0x02, 0000,
+  0x03, 0x02, 0x03, 0000, 0x03, 0x03, 0x02, 0000, 0x03, 0x03, 0x03, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000,
+  0000, 0x01, 0x01, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000,
+  0x01, 0x01, 0000, 0000, 0x01, 0x01, 0x01, 0000, 0x06, 0x06, 0x06, 0000,
+  0x06, 0x06, 0x07, 0000, 0x06, 0x07, 0x06, 0000, 0x06, 0x07, 0x07, 0000,
+  0x07, 0x06, 0x06, 0000, 0x07, 0x06, 0x07, 0000, 0x07, 0x07, 0x06, 0000,
+  0x07, 0x07, 0x07, 0000, 0x02, 0x02, 0x02, 0000, 0x02, 0x02, 0x03, 0000,
+  0x02, 0x03, 0x02, 0000, 0x02, 0x03, 0x03, 0000, 0x03, 0x02, 0x02, 0000,
+  0x03, 0x02, 0x03, 0000, 0x03, 0x03, 0x02, 0000, 0x03, 0x03, 0x03, 0000,
+  0x0c, 0x0c, 0x0c, 0000, 0x0c, 0x0c, 0x0d, 0000, 0x0c, 0x0d, 0x0c, 0000,
+  0x0c, 0x0d, 0x0d, 0000, 0x0d, 0x0c, 0x0c, 0000, 0x0d, 0x0c, 0x0d, 0000,
+  0x0d, 0x0d, 0x0c, 0000, 0x0d, 0x0d, 0x0d, 0000, 0x06, 0x06, 0x06, 0000,
+  0x06, 0x06, 0x07, 0000, 0x06, 0x07, 0x06, 0000, 0x06, 0x07, 0x07, 0000,
+  0x07, 0x06, 0x06, 0000, 0x07, 0x06, 0x07, 0000, 0x07, 0x07, 0x06, 0000,
+  0x07, 0x07, 0x07, 0000, 0x18, 0x18, 0x18, 0000, 0x18, 0x18, 0x19, 0000,
+  0x18, 0x19, 0x18, 0000, 0x18, 0x19, 0x19, 0000, 0x19, 0x18, 0x18, 0000,
+  0x19, 0x18, 0x19, 0000, 0x19, 0x19, 0x18, 0000, 0x19, 0x19, 0x19, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0x04, 0000, 0000, 0000,
+  0x05, 0000, 0000, 0000, 0x06, 0000, 0000, 0000, 0x07, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x02, 0000, 0000, 0000, 0000, 0000, 0x80, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x80, 0x3f,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x80, 0x3f, 0x00
+};
+
+// the same points as octree_7, and the depth is 3
+static const char octree_8[] = {
+  0x5f, 0x4f, 0x43, 0x54, 0x52, 0x45, 0x45, 0x5f, 0x31, 0x2e, 0x30, 0x5f,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x03, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x04, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0x40, 0xcd, 0xcc, 0xcc, 0x3d, 0x01, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x08, 0000, 0000, 0000, 0x40, 0000, 0000, 0000,
+  0x10, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x09, 0000, 0000, 0000, 0x49, 0000, 0000, 0000, 0x59, 0000, 0000, 0000,
+  0x59, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x02, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x0b, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000, 0x03, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe,
+  0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xcc, 0x02, 0000, 0000, 0x30, 0x04, 0000, 0000,
+  0x94, 0x05, 0000, 0000, 0x94, 0x05, 0000, 0000, 0x54, 0x06, 0000, 0000,
+  0x54, 0x06, 0000, 0000, 0x54, 0x06, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000,
+  0000, 0x01, 0x01, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000,
+  0x01, 0x01, 0000, 0000, 0x01, 0x01, 0x01, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0x01, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000, 0x01, 0x01, 0000, 0000,
+  0x01, 0x01, 0x01, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x03, 0000,
+  0000, 0x01, 0x02, 0000, 0000, 0x01, 0x03, 0000, 0x01, 0000, 0x02, 0000,
+  0x01, 0000, 0x03, 0000, 0x01, 0x01, 0x02, 0000, 0x01, 0x01, 0x03, 0000,
+  0000, 0x02, 0000, 0000, 0000, 0x02, 0x01, 0000, 0000, 0x03, 0000, 0000,
+  0000, 0x03, 0x01, 0000, 0x01, 0x02, 0000, 0000, 0x01, 0x02, 0x01, 0000,
+  0x01, 0x03, 0000, 0000, 0x01, 0x03, 0x01, 0000, 0000, 0x02, 0x02, 0000,
+  0000, 0x02, 0x03, 0000, 0000, 0x03, 0x02, 0000, 0000, 0x03, 0x03, 0000,
+  0x01, 0x02, 0x02, 0000, 0x01, 0x02, 0x03, 0000, 0x01, 0x03, 0x02, 0000,
+  0x01, 0x03, 0x03, 0000, 0x02, 0000, 0000, 0000, 0x02, 0000, 0x01, 0000,
+  0x02, 0x01, 0000, 0000, 0x02, 0x01, 0x01, 0000, 0x03, 0000, 0000, 0000,
+  0x03, 0000, 0x01, 0000, 0x03, 0x01, 0000, 0000, 0x03, 0x01, 0x01, 0000,
+  0x02, 0000, 0x02, 0000, 0x02, 0000, 0x03, 0000, 0x02, 0x01, 0x02, 0000,
+  0x02, 0x01, 0x03, 0000, 0x03, 0000, 0x02, 0000, 0x03, 0000, 0x03, 0000,
+  0x03, 0x01, 0x02, 0000, 0x03, 0x01, 0x03, 0000, 0x02, 0x02, 0000, 0000,
+  0x02, 0x02, 0x01, 0000, 0x02, 0x03, 0000, 0000, 0x02, 0x03, 0x01, 0000,
+  0x03, 0x02, 0000, 0000, 0x03, 0x02, 0x01, 0000, 0x03, 0x03, 0000, 0000,
+  0x03, 0x03, 0x01, 0000, 0x02, 0x02, 0x02, 0000, 0x02, 0x02, 0x03, 0000,
+  0x02, 0x03, 0x02, 0000, 0x02, 0x03, 0x03, 0000, 0x03, 0x02, 0x02, 0000,
+  0x03, 0x02, 0x03, 0000, 0x03, 0x03, 0x02, 0000, 0x03, 0x03, 0x03, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000,
+  0000, 0x01, 0x01, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000,
+  0x01, 0x01, 0000, 0000, 0x01, 0x01, 0x01, 0000, 0x06, 0x06, 0x06, 0000,
+  0x06, 0x06, 0x07, 0000, 0x06, 0x07, 0x06, 0000, 0x06, 0x07, 0x07, 0000,
+  0x07, 0x06, 0x06, 0000, 0x07, 0x06, 0x07, 0000, 0x07, 0x07, 0x06, 0000,
+  0x07, 0x07, 0x07, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x03, 0000, 0000, 0000,
+  0x04, 0000, 0000, 0000, 0x05, 0000, 0000, 0000, 0x06, 0000, 0000, 0000,
+  0x07, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xf3, 0x04, 0x35, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xf3, 0x04, 0x35, 0x3f,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0x80, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x00
+};
+
+// the archive written by ocnn/octree/tools/build_octree with the points of
+// octree_8, which contains octree_8 with the label 3
+static const char archive_1[] = {
+  0x5f, 0x4f, 0x43, 0x54, 0x52, 0x45, 0x45, 0x5f, 0x50, 0x4b, 0x5f, 0x31,
+  0x2e, 0x30, 0x5f, 0000, 0x78, 0x06, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x5f, 0x4f, 0x43, 0x54,
+  0x52, 0x45, 0x45, 0x5f, 0x31, 0x2e, 0x30, 0x5f, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0x02, 0000, 0000, 0000,
+  0x04, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x40,
+  0xcd, 0xcc, 0xcc, 0x3d, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x40, 0000, 0000, 0000, 0x10, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x09, 0000, 0000, 0000,
+  0x49, 0000, 0000, 0000, 0x59, 0000, 0000, 0000, 0x59, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x08, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x0b, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xae, 0x67, 0xbb, 0xbe,
+  0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe, 0xec, 0xd9, 0xae, 0x3f,
+  0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xcc, 0x02, 0000, 0000, 0x30, 0x04, 0000, 0000, 0x94, 0x05, 0000, 0000,
+  0x94, 0x05, 0000, 0000, 0x54, 0x06, 0000, 0000, 0x54, 0x06, 0000, 0000,
+  0x54, 0x06, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0x01, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000, 0x01, 0x01, 0000, 0000,
+  0x01, 0x01, 0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000,
+  0000, 0x01, 0000, 0000, 0000, 0x01, 0x01, 0000, 0x01, 0000, 0000, 0000,
+  0x01, 0000, 0x01, 0000, 0x01, 0x01, 0000, 0000, 0x01, 0x01, 0x01, 0000,
+  0000, 0000, 0x02, 0000, 0000, 0000, 0x03, 0000, 0000, 0x01, 0x02, 0000,
+  0000, 0x01, 0x03, 0000, 0x01, 0000, 0x02, 0000, 0x01, 0000, 0x03, 0000,
+  0x01, 0x01, 0x02, 0000, 0x01, 0x01, 0x03, 0000, 0000, 0x02, 0000, 0000,
+  0000, 0x02, 0x01, 0000, 0000, 0x03, 0000, 0000, 0000, 0x03, 0x01, 0000,
+  0x01, 0x02, 0000, 0000, 0x01, 0x02, 0x01, 0000, 0x01, 0x03, 0000, 0000,
+  0x01, 0x03, 0x01, 0000, 0000, 0x02, 0x02, 0000, 0000, 0x02, 0x03, 0000,
+  0000, 0x03, 0x02, 0000, 0000, 0x03, 0x03, 0000, 0x01, 0x02, 0x02, 0000,
+  0x01, 0x02, 0x03, 0000, 0x01, 0x03, 0x02, 0000, 0x01, 0x03, 0x03, 0000,
+  0x02, 0000, 0000, 0000, 0x02, 0000, 0x01, 0000, 0x02, 0x01, 0000, 0000,
+  0x02, 0x01, 0x01, 0000, 0x03, 0000, 0000, 0000, 0x03, 0000, 0x01, 0000,
+  0x03, 0x01, 0000, 0000, 0x03, 0x01, 0x01, 0000, 0x02, 0000, 0x02, 0000,
+  0x02, 0000, 0x03, 0000, 0x02, 0x01, 0x02, 0000, 0x02, 0x01, 0x03, 0000,
+  0x03, 0000, 0x02, 0000, 0x03, 0000, 0x03, 0000, 0x03, 0x01, 0x02, 0000,
+  0x03, 0x01, 0x03, 0000, 0x02, 0x02, 0000, 0000, 0x02, 0x02, 0x01, 0000,
+  0x02, 0x03, 0000, 0000, 0x02, 0x03, 0x01, 0000, 0x03, 0x02, 0000, 0000,
+  0x03, 0x02, 0x01, 0000, 0x03, 0x03, 0000, 0000, 0x03, 0x03, 0x01, 0000,
+  0x02, 0x02, 0x02, 0000, 0x02, 0x02, 0x03, 0000, 0x02, 0x03, 0x02, 0000,
+  0x02, 0x03, 0x03, 0000, 0x03, 0x02, 0x02, 0000, 0x03, 0x02, 0x03, 0000,
+  0x03, 0x03, 0x02, 0000, 0x03, 0x03, 0x03, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0x01, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0x01, 0000, 0x01, 0x01, 0000, 0000,
+  0x01, 0x01, 0x01, 0000, 0x06, 0x06, 0x06, 0000, 0x06, 0x06, 0x07, 0000,
+  0x06, 0x07, 0x06, 0000, 0x06, 0x07, 0x07, 0000, 0x07, 0x06, 0x06, 0000,
+  0x07, 0x06, 0x07, 0000, 0x07, 0x07, 0x06, 0000, 0x07, 0x07, 0x07, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0x04, 0000, 0000, 0000,
+  0x05, 0000, 0000, 0000, 0x06, 0000, 0000, 0000, 0x07, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xf3, 0x04, 0x35, 0x3f, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xf3, 0x04, 0x35, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x80, 0x3f, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x20, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x54, 0x06, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x11, 0000, 0000, 0000, 0x70, 0x33, 0x5f, 0x33,
+  0x5f, 0x32, 0x5f, 0x30, 0x30, 0x30, 0x2e, 0x6f, 0x63, 0x74, 0x72, 0x65,
+  0x65, 0x00
+};
+
+// octree_7 saved in the compact format by ocnn/octree/tools/compress_octree
+// without quantization
+static const char compact_1[] = {
+  0x5f, 0x4f, 0x43, 0x54, 0x52, 0x45, 0x45, 0x5f, 0x43, 0x5a, 0x5f, 0x31,
+  0x2e, 0x30, 0x5f, 0000, 0000, 0000, 0000, 0000, 0x5f, 0x4f, 0x43, 0x54,
+  0x52, 0x45, 0x45, 0x5f, 0x31, 0x2e, 0x30, 0x5f, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x05, 0000, 0000, 0000, 0x02, 0000, 0000, 0000,
+  0x04, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x40,
+  0xcd, 0xcc, 0xcc, 0x3d, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x40, 0000, 0000, 0000, 0x10, 0000, 0000, 0000,
+  0x10, 0000, 0000, 0000, 0x10, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x09, 0000, 0000, 0000,
+  0x49, 0000, 0000, 0000, 0x59, 0000, 0000, 0000, 0x69, 0000, 0000, 0000,
+  0x79, 0000, 0000, 0000, 0x79, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x08, 0000, 0000, 0000,
+  0x02, 0000, 0000, 0000, 0x02, 0000, 0000, 0000, 0x02, 0000, 0000, 0000,
+  0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x0b, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0x05, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0xae, 0x67, 0xbb, 0xbe,
+  0xae, 0x67, 0xbb, 0xbe, 0xae, 0x67, 0xbb, 0xbe, 0xec, 0xd9, 0xae, 0x3f,
+  0xec, 0xd9, 0xae, 0x3f, 0xec, 0xd9, 0xae, 0x3f, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xcc, 0x02, 0000, 0000, 0xb0, 0x04, 0000, 0000, 0x94, 0x06, 0000, 0000,
+  0x94, 0x06, 0000, 0000, 0x54, 0x07, 0000, 0000, 0x54, 0x07, 0000, 0000,
+  0x54, 0x07, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0x01, 0xfe, 0xfd, 0000, 0000, 0000, 0000,
+  0000, 0x2f, 0x14, 0x1c, 0x2f, 0x4e, 0xca, 0x0f, 0x5f, 0xe0, 0x1c, 0x9e,
+  0x0e, 0xe0, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x51, 0x99, 0x6a,
+  0x67, 0x64, 0xe0, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0x0e, 0xab, 0xd7, 0xd6, 0x3a, 0x67, 0x00
+};
+
+// octree_5 saved in the compact format with the features quantized to 8 bits
+static const char compact_2[] = {
+  0x5f, 0x4f, 0x43, 0x54, 0x52, 0x45, 0x45, 0x5f, 0x43, 0x5a, 0x5f, 0x31,
+  0x2e, 0x30, 0x5f, 0000, 0x08, 0000, 0000, 0000, 0x5f, 0x4f, 0x43, 0x54,
+  0x52, 0x45, 0x45, 0x5f, 0x31, 0x2e, 0x30, 0x5f, 0000, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x05, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x03, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x40, 0x40,
+  0000, 0000, 0xa0, 0x40, 0000, 0x01, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x08, 0000, 0000, 0000, 0x08, 0000, 0000, 0000,
+  0x08, 0000, 0000, 0000, 0x08, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x09, 0000, 0000, 0000,
+  0x11, 0000, 0000, 0000, 0x19, 0000, 0000, 0000, 0x21, 0000, 0000, 0000,
+  0x29, 0000, 0000, 0000, 0x29, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x3b, 0000, 0000, 0000,
+  0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x06, 0000, 0000, 0000, 0x01, 0000, 0000, 0000, 0x01, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0000, 0000, 0000, 0000, 0x05, 0000, 0000, 0000, 0x05, 0000, 0000, 0000,
+  0xff, 0xff, 0xff, 0xff, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0x40,
+  0000, 0000, 0000, 0x40, 0000, 0000, 0000, 0x40, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0xcc, 0x02, 0000, 0000, 0x70, 0x03, 0000, 0000, 0x14, 0x04, 0000, 0000,
+  0x14, 0x04, 0000, 0000, 0xd4, 0x04, 0000, 0000, 0xf4, 0x04, 0000, 0000,
+  0x98, 0x05, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0000, 0000, 0000, 0x01, 0x3f, 0xfd, 0x01, 0x01, 0x01, 0x81,
+  0x80, 0000, 0000, 0000, 0000, 0000, 0x43, 0x21, 0xa6, 0xc3, 0x64, 0x44,
+  0x97, 0x07, 0xac, 0x1a, 0x5a, 0x9c, 0x91, 0xe5, 0x59, 0xe5, 0x1b, 0x1b,
+  0x3d, 0x66, 0xc7, 0xdc, 0xce, 0x5b, 0x17, 0xa9, 0xfe, 0x7c, 0x2b, 0xf3,
+  0x40, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000,
+  0x03, 0x1d, 0x89, 0x9d, 0x77, 0xef, 0xb5, 0x8c, 0000, 0000, 0000, 0x01,
+  0x1c, 0x37, 0x78, 0x6b, 0x50, 0xe4, 0x54, 0000, 0000, 0000, 0000, 0x63,
+  0xc3, 0xb7, 0x77, 0x4f, 0x56, 0xd4, 0000, 0000, 0000, 0000, 0000, 0000,
+  0000, 0000, 0x00
+};
+
 const struct embedded_file {
   const char *name;
   const char *data;
@@ -2149,6 +2750,11 @@ const struct embedded_file {
   { "octree_4", octree_4, sizeof(octree_4) - 1 },
   { "octree_5", octree_5, sizeof(octree_5) - 1 },
   { "octree_6", octree_6, sizeof(octree_6) - 1 },
+  { "octree_7", octree_7, sizeof(octree_7) - 1 },
+  { "octree_8", octree_8, sizeof(octree_8) - 1 },
+  { "archive_1", archive_1, sizeof(archive_1) - 1 },
+  { "compact_1", compact_1, sizeof(compact_1) - 1 },
+  { "compact_2", compact_2, sizeof(compact_2) - 1 },
   { nullptr, nullptr, 0 }
 };
 
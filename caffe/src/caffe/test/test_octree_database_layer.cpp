@@ -0,0 +1,313 @@
+#if defined(USE_LEVELDB) || defined(USE_LMDB)
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "boost/scoped_ptr.hpp"
+
+#include "caffe/layers/octree_database_layer.hpp"
+#include "caffe/layers/octree_full_voxel_layer.hpp"
+#include "caffe/layers/octree_pooling_layer.hpp"
+#include "caffe/util/db.hpp"
+#include "caffe/util/io.hpp"
+#include "caffe/util/octree_record.hpp"
+
+#include "caffe/test/test_octree.hpp"
+
+namespace caffe {
+
+using boost::scoped_ptr;
+
+template <typename TypeParam>
+class OctreeDataBaseLayerTest : public OctreeTest<TypeParam> {
+  typedef typename TypeParam::Dtype Dtype;
+
+ protected:
+  OctreeDataBaseLayerTest() : depth_(5), batch_size_(4), record_num_(10) {}
+
+  virtual void SetUp() {
+#ifdef USE_LMDB
+    backend_ = DataParameter_DB_LMDB;
+#else
+    backend_ = DataParameter_DB_LEVELDB;
+#endif
+    MakeTempDir(&source_);
+
+    // the i^th record is labeled with i, and the octrees have 8, 312 and 16
+    // nodes at the depth 5
+    const char* names[] = { "octree_1", "octree_2", "octree_7" };
+    scoped_ptr<db::DB> db(db::GetDB(backend_));
+    db->Open(source_, db::NEW);
+    scoped_ptr<db::Transaction> txn(db->NewTransaction());
+    for (int i = 0; i < record_num_; ++i) {
+      size_t sz = 0;
+      const char* octree = get_test_octree(names[i % 3], &sz);
+      OctreeParser parser;
+      parser.set_cpu(octree);
+      node_num_.push_back(parser.info().node_num(depth_));
+
+      string record;
+      octree::pack_octree_record(record, octree, sz, i);
+      char key[16];
+      snprintf(key, sizeof(key), "%08d", i);
+      txn->Put(key, record);
+    }
+    txn->Commit();
+    db->Close();
+  }
+
+  LayerParameter layer_param(const int max_nodes, const int bucket_num,
+      const int loader_num) {
+    LayerParameter param;
+    param.set_phase(TRAIN);
+    DataParameter* data_param = param.mutable_data_param();
+    data_param->set_batch_size(batch_size_);
+    data_param->set_source(source_.c_str());
+    data_param->set_backend(backend_);
+    OctreeParameter* octree_param = param.mutable_octree_param();
+    octree_param->set_curr_depth(depth_);
+    octree_param->set_signal_channel(3);
+    octree_param->set_max_nodes(max_nodes);
+    octree_param->set_size_bucket_num(bucket_num);
+    octree_param->set_loader_thread_num(loader_num);
+    return param;
+  }
+
+  // forward batch_num batches, and keep the labels and the octree of each one
+  void Forward(const LayerParameter& param, const int batch_num,
+      vector<vector<int> >& labels, vector<string>& octrees) {
+    OctreeDataBaseLayer<Dtype> layer(param);
+    Blob<Dtype> data, label, octree;
+    vector<Blob<Dtype>*> bottom, top{ &data, &label, &octree };
+    layer.SetUp(bottom, top);
+    labels.clear();
+    octrees.clear();
+    for (int i = 0; i < batch_num; ++i) {
+      layer.Forward(bottom, top);
+      OctreeParser parser;
+      parser.set_cpu(octree.cpu_data());
+      const OctreeInfo& info = parser.info();
+      ASSERT_EQ(label.count(), info.batch_size());
+      labels.push_back(vector<int>());
+      for (int j = 0; j < label.count(); ++j) {
+        labels.back().push_back(static_cast<int>(label.cpu_data()[j]));
+      }
+      octrees.push_back(string(reinterpret_cast<const char*>(octree.cpu_data()),
+          info.sizeof_octree()));
+    }
+  }
+
+  // the bucket of the record, refer to OctreeParameter.size_bucket_num
+  int Bucket(const int label, const int max_nodes, const int bucket_num) {
+    int b = 0;
+    while (b + 1 < bucket_num && (node_num_[label] << (b + 1)) <= max_nodes) b++;
+    return b;
+  }
+
+  // The batches are packed from the buckets, which keep the records in the
+  // order they are read. So the records of each bucket, concatenated in the
+  // order of the batches, are the records of the bucket in the database
+  // order, repeated epoch by epoch, without any record dropped or duplicated.
+  void CheckBatches(const vector<vector<int> >& labels, const int max_nodes,
+      const int bucket_num) {
+    const int bucket_count = std::max(bucket_num, 1);
+    vector<vector<int> > bucket_labels(bucket_count);
+    for (const vector<int>& batch : labels) {
+      ASSERT_FALSE(batch.empty());
+      EXPECT_LE(static_cast<int>(batch.size()), batch_size_);
+      const int b = Bucket(batch[0], max_nodes, bucket_num);
+      int nodes = 0;
+      for (int label : batch) {
+        EXPECT_EQ(Bucket(label, max_nodes, bucket_num), b);
+        bucket_labels[b].push_back(label);
+        nodes += node_num_[label];
+      }
+      // an octree with more than max_nodes nodes makes a batch by itself
+      if (batch.size() > 1) EXPECT_LE(nodes, max_nodes);
+    }
+
+    for (int b = 0; b < bucket_count; ++b) {
+      int i = 0;
+      for (int label : bucket_labels[b]) {
+        while (Bucket(i % record_num_, max_nodes, bucket_num) != b) i++;
+        ASSERT_EQ(label, i % record_num_) << "bucket " << b;
+        i++;
+      }
+    }
+  }
+
+ protected:
+  int depth_;
+  int batch_size_;
+  int record_num_;
+  vector<int> node_num_;
+  string source_;
+  DataParameter_DB backend_;
+};
+
+TYPED_TEST_CASE(OctreeDataBaseLayerTest, TestDtypesAndDevices);
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestBatchSize) {
+  // without max_nodes, each batch has batch_size octrees in order
+  vector<vector<int> > labels;
+  vector<string> octrees;
+  this->Forward(this->layer_param(0, 0, 1), 6, labels, octrees);
+  for (int i = 0; i < labels.size(); ++i) {
+    ASSERT_EQ(static_cast<int>(labels[i].size()), this->batch_size_);
+    for (int j = 0; j < this->batch_size_; ++j) {
+      EXPECT_EQ(labels[i][j], (i * this->batch_size_ + j) % this->record_num_);
+    }
+  }
+}
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestMaxNodes) {
+  // one bucket, the octrees are packed in order
+  const int max_nodes = 330;
+  vector<vector<int> > labels;
+  vector<string> octrees;
+  this->Forward(this->layer_param(max_nodes, 1, 1), 12, labels, octrees);
+  this->CheckBatches(labels, max_nodes, 1);
+
+  // each batch is closed only when it is full or the next octree does not fit
+  for (int i = 0; i + 1 < labels.size(); ++i) {
+    int nodes = 0;
+    for (int label : labels[i]) nodes += this->node_num_[label];
+    const int next = labels[i + 1][0];
+    const bool full = static_cast<int>(labels[i].size()) == this->batch_size_;
+    EXPECT_TRUE(full || nodes >= max_nodes ||
+        nodes + this->node_num_[next] > max_nodes) << "batch " << i;
+  }
+
+  // an octree with more nodes than max_nodes makes a batch by itself
+  this->Forward(this->layer_param(100, 1, 1), 12, labels, octrees);
+  this->CheckBatches(labels, 100, 1);
+}
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestSizeBuckets) {
+  // the octree_2 records are in the bucket 0, and the others in the bucket 2
+  const int max_nodes = 330, bucket_num = 3;
+  vector<vector<int> > labels;
+  vector<string> octrees;
+  this->Forward(this->layer_param(max_nodes, bucket_num, 1), 16, labels, octrees);
+  this->CheckBatches(labels, max_nodes, bucket_num);
+}
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestLoaderThreads) {
+  // the batches do not depend on the number of the loaders
+  const int max_nodes = 330, bucket_num = 3, batch_num = 16;
+  vector<vector<int> > labels, labels_gt;
+  vector<string> octrees, octrees_gt;
+  this->Forward(this->layer_param(max_nodes, bucket_num, 1), batch_num,
+      labels_gt, octrees_gt);
+  const int loader_nums[] = { 2, 3 };
+  for (int loader_num : loader_nums) {
+    // repeated, since the order of the loaders changes from run to run
+    for (int r = 0; r < 3; ++r) {
+      this->Forward(this->layer_param(max_nodes, bucket_num, loader_num),
+          batch_num, labels, octrees);
+      ASSERT_EQ(labels, labels_gt) << loader_num << " loaders";
+      ASSERT_EQ(octrees, octrees_gt) << loader_num << " loaders";
+    }
+  }
+}
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestDownstreamLayers) {
+  // with max_nodes, the layers after the data layer follow the batch size of
+  // the octree, which is at most batch_size
+  typedef typename TypeParam::Dtype Dtype;
+  const int max_nodes = 330, full_depth = 2;
+  OctreeDataBaseLayer<Dtype> layer(this->layer_param(max_nodes, 1, 1));
+  Blob<Dtype> data, label, octree;
+  vector<Blob<Dtype>*> bottom, top{ &data, &label, &octree };
+  layer.SetUp(bottom, top);
+
+  LayerParameter pool_param;
+  pool_param.mutable_octree_param()->set_curr_depth(this->depth_);
+  OctreePoolingLayer<Dtype> pool_layer(pool_param);
+  Blob<Dtype> pool_top;
+  vector<Blob<Dtype>*> pool_bottom_vec{ &data, &octree }, pool_top_vec{ &pool_top };
+  pool_layer.SetUp(pool_bottom_vec, pool_top_vec);
+
+  LayerParameter voxel_param;
+  voxel_param.mutable_octree_param()->set_curr_depth(full_depth);
+  voxel_param.mutable_octree_param()->set_batch_size(this->batch_size_);
+  Octree2FullVoxelLayer<Dtype> voxel_layer(voxel_param);
+  Blob<Dtype> voxel_bottom, voxel_top;
+  vector<Blob<Dtype>*> voxel_bottom_vec{ &voxel_bottom, &octree },
+      voxel_top_vec{ &voxel_top };
+  voxel_bottom.Reshape(vector<int>{ 1, 2, 1, 1 });
+  voxel_layer.SetUp(voxel_bottom_vec, voxel_top_vec);
+
+  bool partial = false;
+  for (int i = 0; i < 8; ++i) {
+    layer.Forward(bottom, top);
+    OctreeParser parser;
+    parser.set_cpu(octree.cpu_data());
+    const int batch_size = parser.info().batch_size();
+    partial |= batch_size < this->batch_size_;
+
+    pool_layer.Reshape(pool_bottom_vec, pool_top_vec);
+    pool_layer.Forward(pool_bottom_vec, pool_top_vec);
+    EXPECT_EQ(pool_top.shape(2), parser.info().node_num(this->depth_ - 1));
+
+    // the full layer has 8^full_depth nodes per octree, and the voxels of
+    // each octree and channel are a permutation of its nodes
+    const int voxel_num = 1 << 3 * full_depth;
+    const int node_num = parser.info().node_num(full_depth);
+    ASSERT_EQ(node_num, batch_size * voxel_num);
+    voxel_bottom.Reshape(vector<int>{ 1, 2, node_num, 1 });
+    Dtype* btm = voxel_bottom.mutable_cpu_data();
+    for (int j = 0; j < voxel_bottom.count(); ++j) btm[j] = j;
+    voxel_layer.Reshape(voxel_bottom_vec, voxel_top_vec);
+    voxel_layer.Forward(voxel_bottom_vec, voxel_top_vec);
+    ASSERT_EQ(voxel_top.shape(0), batch_size);
+    const Dtype* vox = voxel_top.cpu_data();
+    for (int n = 0; n < batch_size; ++n) {
+      for (int c = 0; c < 2; ++c) {
+        vector<int> idx(vox + (n * 2 + c) * voxel_num,
+            vox + (n * 2 + c + 1) * voxel_num);
+        std::sort(idx.begin(), idx.end());
+        for (int k = 0; k < voxel_num; ++k) {
+          ASSERT_EQ(idx[k], c * node_num + n * voxel_num + k);
+        }
+      }
+    }
+  }
+  EXPECT_TRUE(partial) << "no batch with less than batch_size octrees";
+}
+
+TYPED_TEST(OctreeDataBaseLayerTest, TestSolverRanks) {
+  // With 2 solvers, the solver of the rank r reads the records whose offset
+  // in the database is r modulo 2, so the ranks see disjoint records. The
+  // solver of the layer is set in its loader threads.
+  const int solver_count = 2, batch_num = 6;
+  Caffe::set_solver_count(solver_count);
+  const int max_nodes[] = { 0, 330 };
+  for (int max_node : max_nodes) {
+    const int bucket_num = max_node > 0 ? 3 : 0;
+    vector<vector<int> > labels_gt[solver_count];
+    for (int rank = 0; rank < solver_count; ++rank) {
+      Caffe::set_solver_rank(rank);
+      vector<string> octrees;
+      this->Forward(this->layer_param(max_node, bucket_num, 1), batch_num,
+          labels_gt[rank], octrees);
+      for (const vector<int>& batch : labels_gt[rank]) {
+        for (int label : batch) {
+          EXPECT_EQ(label % solver_count, rank) << "max_nodes " << max_node;
+        }
+      }
+
+      vector<vector<int> > labels;
+      this->Forward(this->layer_param(max_node, bucket_num, 3), batch_num,
+          labels, octrees);
+      EXPECT_EQ(labels, labels_gt[rank]) << "rank " << rank << ", max_nodes "
+          << max_node;
+    }
+  }
+  Caffe::set_solver_rank(0);
+  Caffe::set_solver_count(1);
+}
+
+}  // namespace caffe
+#endif  // USE_LEVELDB or USE_LMDB
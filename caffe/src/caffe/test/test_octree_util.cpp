@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <fstream>
+
+#include "caffe/util/io.hpp"
 #include "caffe/util/octree.hpp"
+#include "caffe/util/octree_archive.hpp"
+#include "caffe/util/octree_codec.hpp"
 
 #include "caffe/test/test_octree.hpp"
 
@@ -271,4 +277,284 @@ TYPED_TEST(OctreeUtilTest, TestXYZ2Key) {
   }
 }
 
-} // namespace caffe
\ No newline at end of file
+TYPED_TEST(OctreeUtilTest, TestMergeKeys) {
+  const int num = 2, batch_idx = 3;
+  typedef unsigned long long uint64;
+  const uint64 bi = static_cast<uint64>(batch_idx) << 48;
+
+  // 32-bit keys, the 4th byte is replaced by the batch index
+  unsigned int key32[] = { 0x00ABCDEFu, 0xFF000001u }, des32[num];
+  octree::merge_keys_cpu(des32, 1, key32, 1, num, batch_idx, true);
+  EXPECT_EQ(des32[0], 0x03ABCDEFu);
+  EXPECT_EQ(des32[1], 0x03000001u);
+
+  // the xyz bytes are widened to shorts
+  unsigned char xyz[] = { 1, 2, 3, 0, 255, 0, 7, 0 };
+  uint64 des64[num];
+  octree::merge_keys_cpu(reinterpret_cast<unsigned int*>(des64), 2,
+      reinterpret_cast<unsigned int*>(xyz), 1, num, batch_idx, true);
+  EXPECT_EQ(des64[0], 1ull | (2ull << 16) | (3ull << 32) | bi);
+  EXPECT_EQ(des64[1], 255ull | (7ull << 32) | bi);
+
+  // the Morton keys of depth 10 take 30 bits, which are kept
+  unsigned int morton[] = { 0x3FFFFFFFu, 0x24924924u };
+  octree::merge_keys_cpu(reinterpret_cast<unsigned int*>(des64), 2,
+      morton, 1, num, batch_idx, false);
+  EXPECT_EQ(des64[0], 0x3FFFFFFFull | bi);
+  EXPECT_EQ(des64[1], 0x24924924ull | bi);
+
+  // the 64-bit keys, the 4th short is replaced by the batch index
+  uint64 key64[] = { 0x0000123456789ABCull, 0xFFFF000000000001ull };
+  octree::merge_keys_cpu(reinterpret_cast<unsigned int*>(des64), 2,
+      reinterpret_cast<unsigned int*>(key64), 2, num, batch_idx, false);
+  EXPECT_EQ(des64[0], 0x0000123456789ABCull | bi);
+  EXPECT_EQ(des64[1], 0x0000000000000001ull | bi);
+}
+
+TYPED_TEST(OctreeUtilTest, TestFullNeigh) {
+  typedef unsigned int uint32;
+  // the depths are visited out of order and twice, so that both the tables
+  // built on the first call and the cached ones are checked
+  const int depths[] = { 3, 1, 5, 2, 4, 3, 1, 5, 2, 4 };
+  const int batch_sizes[] = { 1, 2, 3 };
+  for (int depth : depths) {
+    for (int batch_size : batch_sizes) {
+      // the neighbors computed from the coordinates without the cache
+      const uint32 node_num = 1 << 3 * depth, bound = 1 << depth;
+      vector<int> neigh_gt(batch_size * node_num * 8);
+      for (uint32 n = 0; n < batch_size; ++n) {
+        for (uint32 i = 0; i < node_num; i += 8) {
+          uint32 x0 = 0, y0 = 0, z0 = 0;
+          for (uint32 d = 0; d < depth; d++) {
+            x0 |= (i & (1 << (3 * d + 2))) >> (2 * d + 2);
+            y0 |= (i & (1 << (3 * d + 1))) >> (2 * d + 1);
+            z0 |= (i & (1 << (3 * d + 0))) >> (2 * d + 0);
+          }
+          for (uint32 xyz = 0; xyz < 64; ++xyz) {
+            uint32 x1 = x0 + (xyz >> 4) - 1;
+            uint32 y1 = y0 + ((xyz >> 2) & 3) - 1;
+            uint32 z1 = z0 + (xyz & 3) - 1;
+            int v = -1;
+            if ((x1 & bound) == 0 && (y1 & bound) == 0 && (z1 & bound) == 0) {
+              uint32 key1 = 0;
+              for (int d = 0; d < depth; d++) {
+                uint32 mask = 1u << d;
+                key1 |= ((x1 & mask) << (2 * d + 2)) |
+                    ((y1 & mask) << (2 * d + 1)) | ((z1 & mask) << (2 * d));
+              }
+              v = key1 + n * node_num;
+            }
+            neigh_gt[xyz + i * 8 + n * node_num * 8] = v;
+          }
+        }
+      }
+
+      Blob<int> neigh(vector<int> {static_cast<int>(neigh_gt.size())});
+      if (Caffe::mode() == Caffe::CPU) {
+        octree::calc_neigh_cpu(neigh.mutable_cpu_data(), depth, batch_size);
+      } else {
+        octree::calc_neigh_gpu(neigh.mutable_gpu_data(), depth, batch_size);
+      }
+      const int* rst = neigh.cpu_data();
+      for (int i = 0; i < neigh.count(); ++i) {
+        ASSERT_EQ(rst[i], neigh_gt[i]) << "depth " << depth
+            << ", batch size " << batch_size << ", index " << i;
+      }
+
+      // the cached table is the one of the first octree in the batch
+      const vector<int>& full_neigh = Octree::get_full_neigh(depth);
+      ASSERT_EQ(full_neigh.size(), node_num * 8);
+      EXPECT_TRUE(std::equal(full_neigh.begin(), full_neigh.end(), neigh_gt.begin()));
+    }
+  }
+}
+
+TYPED_TEST(OctreeUtilTest, TestMergeOctreesNeighMask) {
+  typedef typename TypeParam::Dtype Dtype;
+  // the full layer of the octrees is 2, the bit 1 is below the full layer,
+  // and the bits 3 and 5 need the neighbors of the depths above them
+  const int masks[] = { 0, 1 << 1, 1 << 2, 1 << 5, (1 << 1) | (1 << 4), 1 << 3 };
+  const vector<vector<string> > batches{
+    { "octree_1", "octree_2" }, { "octree_3", "octree_4" } };
+  for (const vector<string>& names : batches) {
+    vector<const char*> octrees;
+    for (const string& name : names) octrees.push_back(get_test_octree(name.c_str()));
+    Blob<Dtype> batch_gt;
+    octree::merge_octrees(batch_gt, octrees, -1);
+
+    for (int mask : masks) {
+      Blob<Dtype> batch;
+      octree::merge_octrees(batch, octrees, mask);
+      OctreeParser parser;
+      parser.set_cpu(batch.mutable_cpu_data());
+      const OctreeInfo& info = parser.info();
+      ASSERT_TRUE(info.has_property(OctreeInfo::kNeigh));
+      int done_mask = octree::neigh_depth_closure(mask, info.depth(), info.full_layer());
+      EXPECT_EQ(done_mask & (1 << 1), mask & (1 << 1));
+
+      // the neighbors of the other depths are calculated afterwards
+      done_mask = octree::update_neigh_cpu(parser, -1, done_mask);
+      EXPECT_EQ(done_mask, (2 << info.depth()) - 2);
+      ASSERT_EQ(batch.count(), batch_gt.count());
+      EXPECT_EQ(memcmp(batch.cpu_data(), batch_gt.cpu_data(),
+          batch.count() * sizeof(Dtype)), 0) << names[0] << ", mask " << mask;
+    }
+  }
+}
+
+TYPED_TEST(OctreeUtilTest, TestMergeOctreesContentFlags) {
+  typedef typename TypeParam::Dtype Dtype;
+  vector<const char*> octrees{
+    get_test_octree("octree_1"), get_test_octree("octree_2") };
+  Blob<Dtype> batch_gt, batch;
+  octree::merge_octrees(batch_gt, octrees, -1);
+  const int flags = OctreeInfo::kKey | OctreeInfo::kChild | OctreeInfo::kFeature;
+  octree::merge_octrees(batch, octrees, -1, flags);
+
+  // the label and split label are left out, and the others are the same
+  OctreeParser parser, parser_gt;
+  parser.set_cpu(batch.cpu_data());
+  parser_gt.set_cpu(batch_gt.cpu_data());
+  const OctreeInfo& info = parser.info();
+  EXPECT_FALSE(info.has_property(OctreeInfo::kLabel));
+  EXPECT_FALSE(info.has_property(OctreeInfo::kSplit));
+  ASSERT_TRUE(info.has_property(OctreeInfo::kFeature));
+  EXPECT_LE(info.sizeof_octree(), parser_gt.info().sizeof_octree());
+  const int channel = info.channel(OctreeInfo::kFeature);
+  const int key_channel = info.channel(OctreeInfo::kKey);
+  for (int d = 0; d <= info.depth(); ++d) {
+    const int nnum = info.node_num(d);
+    ASSERT_EQ(nnum, parser_gt.info().node_num(d));
+    EXPECT_TRUE(std::equal(parser.key_cpu(d), parser.key_cpu(d) + nnum * key_channel,
+        parser_gt.key_cpu(d)));
+    EXPECT_TRUE(std::equal(parser.children_cpu(d), parser.children_cpu(d) + nnum,
+        parser_gt.children_cpu(d)));
+    if (d > 0) {  // the neighbors of the root are not calculated
+      EXPECT_TRUE(std::equal(parser.neighbor_cpu(d), parser.neighbor_cpu(d) + nnum * 8,
+          parser_gt.neighbor_cpu(d)));
+    }
+    if (info.locations(OctreeInfo::kFeature) == -1 || d == info.depth()) {
+      EXPECT_TRUE(std::equal(parser.feature_cpu(d),
+          parser.feature_cpu(d) + nnum * channel, parser_gt.feature_cpu(d)));
+    }
+  }
+}
+
+TYPED_TEST(OctreeUtilTest, TestTruncateOctree) {
+  // cut octree_7 to depth 3, and compare it with octree_8 built from the
+  // same points with depth 3
+  const char* octree_in = get_test_octree("octree_7");
+  const char* octree_gt = get_test_octree("octree_8");
+  vector<char> octree_out;
+  octree::truncate_octree(octree_out, octree_in, 3);
+
+  OctreeParser parser, parser_gt;
+  parser.set_cpu(octree_out.data());
+  parser_gt.set_cpu(octree_gt);
+  const OctreeInfo& info = parser.info();
+  const OctreeInfo& info_gt = parser_gt.info();
+  const int depth = info_gt.depth();
+  ASSERT_EQ(info.depth(), depth);
+  ASSERT_EQ(info.sizeof_octree(), info_gt.sizeof_octree());
+  for (int d = 0; d <= depth; ++d) {
+    const int nnum = info_gt.node_num(d);
+    ASSERT_EQ(info.node_num(d), nnum);
+    ASSERT_EQ(info.node_num_nempty(d), info_gt.node_num_nempty(d));
+    for (int i = 0; i < nnum; ++i) {
+      ASSERT_EQ(parser.key_cpu(d)[i], parser_gt.key_cpu(d)[i]);
+      ASSERT_EQ(parser.children_cpu(d)[i], parser_gt.children_cpu(d)[i]);
+    }
+  }
+
+  // the normals averaged over the finest nodes are renormalized
+  const int nnum = info_gt.node_num(depth);
+  const int channel = info_gt.channel(OctreeInfo::kFeature);
+  ASSERT_EQ(info.channel(OctreeInfo::kFeature), channel);
+  ASSERT_EQ(info.locations(OctreeInfo::kFeature), depth);
+  const float* feature = parser.feature_cpu(depth);
+  const float* feature_gt = parser_gt.feature_cpu(depth);
+  for (int i = 0; i < nnum * channel; ++i) {
+    EXPECT_NEAR(feature[i], feature_gt[i], 1.0e-6f);
+  }
+}
+
+TYPED_TEST(OctreeUtilTest, TestReadArchive) {
+  // archive_1 is written by the octree library, and contains octree_8
+  size_t sz = 0, sz_octree = 0;
+  const char* archive = get_test_octree("archive_1", &sz);
+  const char* octree = get_test_octree("octree_8", &sz_octree);
+  string filename;
+  MakeTempFilename(&filename);
+  std::ofstream outfile(filename.c_str(), std::ios::out | std::ios::binary);
+  outfile.write(archive, sz);
+  outfile.close();
+
+  octree::OctreeArchive reader;
+  ASSERT_TRUE(reader.open(filename));
+  ASSERT_EQ(reader.size(), 1);
+  EXPECT_EQ(reader.name(0), "p3_3_2_000.octree");
+  EXPECT_EQ(reader.label(0), 3);
+  EXPECT_EQ(reader.pose(0), 0);
+  string data;
+  ASSERT_TRUE(reader.read(0, data));
+  EXPECT_EQ(data, string(octree, sz_octree));
+}
+
+TYPED_TEST(OctreeUtilTest, TestDecompressOctree) {
+  // compact_1 is octree_7 saved by the octree library without quantization
+  size_t sz = 0, sz_gt = 0;
+  const char* compact = get_test_octree("compact_1", &sz);
+  const char* octree_gt = get_test_octree("octree_7", &sz_gt);
+  ASSERT_TRUE(octree::is_compact_octree(compact, sz));
+  EXPECT_FALSE(octree::is_compact_octree(octree_gt, sz_gt));
+
+  OctreeInfo info;
+  ASSERT_TRUE(octree::read_octree_info(info, compact, sz));
+  EXPECT_EQ(memcmp(&info, octree_gt, sizeof(OctreeInfo)), 0);
+  vector<char> buffer;
+  ASSERT_TRUE(octree::decompress_octree(buffer, compact, sz));
+  EXPECT_EQ(string(buffer.data(), buffer.size()), string(octree_gt, sz_gt));
+
+  // the truncated data is rejected
+  EXPECT_FALSE(octree::decompress_octree(buffer, compact, sizeof(OctreeInfo)));
+}
+
+TYPED_TEST(OctreeUtilTest, TestDecompressQuantizedOctree) {
+  // compact_2 is octree_5 with the features quantized to 8 bits, the other
+  // properties are exact
+  size_t sz = 0, sz_gt = 0;
+  const char* compact = get_test_octree("compact_2", &sz);
+  const char* octree_gt = get_test_octree("octree_5", &sz_gt);
+  vector<char> buffer;
+  ASSERT_TRUE(octree::decompress_octree(buffer, compact, sz));
+  ASSERT_EQ(buffer.size(), sz_gt);
+
+  OctreeParser parser, parser_gt;
+  parser.set_cpu(buffer.data());
+  parser_gt.set_cpu(octree_gt);
+  const OctreeInfo& info = parser_gt.info();
+  const int depth = info.depth();
+  ASSERT_EQ(info.locations(OctreeInfo::kFeature), depth);
+  const int nnum = info.node_num(depth);
+  const int channel = info.channel(OctreeInfo::kFeature);
+  const int begin = info.ptr_dis(OctreeInfo::kFeature, depth);
+  const int end = begin + nnum * channel * sizeof(float);
+  EXPECT_EQ(memcmp(buffer.data(), octree_gt, begin), 0);
+  EXPECT_EQ(memcmp(buffer.data() + end, octree_gt + end, sz_gt - end), 0);
+
+  // the error is at most half of the quantization step of each channel
+  const float* feature = parser.feature_cpu(depth);
+  const float* feature_gt = parser_gt.feature_cpu(depth);
+  for (int c = 0; c < channel; ++c) {
+    float max_abs = 0;
+    for (int i = 0; i < nnum; ++i) {
+      max_abs = std::max(max_abs, std::abs(feature_gt[c * nnum + i]));
+    }
+    const float tol = 0.5f * max_abs / 127 + 1.0e-6f;
+    for (int i = 0; i < nnum; ++i) {
+      EXPECT_NEAR(feature[c * nnum + i], feature_gt[c * nnum + i], tol);
+    }
+  }
+}
+
+} // namespace caffe
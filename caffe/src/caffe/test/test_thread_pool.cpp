@@ -0,0 +1,98 @@
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "caffe/util/thread_pool.hpp"
+
+#include "caffe/test/test_caffe_main.hpp"
+
+namespace caffe {
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  // run task_num tasks on the pool, and count the calls of each task
+  static void RunAndCount(ThreadPool& pool, const int task_num,
+      std::vector<std::atomic<int> >& counts) {
+    pool.Run(task_num, [&](int t) { counts[t]++; });
+  }
+
+  static void ExpectCounts(const std::vector<std::atomic<int> >& counts,
+      const int expected) {
+    for (size_t t = 0; t < counts.size(); ++t) {
+      EXPECT_EQ(counts[t].load(), expected) << "task " << t;
+    }
+  }
+};
+
+TEST_F(ThreadPoolTest, TestThreadNum) {
+  ThreadPool pool1(1), pool4(4);
+  EXPECT_EQ(pool1.thread_num(), 1);
+  EXPECT_EQ(pool4.thread_num(), 4);
+  EXPECT_GE(ThreadPool(0).thread_num(), 1);
+}
+
+TEST_F(ThreadPoolTest, TestRunSerial) {
+  // without workers, the tasks are run on the calling thread
+  ThreadPool pool(1);
+  std::vector<std::atomic<int> > counts(100);
+  for (auto& c : counts) c = 0;
+  RunAndCount(pool, 100, counts);
+  ExpectCounts(counts, 1);
+}
+
+TEST_F(ThreadPoolTest, TestRunBackToBack) {
+  // fewer, as many and more tasks than the threads, one call after another
+  ThreadPool pool(4);
+  const int task_nums[] = { 0, 1, 3, 4, 5, 64, 1000 };
+  for (int task_num : task_nums) {
+    std::vector<std::atomic<int> > counts(task_num);
+    for (auto& c : counts) c = 0;
+    for (int i = 0; i < 10; ++i) {
+      RunAndCount(pool, task_num, counts);
+    }
+    ExpectCounts(counts, 10);
+  }
+}
+
+TEST_F(ThreadPoolTest, TestRunConcurrent) {
+  // several threads share the pool, and each call only runs its own tasks
+  ThreadPool pool(3);
+  const int caller_num = 6, run_num = 20, task_num = 257;
+  std::vector<std::vector<std::atomic<int> > > counts(caller_num);
+  std::vector<std::shared_ptr<boost::thread> > callers;
+  for (int i = 0; i < caller_num; ++i) {
+    counts[i] = std::vector<std::atomic<int> >(task_num);
+    for (auto& c : counts[i]) c = 0;
+  }
+  for (int i = 0; i < caller_num; ++i) {
+    callers.emplace_back(new boost::thread([&, i]() {
+      for (int r = 0; r < run_num; ++r) {
+        RunAndCount(pool, task_num, counts[i]);
+      }
+    }));
+  }
+  for (auto& caller : callers) caller->join();
+  for (int i = 0; i < caller_num; ++i) {
+    ExpectCounts(counts[i], run_num);
+  }
+}
+
+TEST_F(ThreadPoolTest, TestRunUnevenTasks) {
+  // the tasks are handed out one by one, so every task still runs once if
+  // some of them take much longer than the others
+  ThreadPool pool(4);
+  const int task_num = 40;
+  std::vector<std::atomic<int> > counts(task_num);
+  for (auto& c : counts) c = 0;
+  pool.Run(task_num, [&](int t) {
+    if (t % 8 == 0) boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+    counts[t]++;
+  });
+  ExpectCounts(counts, 1);
+}
+
+}  // namespace caffe
@@ -3,6 +3,7 @@
 #include <omp.h>
 #include "caffe/util/octree.hpp"
 #include "caffe/util/math_functions.hpp"
+#include "caffe/util/thread_pool.hpp"
 
 namespace caffe {
 // Make sure each thread can have different values.
@@ -109,6 +110,45 @@ void Octree::init_neigh_index() {
   }
 }
 
+const vector<int>& Octree::get_full_neigh(int depth) {
+  typedef unsigned int uint32;
+  CHECK(depth > 0 && depth <= 8) << "Unsupported depth of the full layer";
+  auto& full_neigh = Get().full_neigh_;
+  if (depth + 1 > full_neigh.size()) full_neigh.resize(depth + 1);
+  vector<int>& neigh = full_neigh[depth];
+  if (!neigh.empty()) return neigh;
+
+  const uint32 node_num = 1 << 3 * depth;
+  const uint32 bound = 1 << depth;
+  neigh.resize(node_num * 8);
+  for (uint32 i = 0; i < node_num; i += 8) {
+    // key to xyz
+    uint32 x0, y0, z0;
+    octree::morton_decode(i, x0, y0, z0);
+
+    for (uint32 x = 0; x < 4; ++x) {
+      for (uint32 y = 0; y < 4; ++y) {
+        for (uint32 z = 0; z < 4; ++z) {
+          uint32 x1 = x0 + x - 1;
+          uint32 y1 = y0 + y - 1;
+          uint32 z1 = z0 + z - 1;
+
+          int v = -1;
+          if ((x1 & bound) == 0 &&
+              (y1 & bound) == 0 &&
+              (z1 & bound) == 0) {
+            v = octree::morton_encode(x1, y1, z1);
+          }
+
+          uint32 xyz = (x << 4) | (y << 2) | z;
+          neigh[xyz + i * 8] = v;
+        }
+      }
+    }
+  }
+  return neigh;
+}
+
 shared_ptr<Blob<int> > Octree::get_ni(const vector<int>& kernel_size) {
   CHECK_EQ(kernel_size.size(), 3);
   string key;
@@ -199,15 +239,16 @@ void col2octree_cpu(const Dtype* data_col, Dtype* data_octree,
   }
 }
 
-void generate_key_cpu(unsigned int* key_split, const unsigned int* key,
+template <typename Key>
+void generate_key_cpu(Key* key_split, const Key* key,
     const int* children, const int node_num) {
-  typedef unsigned char ubyte;
+  typedef typename KeyTrait<Key>::Coord Coord;
   for (int i = 0; i < node_num; ++i) {
     int label = children[i];
     if (label == -1) continue;
-    const ubyte* k0 = (const ubyte*)(key + i);
-    for (ubyte j = 0; j < 8; ++j) {
-      ubyte* k1 = (ubyte*)(key_split + 8 * label + j);
+    const Coord* k0 = (const Coord*)(key + i);
+    for (Coord j = 0; j < 8; ++j) {
+      Coord* k1 = (Coord*)(key_split + 8 * label + j);
       k1[0] = (k0[0] << 1) | ((j & 4) >> 2);
       k1[1] = (k0[1] << 1) | ((j & 2) >> 1);
       k1[2] = (k0[2] << 1) | (j & 1);
@@ -216,35 +257,102 @@ void generate_key_cpu(unsigned int* key_split, const unsigned int* key,
   }
 }
 
-void generate_key_cpu(unsigned int* key, const int depth, const int batch_size) {
+// the batched Morton encoding of the key types
+inline void morton_encode_keys(unsigned int* key, const unsigned int* pt,
+    const int num, const int depth) {
+  morton_encode(key, pt, num, depth);
+}
+inline void morton_encode_keys(unsigned long long* key, const unsigned int* pt,
+    const int num, const int depth) {
+  morton_encode64(key, pt, num, depth);
+}
+
+template <typename Key>
+void generate_key_cpu(Key* key, const int depth, const int batch_size) {
+  typedef typename KeyTrait<Key>::Coord Coord;
+  // decode the keys of the first octree with the batched Morton decoding, the
+  // other octrees only differ in the batch index
+  const int kBlockSize = 256;
   int node_num = 1 << 3 * depth;
-  for (int n = 0; n < batch_size; ++n) {
-    for (int k = 0; k < node_num; ++k) {
-      unsigned xyz = 0;
-      unsigned char* ptr = (unsigned char*)(&xyz);
-      for (int d = 0; d < depth; d++) {
-        ptr[0] |= (k & (1 << (3 * d + 2))) >> (2 * d + 2);
-        ptr[1] |= (k & (1 << (3 * d + 1))) >> (2 * d + 1);
-        ptr[2] |= (k & (1 << (3 * d + 0))) >> (2 * d + 0);
+  for (int b = 0; b < node_num; b += kBlockSize) {
+    const int num = std::min(kBlockSize, node_num - b);
+    unsigned int k[kBlockSize], pt[3 * kBlockSize];
+    for (int i = 0; i < num; ++i) { k[i] = b + i; }
+    morton_decode(pt, k, num, depth);
+    for (int i = 0; i < num; ++i) {
+      Key xyz = 0;
+      Coord* ptr = (Coord*)(&xyz);
+      for (int c = 0; c < 3; ++c) {
+        ptr[c] = static_cast<Coord>(pt[3 * i + c]);
       }
-      ptr[3] = n;
-      key[n * node_num + k] = xyz;
+      key[b + i] = xyz;
+    }
+  }
+  for (int n = 1; n < batch_size; ++n) {
+    Key* key_n = key + n * node_num;
+    for (int k = 0; k < node_num; ++k) {
+      Key xyz = key[k];
+      ((Coord*)(&xyz))[3] = n;
+      key_n[k] = xyz;
+    }
+  }
+}
+
+template <typename Key>
+void xyz2key_cpu(Key* key, const Key* xyz, const int num, const int depth) {
+  typedef typename KeyTrait<Key>::Coord Coord;
+  const int kBlockSize = 256;
+  for (int b = 0; b < num; b += kBlockSize) {
+    const int n = std::min(kBlockSize, num - b);
+    unsigned int pt[3 * kBlockSize];
+    Coord batch_idx[kBlockSize];  // read before key is written, which may be xyz
+    for (int i = 0; i < n; ++i) {
+      const Coord* ptr = reinterpret_cast<const Coord*>(xyz + b + i);
+      for (int c = 0; c < 3; ++c) { pt[3 * i + c] = ptr[c]; }
+      batch_idx[i] = ptr[3];
+    }
+    morton_encode_keys(key + b, pt, n, depth);
+    for (int i = 0; i < n; ++i) {
+      Coord* ptr_out = (Coord*)(key + b + i);
+      ptr_out[3] = batch_idx[i];
     }
   }
 }
 
-// NOTE: !!! currently the depth should be less than 8
-void xyz2key_cpu(unsigned int* key, const unsigned int* xyz, const int num, const int depth) {
-  for (int i = 0; i < num; ++i) {
-    unsigned int pt[3] = { 0, 0, 0 }, key_out = 0;
-    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(xyz + i);
-    unsigned char* ptr_out = (unsigned char*)(&key_out);
-    for (int j = 0; j < 3; ++j) {
-      pt[j] = static_cast<unsigned int>(ptr[j]);
+void merge_keys_cpu(unsigned int* des, const int key_channel,
+    const unsigned int* src, const int key_channel_in, const int num,
+    const int batch_idx, const bool key2xyz) {
+  CHECK(key_channel_in == 1 || key_channel_in == 2);
+  CHECK_GE(key_channel, key_channel_in) << "The keys can not be narrowed";
+  if (key_channel == 1) {
+    // the xyz bytes or the Morton bits of depth <= 8 are in the lower 24 bits
+    const unsigned int bi = static_cast<unsigned int>(batch_idx) << 24;
+    for (int j = 0; j < num; ++j) {
+      des[j] = (src[j] & 0x00FFFFFFu) | bi;
+    }
+    return;
+  }
+
+  unsigned long long* des64 = reinterpret_cast<unsigned long long*>(des);
+  const unsigned long long bi = static_cast<unsigned long long>(batch_idx) << 48;
+  if (key_channel_in == 2) {
+    const unsigned long long* src64 =
+        reinterpret_cast<const unsigned long long*>(src);
+    for (int j = 0; j < num; ++j) {
+      des64[j] = (src64[j] & 0x0000FFFFFFFFFFFFull) | bi;
+    }
+  } else if (key2xyz) {
+    // widen the x, y, z bytes to shorts
+    for (int j = 0; j < num; ++j) {
+      unsigned long long k = src[j];
+      des64[j] = (k & 0xFFull) | ((k & 0xFF00ull) << 8) |
+          ((k & 0xFF0000ull) << 16) | bi;
+    }
+  } else {
+    // the 32-bit Morton key holds at most 30 bits, which are kept as they are
+    for (int j = 0; j < num; ++j) {
+      des64[j] = static_cast<unsigned long long>(src[j]) | bi;
     }
-    compute_key(key_out, pt, depth);
-    ptr_out[3] = ptr[3];
-    key[i] = key_out;
   }
 }
 
@@ -283,81 +391,82 @@ void calc_neigh_cpu(int* neigh_split, const int* neigh,
 }
 
 void calc_neigh_cpu(int* neigh, const int depth, const int batch_size) {
-  typedef unsigned int uint32;
+  // the neighbors of the n^th octree are those of the first one offset by
+  // n * node_num, except the empty ones (-1)
+  const vector<int>& full_neigh = Octree::get_full_neigh(depth);
+  const int node_num = 1 << 3 * depth;
+  const int sz = full_neigh.size();
+  memcpy(neigh, full_neigh.data(), sz * sizeof(int));
+  for (int n = 1; n < batch_size; ++n) {
+    const int offset = n * node_num;
+    int* des = neigh + n * sz;
+    for (int i = 0; i < sz; ++i) {
+      const int v = full_neigh[i];
+      des[i] = v + (v < 0 ? 0 : offset);
+    }
+  }
+}
 
-  uint32 node_num = 1 << 3 * depth;
-  const uint32  bound = 1 << depth;
-  for (uint32 n = 0; n < batch_size; ++n) {
-    for (uint32 i = 0; i < node_num; i += 8) {
-      // key to xyz
-      uint32 x0 = 0, y0 = 0, z0 = 0;
-      for (uint32 d = 0; d < depth; d++) {
-        x0 |= (i & (1 << (3 * d + 2))) >> (2 * d + 2);
-        y0 |= (i & (1 << (3 * d + 1))) >> (2 * d + 1);
-        z0 |= (i & (1 << (3 * d + 0))) >> (2 * d + 0);
-      }
+int neigh_depth_closure(const int neigh_mask, const int depth, const int full_layer) {
+  int mask = neigh_mask & ((2 << depth) - 2);  // the depths in [1, depth]
+  for (int d = depth; d > full_layer && d > 1; --d) {
+    if ((mask & (1 << d)) != 0) mask |= 1 << (d - 1);
+  }
+  return mask;
+}
 
-      for (uint32 x = 0; x < 4; ++x) {
-        for (uint32 y = 0; y < 4; ++y) {
-          for (uint32 z = 0; z < 4; ++z) {
-            uint32 x1 = x0 + x - 1;
-            uint32 y1 = y0 + y - 1;
-            uint32 z1 = z0 + z - 1;
-
-            int v = -1;
-            if ((x1 & bound) == 0 &&
-                (y1 & bound) == 0 &&
-                (z1 & bound) == 0) {
-              uint32 key1 = 0;
-              for (int d = 0; d < depth; d++) {
-                uint32 mask = 1u << d;
-                key1 |= ((x1 & mask) << (2 * d + 2)) |
-                    ((y1 & mask) << (2 * d + 1)) |
-                    ((z1 & mask) << (2 * d));
-              }
-              v = key1 + n * node_num;
-            }
-
-            uint32 xyz = (x << 4) | (y << 2) | z;
-            neigh[xyz + i * 8 + n * node_num * 8] = v;
-          }
-        }
-      }
+int update_neigh_cpu(OctreeParser& octree, const int neigh_mask, const int done_mask) {
+  const OctreeInfo& info = octree.info();
+  if (!info.has_property(OctreeInfo::kNeigh)) return done_mask;
+  CHECK(info.has_property(OctreeInfo::kChild));
+
+  const int depth = info.depth(), full_layer = info.full_layer();
+  const int mask = neigh_depth_closure(neigh_mask, depth, full_layer);
+  for (int d = 1; d < depth + 1; ++d) {
+    const int bit = 1 << d;
+    if ((mask & bit) == 0 || (done_mask & bit) != 0) continue;
+    if (d <= full_layer) {
+      calc_neigh_cpu(octree.mutable_neighbor_cpu(d), d, info.batch_size());
+    } else {
+      calc_neigh_cpu(octree.mutable_neighbor_cpu(d), octree.neighbor_cpu(d - 1),
+          octree.children_cpu(d - 1), info.node_num(d - 1));
     }
   }
+  return done_mask | mask;
 }
 
-void calc_neighbor(int* neigh, const unsigned* key, const int node_num,
+template <typename Key>
+void calc_neighbor(int* neigh, const Key* key, const int node_num,
     const int displacement) {
-  typedef unsigned char ubyte;
+  typedef typename KeyTrait<Key>::Coord Coord;
 
   // build hash table
-  vector<std::pair<unsigned, int>> entries(node_num);
+  vector<std::pair<Key, int>> entries(node_num);
   for (int id = 0; id < node_num; ++id) {
     // ignore the root node
     entries[id] = std::make_pair(key[id], id + displacement);
   }
-  std::unordered_map<unsigned, int> hash_table(entries.begin(), entries.end());
+  std::unordered_map<Key, int> hash_table(entries.begin(), entries.end());
 
   // calc neighborhood
   for (int id = 0; id < node_num; id += 8) {
     // the neighborhood volume
     int* ngh = neigh + id * 8;
-    const ubyte* k0 = (const ubyte*)(key + id);
-    // currently the maximize octree depth is 8
-    ubyte k1[4] = { 0, 0, 0, k0[3] };
-    //const ubyte bound = (1 << k0[3]) - 2;
-    for (ubyte x = 0; x < 4; ++x) {
+    const Coord* k0 = (const Coord*)(key + id);
+    // the max octree depth is 8 for the 32-bit keys
+    Coord k1[4] = { 0, 0, 0, k0[3] };
+    //const Coord bound = (1 << k0[3]) - 2;
+    for (Coord x = 0; x < 4; ++x) {
       k1[0] = k0[0] + x - 1;
-      for (ubyte y = 0; y < 4; ++y) {
+      for (Coord y = 0; y < 4; ++y) {
         k1[1] = k0[1] + y - 1;
-        for (ubyte z = 0; z < 4; ++z) {
+        for (Coord z = 0; z < 4; ++z) {
           k1[2] = k0[2] + z - 1;
 
           // find
-          unsigned* k2 = reinterpret_cast<unsigned*>(k1);
+          Key* k2 = reinterpret_cast<Key*>(k1);
           auto rst = hash_table.find(*k2);
-          ubyte i = (x << 4) | (y << 2) | z;
+          Coord i = (x << 4) | (y << 2) | z;
           if (rst != hash_table.end()) {
             ngh[i] = rst->second;
           } else {
@@ -369,28 +478,6 @@ void calc_neighbor(int* neigh, const unsigned* key, const int node_num,
   }
 }
 
-inline void compute_key(unsigned int& key, const unsigned int* pt, const int depth) {
-  key = 0;
-  for (int i = 0; i < depth; i++) {
-    int mask = 1u << i;
-    for (int j = 0; j < 3; j++) {
-      key |= (pt[j] & mask) << (2 * i + 2 - j);
-    }
-  }
-}
-
-inline void compute_pt(unsigned int* pt, const unsigned int& key, const int depth) {
-  for (int i = 0; i < 3; pt[i++] = 0u);
-  for (int i = 0; i < depth; i++) {
-    for (int j = 0; j < 3; j++) {
-      // bit mask
-      int mask = 1u << (3 * i + 2 - j);
-      // put the bit to position i
-      pt[j] |= (key & mask) >> (2 * i + 2 - j);
-    }
-  }
-}
-
 void octree_dropout(vector<char>& octree_output, const string& octree_input,
     const int depth_dropout, const float threshold, const int channel) {
   // parse the octree file
@@ -599,17 +686,26 @@ void aoctree_dropout(vector<char>& octree_output, const string& octree_input,
 
 template<typename Dtype>
 void merge_octrees(Blob<Dtype>& octree_output, const vector<vector<char> >& octree_buffer) {
+  vector<const char*> octrees(octree_buffer.size());
+  for (int i = 0; i < octree_buffer.size(); ++i) {
+    octrees[i] = octree_buffer[i].data();
+  }
+  merge_octrees(octree_output, octrees);
+}
+
+template<typename Dtype>
+void merge_octrees(Blob<Dtype>& octree_output, const vector<const char*>& octrees,
+    const int neigh_mask, const int content_flags) {
   /// parse the input octrees
-  int batch_size = octree_buffer.size();
+  int batch_size = octrees.size();
   vector<OctreeParser> octree_parsers(batch_size);
   for (int i = 0; i < batch_size; ++i) {
-    octree_parsers[i].set_cpu(octree_buffer[i].data());
+    octree_parsers[i].set_cpu(octrees[i]);
   }
 
-  // get depth and full_layer information
+  // get depth information
   string err_msg;
   const int depth = octree_parsers[0].info().depth();
-  const int full_layer = octree_parsers[0].info().full_layer();
   bool valid = octree_parsers[0].info().check_format(err_msg);
   CHECK(valid) << err_msg;
   for (int i = 1; i < batch_size; ++i) {
@@ -678,6 +774,22 @@ void merge_octrees(Blob<Dtype>& octree_output, const vector<vector<char> >& octr
   // add the neighbor property
   const int kNeighChannel = 8;
   info_batch.set_property(OctreeInfo::kNeigh, kNeighChannel, -1);
+  // drop the data properties which are not selected, so that they are not
+  // merged; the fp16 and int8/int16 data of the inputs are dequantized to float
+  const OctreeInfo::PropType data_ptypes[] = {
+    OctreeInfo::kFeature, OctreeInfo::kLabel, OctreeInfo::kSplit };
+  for (auto ptype : data_ptypes) {
+    if ((content_flags & ptype) == 0) info_batch.set_property(ptype, 0, 0);
+    info_batch.set_dtype(ptype, kFloat32);
+  }
+  // widen the keys to 64 bits if the depth or the batch index does not fit
+  // in the 32-bit keys
+  const int key_channel_in = info_batch.channel(OctreeInfo::kKey);
+  if (info_batch.has_property(OctreeInfo::kKey) && key_channel_in == 1 &&
+      octree::key_channel(depth, batch_size) == 2) {
+    info_batch.set_property(OctreeInfo::kKey, 2, -1);
+  }
+  const int key_channel = info_batch.channel(OctreeInfo::kKey);
   // update nodenumber
   info_batch.set_nnum(nnum_batch.data());
   info_batch.set_nempty(nnum_nempty_batch.data());
@@ -694,109 +806,98 @@ void merge_octrees(Blob<Dtype>& octree_output, const vector<vector<char> >& octr
 
 
   /// set data
-  // If the OpenMP is available, the code can be more concise.
-  //omp_set_num_threads(8);
-  //#pragma omp parallel for
-  //for (int i = 0; i < batch_size; ++i) {
-  auto worker = [&](int thread_id, int thread_num) {
-    for (int i = thread_id; i < batch_size; i += thread_num) {
-      // copy key
-      // TODO: optimize! TODO: IF DEPTH > 8
-      // the channel and location of key is 1 and -1 (todo: !!! channel 2 for deeper key)
-      for (int d = 0; d < depth + 1; ++d) {
-        if (!info_batch.has_property(OctreeInfo::kKey)) break;
-        int p = i * (depth + 1) + d;
-        unsigned int* des = octbatch_parser.mutable_key_cpu(d) + nnum_cum_layer[p];
-        const unsigned int* src = octree_parsers[i].key_cpu(d);
-        for (int j = 0; j < nnum[p]; ++j) {
-          des[j] = src[j];
-          // !!! todo: deal with octree depth > 8
-          unsigned char* ptr = reinterpret_cast<unsigned char*>(des + j);
-          ptr[3] = i;
+  // The copying is split into tasks by (octree, depth, property), and the
+  // large ones are split further by the node range, so that the threads of
+  // the pool are balanced even if the sizes of the octrees are skewed; the
+  // large tasks are handed out first.
+  struct MergeTask {
+    int i, d, begin, end;
+    OctreeInfo::PropType ptype;
+    size_t bytes;
+  };
+  const size_t kTaskBytes = 1 << 18;
+  vector<MergeTask> tasks;
+  const OctreeInfo::PropType merged_ptypes[] = { OctreeInfo::kKey,
+    OctreeInfo::kChild, OctreeInfo::kFeature, OctreeInfo::kLabel, OctreeInfo::kSplit };
+  for (auto ptype : merged_ptypes) {
+    if (!info_batch.has_property(ptype)) continue;
+    int depth_start = info_batch.locations(ptype) == depth ? depth : 0;
+    size_t node_bytes = info_batch.channel(ptype) * sizeof(float);
+    if (ptype == OctreeInfo::kKey) node_bytes = key_channel * sizeof(unsigned int);
+    int chunk = std::max<int>(kTaskBytes / node_bytes, 1);
+    for (int i = 0; i < batch_size; ++i) {
+      for (int d = depth_start; d < depth + 1; ++d) {
+        int n = nnum[i * (depth + 1) + d];
+        for (int j = 0; j < n; j += chunk) {
+          int end = std::min(j + chunk, n);
+          MergeTask task = { i, d, j, end, ptype, (end - j) * node_bytes };
+          tasks.push_back(task);
         }
       }
-
-      // copy children
-      // by default, the channel and location of children is 1 and -1,
-      for (int d = 0; d < depth + 1; ++d) {
-        if (!info_batch.has_property(OctreeInfo::kChild)) break;
-        int p = i * (depth + 1) + d;
-        int* des = octbatch_parser.mutable_children_cpu(d) + nnum_cum_layer[p];
-        const int* src = octree_parsers[i].children_cpu(d);
-        for (int j = 0; j < nnum[p]; ++j) {
-          des[j] = -1 == src[j] ? src[j] : src[j] + nnum_cum_nempty_layer[p];
+    }
+  }
+  std::stable_sort(tasks.begin(), tasks.end(),
+      [](const MergeTask& a, const MergeTask& b) { return a.bytes > b.bytes; });
+
+  auto worker = [&](int t) {
+    const MergeTask& task = tasks[t];
+    const int i = task.i, d = task.d, p = i * (depth + 1) + d;
+    const int n = task.end - task.begin;
+    const OctreeParser& parser = octree_parsers[i];
+    const OctreeInfo& info_i = parser.info();
+    switch (task.ptype) {
+      case OctreeInfo::kKey: {
+        // copy key, and set the batch index in the 4th byte of the 32-bit keys
+        // or in the 4th short of the 64-bit keys
+        const int offset = nnum_cum_layer[p] + task.begin;
+        merge_keys_cpu(octbatch_parser.mutable_key_cpu(d) + key_channel * offset,
+            key_channel, parser.key_cpu(d) + key_channel_in * task.begin,
+            key_channel_in, n, i, info_batch.key2xyz());
+        break;
+      }
+      case OctreeInfo::kChild: {
+        // copy children, the empty nodes (-1) are kept
+        // by default, the channel and location of children is 1 and -1,
+        int* des = octbatch_parser.mutable_children_cpu(d) + nnum_cum_layer[p] + task.begin;
+        const int* src = parser.children_cpu(d) + task.begin;
+        const int offset = nnum_cum_nempty_layer[p];
+        for (int j = 0; j < n; ++j) {
+          des[j] = src[j] + (src[j] < 0 ? 0 : offset);
         }
+        break;
       }
-
-      // copy data: !NOTE! the type of signal is float!!!
-      int feature_channel = info_batch.channel(OctreeInfo::kFeature);
-      int feature_location = info_batch.locations(OctreeInfo::kFeature);
-      int depth_start = feature_location == depth ? depth : 0;
-      for (int d = depth_start; d < depth + 1; ++d) {
-        if (!info_batch.has_property(OctreeInfo::kFeature)) break;
-        int p = i * (depth + 1) + d;
-        for (int c = 0; c < feature_channel; c++) {
-          float* des = octbatch_parser.mutable_feature_cpu(d) + c * nnum_batch[d] + nnum_cum_layer[p];
-          const float* src = octree_parsers[i].feature_cpu(d) + c * nnum[p];
-          for (int j = 0; j < nnum[p]; ++j) { des[j] = src[j]; }
+      case OctreeInfo::kFeature: {
+        // copy data: !NOTE! the type of signal is float!!!
+        const int channel = info_batch.channel(OctreeInfo::kFeature);
+        const int elem = info_i.sizeof_element(OctreeInfo::kFeature);
+        for (int c = 0; c < channel; c++) {
+          float* des = octbatch_parser.mutable_feature_cpu(d) + c * nnum_batch[d] +
+              nnum_cum_layer[p] + task.begin;
+          const char* src = parser.ptr_cpu(OctreeInfo::kFeature, d) +
+              (c * nnum[p] + task.begin) * elem;
+          dequantize_cpu(des, src, n, info_i.dtype(OctreeInfo::kFeature),
+              info_i.scale(OctreeInfo::kFeature), info_i.offset(OctreeInfo::kFeature));
         }
+        break;
       }
-
-      // copy label: !NOTE! the type of label is float!!!
-      int label_location = info_batch.locations(OctreeInfo::kLabel);
-      depth_start = label_location == depth ? depth : 0;
-      for (int d = depth_start; d < depth + 1; ++d) {
-        if (!info_batch.has_property(OctreeInfo::kLabel)) break;
-        int p = i * (depth + 1) + d;
-        float* des = octbatch_parser.mutable_label_cpu(d) + nnum_cum_layer[p];
-        const float* src = octree_parsers[i].label_cpu(d);
-        for (int j = 0; j < nnum[p]; ++j) { des[j] = src[j]; }
-      }
-
-      // copy split label: !NOTE! the type of label is float!!!
-      int split_location = info_batch.locations(OctreeInfo::kSplit);
-      depth_start = split_location == depth ? depth : 0;
-      for (int d = depth_start; d < depth + 1; ++d) {
-        if (!info_batch.has_property(OctreeInfo::kSplit)) break;
-        int p = i * (depth + 1) + d;
-        float* des = octbatch_parser.mutable_split_cpu(d) + nnum_cum_layer[p];
-        const float* src = octree_parsers[i].split_cpu(d);
-        for (int j = 0; j < nnum[p]; ++j) des[j] = src[j];
+      default: {
+        // copy label and split label: !NOTE! the type of label is float!!!
+        const OctreeInfo::PropType ptype = task.ptype;
+        float* des = reinterpret_cast<float*>(octbatch_parser.mutable_ptr_cpu(ptype, d)) +
+            nnum_cum_layer[p] + task.begin;
+        const char* src = parser.ptr_cpu(ptype, d) +
+            task.begin * info_i.sizeof_element(ptype);
+        dequantize_cpu(des, src, n, info_i.dtype(ptype), info_i.scale(ptype),
+            info_i.offset(ptype));
+        break;
       }
     }
   };
-
-  int thread_num = 8;
-#ifdef _DEBUG
-  thread_num = 1;   // for debug only
-#endif
-  vector<shared_ptr<boost::thread> > workers(thread_num);
-  for (int id = 1; id < thread_num; ++id) {
-    workers[id].reset(new boost::thread(worker, id, thread_num));
-  }
-  worker(0, thread_num); // for the master thread
-  for (int id = 1; id < thread_num; ++id) {
-    workers[id]->join();
-  }
+  ThreadPool::Global()->Run(tasks.size(), worker);
 
   // ==== v2 ====
   // calc and set neighbor info
-  for (int d = 1; d < depth + 1; ++d) {
-    if (!info_batch.has_property(OctreeInfo::kNeigh)) break;
-    CHECK(info_batch.has_property(OctreeInfo::kChild));
-
-    if (d <= full_layer) {
-      octree::calc_neigh_cpu(
-          octbatch_parser.mutable_neighbor_cpu(d),
-          d, batch_size);
-    } else {
-      octree::calc_neigh_cpu(
-          octbatch_parser.mutable_neighbor_cpu(d),
-          octbatch_parser.neighbor_cpu(d - 1),
-          octbatch_parser.children_cpu(d - 1),
-          octbatch_parser.info().node_num(d - 1));
-    }
-  }
+  update_neigh_cpu(octbatch_parser, neigh_mask);
 }
 
 template<typename Dtype>
@@ -816,8 +917,9 @@ void set_octree_parser(OctreeParser& octree_parser, const Blob<Dtype>& octree_in
   }
 }
 
-void search_key_cpu(int* idx, const int unsigned* key, const int n_key,
-    const unsigned int* query, const int n_query) {
+template <typename Key>
+void search_key_cpu(int* idx, const Key* key, const int n_key,
+    const Key* query, const int n_query) {
   for (int i = 0; i < n_query; ++i) {
     int j = std::lower_bound(key, key + n_key, query[i]) - key;
     idx[i] = (j >= n_key || key[j] != query[i]) ? -1 : j;
@@ -841,6 +943,141 @@ int content_flag(string str) {
   return flag;
 }
 
+void truncate_octree(vector<char>& octree_out, const char* octree_in,
+    const int depth_out) {
+  const OctreeInfo& info = *reinterpret_cast<const OctreeInfo*>(octree_in);
+  const int depth = info.depth();
+  if (depth_out >= depth) {
+    octree_out.assign(octree_in, octree_in + info.sizeof_octree());
+    return;
+  }
+  CHECK_GE(depth_out, info.full_layer()) << "The octree can not be cut above its full layer";
+  CHECK(info.has_property(OctreeInfo::kChild)) << "The children are required";
+
+  // the info of the octree: the node numbers of the kept layers are unchanged,
+  // and the pooled properties are float
+  OctreeInfo info_out = info;
+  info_out.set_depth(depth_out);
+  if (info_out.adaptive_layer() > depth_out) info_out.set_adaptive_layer(depth_out);
+  for (int d = depth_out + 1; d <= depth; ++d) {
+    info_out.set_nnum(d, 0);
+    info_out.set_nempty(d, 0);
+  }
+  info_out.set_nnum_cum();
+  bool pooling = false;
+  for (int i = 0; i < OctreeInfo::kPTypeNum; ++i) {
+    OctreeInfo::PropType ptype = static_cast<OctreeInfo::PropType>(1 << i);
+    if (!info.has_property(ptype) || info.locations(ptype) == -1) continue;
+    CHECK(ptype == OctreeInfo::kFeature || ptype == OctreeInfo::kLabel ||
+        ptype == OctreeInfo::kSplit) << "Can not pool the property " << ptype;
+    // the displacement depends on the average points, which are not stored
+    CHECK(ptype != OctreeInfo::kFeature || !info.has_displace())
+        << "Can not pool the node displacement";
+    info_out.set_property(ptype, info.channel(ptype), depth_out);
+    pooling = true;
+  }
+  info_out.set_ptr_dis();
+  octree_out.assign(info_out.sizeof_octree(), 0);
+  memcpy(octree_out.data(), &info_out, sizeof(OctreeInfo));
+
+  // the ancestor in the layer depth_out of each node in the finest layer,
+  // which is -1 for the empty nodes, traced with the children
+  const int nnum = info.node_num(depth);
+  const int nnum_out = info.node_num(depth_out);
+  const int* children = reinterpret_cast<const int*>(
+      octree_in + info.ptr_dis(OctreeInfo::kChild, 0));
+  vector<int> ancestor, ancestor_next;
+  if (pooling) {
+    ancestor.resize(nnum_out);
+    for (int j = 0; j < nnum_out; ++j) ancestor[j] = j;
+    for (int d = depth_out; d < depth; ++d) {
+      const int* children_d = children + info.node_num_cum(d);
+      ancestor_next.assign(info.node_num(d + 1), -1);
+      for (int j = 0; j < info.node_num(d); ++j) {
+        if (children_d[j] < 0) continue;
+        for (int c = 0; c < 8; ++c) {
+          ancestor_next[children_d[j] * 8 + c] = ancestor[j];
+        }
+      }
+      ancestor.swap(ancestor_next);
+    }
+    const int* children_depth = children + info.node_num_cum(depth);
+    for (int j = 0; j < nnum; ++j) {
+      if (children_depth[j] == -1) ancestor[j] = -1;
+    }
+  }
+
+  for (int i = 0; i < OctreeInfo::kPTypeNum; ++i) {
+    OctreeInfo::PropType ptype = static_cast<OctreeInfo::PropType>(1 << i);
+    if (!info.has_property(ptype)) continue;
+    char* des = octree_out.data() + info_out.ptr_dis(ptype, 0);
+    const char* src = octree_in + info.ptr_dis(ptype, 0);
+    if (info.locations(ptype) == -1) {
+      // the layers [0, depth_out] are contiguous
+      memcpy(des, src, info.ptr_dis(ptype, depth_out + 1) - info.ptr_dis(ptype, 0));
+      continue;
+    }
+
+    const int channel = info.channel(ptype);
+    vector<float> data(nnum * channel);
+    dequantize_cpu(data.data(), src, nnum * channel, info.dtype(ptype),
+        info.scale(ptype), info.offset(ptype));
+    float* fdes = reinterpret_cast<float*>(des);
+    if (ptype == OctreeInfo::kFeature) {
+      vector<float> count(nnum_out, 0);
+      for (int j = 0; j < nnum; ++j) {
+        if (ancestor[j] < 0) continue;
+        count[ancestor[j]] += 1.0f;
+        for (int c = 0; c < channel; ++c) {
+          fdes[c * nnum_out + ancestor[j]] += data[c * nnum + j];
+        }
+      }
+      for (int c = 0; c < channel; ++c) {
+        for (int j = 0; j < nnum_out; ++j) {
+          if (count[j] > 0) fdes[c * nnum_out + j] /= count[j];
+        }
+      }
+      // the first 3 channels are the normals, which are renormalized
+      if (channel >= 3) {
+        for (int j = 0; j < nnum_out; ++j) {
+          float len = 0;
+          for (int c = 0; c < 3; ++c) {
+            float v = fdes[c * nnum_out + j];
+            len += v * v;
+          }
+          if (len == 0) continue;
+          len = sqrtf(len);
+          for (int c = 0; c < 3; ++c) fdes[c * nnum_out + j] /= len;
+        }
+      }
+    } else if (ptype == OctreeInfo::kLabel) {
+      // the most frequent non-negative label, or -1
+      int nlabel = 0;
+      for (float v : data) nlabel = std::max(nlabel, static_cast<int>(v) + 1);
+      vector<int> hist(nnum_out * nlabel, 0);
+      for (int j = 0; j < nnum; ++j) {
+        if (ancestor[j] < 0 || data[j] < 0) continue;
+        hist[ancestor[j] * nlabel + static_cast<int>(data[j])] += 1;
+      }
+      for (int j = 0; j < nnum_out; ++j) {
+        const int* h = hist.data() + j * nlabel;
+        int l = std::max_element(h, h + nlabel) - h;
+        for (int c = 0; c < channel; ++c) {
+          fdes[c * nnum_out + j] = nlabel > 0 && h[l] > 0 ? l : -1.0f;
+        }
+      }
+    } else {
+      // the nodes of depth_out are split if they are not empty
+      const int* children_out = children + info.node_num_cum(depth_out);
+      for (int c = 0; c < channel; ++c) {
+        for (int j = 0; j < nnum_out; ++j) {
+          fdes[c * nnum_out + j] = children_out[j] == -1 ? 0 : 1;
+        }
+      }
+    }
+  }
+}
+
 // Explicit instantiation
 template void pad_forward_cpu<float>(float* Y, const int Hy,
     const int Cy, const float* X, const int Hx, const int* label);
@@ -874,10 +1111,35 @@ template void merge_octrees<float>(Blob<float>& octree_output,
     const vector<vector<char> >& octrees);
 template void merge_octrees<double>(Blob<double>& octree_output,
     const vector<vector<char> >& octrees);
+template void merge_octrees<float>(Blob<float>& octree_output,
+    const vector<const char*>& octrees, const int neigh_mask, const int content_flags);
+template void merge_octrees<double>(Blob<double>& octree_output,
+    const vector<const char*>& octrees, const int neigh_mask, const int content_flags);
 template void set_octree_parser<float>(OctreeParser& octree_parser,
     const Blob<float>& octree_in);
 template void set_octree_parser<double>(OctreeParser& octree_parser,
     const Blob<double>& octree_in);
+template void calc_neighbor<unsigned int>(int* neigh, const unsigned int* key,
+    const int node_num, const int displacement);
+template void calc_neighbor<unsigned long long>(int* neigh,
+    const unsigned long long* key, const int node_num, const int displacement);
+template void generate_key_cpu<unsigned int>(unsigned int* key_split,
+    const unsigned int* key, const int* children, const int node_num);
+template void generate_key_cpu<unsigned long long>(unsigned long long* key_split,
+    const unsigned long long* key, const int* children, const int node_num);
+template void generate_key_cpu<unsigned int>(unsigned int* key,
+    const int depth, const int batch_size);
+template void generate_key_cpu<unsigned long long>(unsigned long long* key,
+    const int depth, const int batch_size);
+template void xyz2key_cpu<unsigned int>(unsigned int* key,
+    const unsigned int* xyz, const int num, const int depth);
+template void xyz2key_cpu<unsigned long long>(unsigned long long* key,
+    const unsigned long long* xyz, const int num, const int depth);
+template void search_key_cpu<unsigned int>(int* idx, const unsigned int* key,
+    const int n_key, const unsigned int* query, const int n_query);
+template void search_key_cpu<unsigned long long>(int* idx,
+    const unsigned long long* key, const int n_key,
+    const unsigned long long* query, const int n_query);
 
 }  // namespace octree
 
@@ -129,17 +129,18 @@ void col2octree_gpu(const Dtype* data_col, Dtype* data_octree,
 
 }
 
-__global__ void gen_key_kernel(unsigned int* key_split, const unsigned int* key,
+template <typename Key>
+__global__ void gen_key_kernel(Key* key_split, const Key* key,
     const int* children, const int thread_num) {
-  typedef unsigned char ubyte;
+  typedef typename KeyTrait<Key>::Coord Coord;
   CUDA_KERNEL_LOOP(id, thread_num) {
     int i = id >> 3;
     int j = id % 8;
 
     int label = children[i];
     if (label != -1) {
-      const ubyte* k0 = (const ubyte*)(key + i);
-      ubyte* k1 = (ubyte*)(key_split + 8 * label + j);
+      const Coord* k0 = (const Coord*)(key + i);
+      Coord* k1 = (Coord*)(key_split + 8 * label + j);
       k1[0] = (k0[0] << 1) | ((j & 4) >> 2);
       k1[1] = (k0[1] << 1) | ((j & 2) >> 1);
       k1[2] = (k0[2] << 1) | (j & 1);
@@ -148,39 +149,44 @@ __global__ void gen_key_kernel(unsigned int* key_split, const unsigned int* key,
   }
 }
 
-__global__ void gen_full_key_kernel(unsigned int* key, const int depth,
+template <typename Key>
+__global__ void gen_full_key_kernel(Key* key, const int depth,
     const int batch_size, const int thread_num) {
+  typedef typename KeyTrait<Key>::Coord Coord;
   CUDA_KERNEL_LOOP(i, thread_num) {
     unsigned node_num = 1 << 3 * depth;
     unsigned k = i % node_num;
-    unsigned xyz = 0;
-    unsigned char* ptr = (unsigned char*)(&xyz);
-#pragma unroll 3
-    for (int d = 0; d < depth; d++) {
-      ptr[0] |= (k & (1 << 3 * d + 2)) >> (2 * d + 2);
-      ptr[1] |= (k & (1 << 3 * d + 1)) >> (2 * d + 1);
-      ptr[2] |= (k & (1 << 3 * d + 0)) >> (2 * d + 0);
-    }
+    unsigned pt[3];
+    morton_decode(k, pt[0], pt[1], pt[2]);
+    Key xyz = 0;
+    Coord* ptr = (Coord*)(&xyz);
+    ptr[0] = pt[0];
+    ptr[1] = pt[1];
+    ptr[2] = pt[2];
     ptr[3] = i / node_num;
     key[i] = xyz;
   }
 }
 
-// NOTE: !!! currently the depth should be less than 8
-__global__ void xyz2key_kernel(unsigned int* key, const unsigned int* xyz,
+template <typename Dtype>
+__global__ void dequantize_kernel(Dtype* des, const void* src, const int num,
+    const DataType dtype, const float scale, const float offset) {
+  CUDA_KERNEL_LOOP(i, num) {
+    des[i] = dequantize_one(src, i, dtype, scale, offset);
+  }
+}
+
+template <typename Key>
+__global__ void xyz2key_kernel(Key* key, const Key* xyz,
     const int num, const int depth) {
+  typedef typename KeyTrait<Key>::Coord Coord;
   CUDA_KERNEL_LOOP(i, num) {
-    unsigned int xyz_in = xyz[i];
-    unsigned int key_out = 0;
-    unsigned char* ptr = (unsigned char*)(&xyz_in);
-    unsigned char* ptr_out = (unsigned char*)(&key_out);
-#pragma unroll 8
-    for (int d = 0; d < depth; ++d) {
-      unsigned char mask = 1 << d;
-      key_out |= (ptr[0] & mask) << (2 * d + 2) |
-          (ptr[1] & mask) << (2 * d + 1) |
-          (ptr[2] & mask) << (2 * d + 0);
-    }
+    Key xyz_in = xyz[i];
+    Coord* ptr = (Coord*)(&xyz_in);
+    const unsigned int pt[3] = { ptr[0], ptr[1], ptr[2] };
+    Key key_out = sizeof(Key) == sizeof(unsigned int) ?
+        morton_encode(pt, depth) : morton_encode64(pt, depth);
+    Coord* ptr_out = (Coord*)(&key_out);
     ptr_out[3] = ptr[3];
     key[i] = key_out;
   }
@@ -224,13 +230,8 @@ __global__ void calc_full_neigh_kernel(int* neigh, const int depth,
     unsigned i = (tm % num) * 8;
     unsigned n = tm / num;
 
-    unsigned x0 = 0, y0 = 0, z0 = 0;
-#pragma unroll 4
-    for (unsigned d = 0; d < depth; d++) {
-      x0 |= (i & (1 << 3 * d + 2)) >> (2 * d + 2);
-      y0 |= (i & (1 << 3 * d + 1)) >> (2 * d + 1);
-      z0 |= (i & (1 << 3 * d + 0)) >> (2 * d + 0);
-    }
+    unsigned x0, y0, z0;
+    morton_decode(i, x0, y0, z0);
 
     unsigned x1 = x0 + x - 1;
     unsigned y1 = y0 + y - 1;
@@ -240,45 +241,41 @@ __global__ void calc_full_neigh_kernel(int* neigh, const int depth,
     if ((x1 & bound) == 0 &&
         (y1 & bound) == 0 &&
         (z1 & bound) == 0) {
-      unsigned key1 = 0;
-#pragma unroll 4
-      for (int d = 0; d < depth; d++) {
-        unsigned mask = 1u << d;
-        key1 |= ((x1 & mask) << (2 * d + 2)) |
-            ((y1 & mask) << (2 * d + 1)) |
-            ((z1 & mask) << (2 * d));
-      }
-      v = key1 + n * node_num;
+      v = morton_encode(x1, y1, z1) + n * node_num;
     }
 
     neigh[id] = v;
   }
 }
 
-__global__ void validate_search_kernel(int* idx, const unsigned* key, const int n_key,
-    const unsigned* query, const int n_query) {
+template <typename Key>
+__global__ void validate_search_kernel(int* idx, const Key* key, const int n_key,
+    const Key* query, const int n_query) {
   CUDA_KERNEL_LOOP(i, n_query) {
     int j = idx[i];
     if (j >= n_key || key[j] != query[i]) idx[i] = -1;
   }
 }
 
-void generate_key_gpu(unsigned int* key_split, const unsigned int* key,
+template <typename Key>
+void generate_key_gpu(Key* key_split, const Key* key,
     const int* children, const int node_num) {
   // use the information from parent layer to calculate the neigh_split of current layer
   int n = node_num << 3; // node_num: the node number of parent layer
-  gen_key_kernel <<< CAFFE_GET_BLOCKS(n), CAFFE_CUDA_NUM_THREADS >>> (
+  gen_key_kernel<Key> <<< CAFFE_GET_BLOCKS(n), CAFFE_CUDA_NUM_THREADS >>> (
       key_split, key, children, n);
 }
 
-void generate_key_gpu(unsigned int* key, const int depth, const int batch_size) {
+template <typename Key>
+void generate_key_gpu(Key* key, const int depth, const int batch_size) {
   int thread_num = batch_size * (1 << 3 * depth);
-  gen_full_key_kernel <<< CAFFE_GET_BLOCKS(thread_num), CAFFE_CUDA_NUM_THREADS >>> (
+  gen_full_key_kernel<Key> <<< CAFFE_GET_BLOCKS(thread_num), CAFFE_CUDA_NUM_THREADS >>> (
       key, depth, batch_size, thread_num);
 }
 
-void xyz2key_gpu(unsigned int* key, const unsigned int* xyz, const int num, const int depth) {
-  xyz2key_kernel <<< CAFFE_GET_BLOCKS(num), CAFFE_CUDA_NUM_THREADS >>> (
+template <typename Key>
+void xyz2key_gpu(Key* key, const Key* xyz, const int num, const int depth) {
+  xyz2key_kernel<Key> <<< CAFFE_GET_BLOCKS(num), CAFFE_CUDA_NUM_THREADS >>> (
       key, xyz, num, depth);
 }
 
@@ -313,10 +310,18 @@ void calc_neigh_gpu(int* neigh, const int depth, const int batch_size) {
       neigh, depth, batch_size, thread_num);
 }
 
-void search_key_gpu(int* idx, const int unsigned* key, const int n_key,
-    const unsigned int* query, const int n_query) {
+template <typename Dtype>
+void dequantize_gpu(Dtype* des, const void* src, const int num,
+    const DataType dtype, const float scale, const float offset) {
+  dequantize_kernel<Dtype> <<< CAFFE_GET_BLOCKS(num), CAFFE_CUDA_NUM_THREADS >>> (
+      des, src, num, dtype, scale, offset);
+}
+
+template <typename Key>
+void search_key_gpu(int* idx, const Key* key, const int n_key,
+    const Key* query, const int n_query) {
   thrust::lower_bound(thrust::device, key, key + n_key, query, query + n_query, idx);
-  validate_search_kernel <<< CAFFE_GET_BLOCKS(n_query), CAFFE_CUDA_NUM_THREADS >>> (
+  validate_search_kernel<Key> <<< CAFFE_GET_BLOCKS(n_query), CAFFE_CUDA_NUM_THREADS >>> (
       idx, key, n_key, query, n_query);
 }
 
@@ -349,6 +354,27 @@ template void generate_label_gpu<float>(int* label_data, int& top_h,
     const float* bottom_data, const int bottom_h, const int mask);
 template void generate_label_gpu<double>(int* label_data, int& top_h,
     const double* bottom_data, const int bottom_h, const int mask);
+template void generate_key_gpu<unsigned int>(unsigned int* key_split,
+    const unsigned int* key, const int* children, const int node_num);
+template void generate_key_gpu<unsigned long long>(unsigned long long* key_split,
+    const unsigned long long* key, const int* children, const int node_num);
+template void generate_key_gpu<unsigned int>(unsigned int* key,
+    const int depth, const int batch_size);
+template void generate_key_gpu<unsigned long long>(unsigned long long* key,
+    const int depth, const int batch_size);
+template void xyz2key_gpu<unsigned int>(unsigned int* key,
+    const unsigned int* xyz, const int num, const int depth);
+template void xyz2key_gpu<unsigned long long>(unsigned long long* key,
+    const unsigned long long* xyz, const int num, const int depth);
+template void dequantize_gpu<float>(float* des, const void* src,
+    const int num, const DataType dtype, const float scale, const float offset);
+template void dequantize_gpu<double>(double* des, const void* src,
+    const int num, const DataType dtype, const float scale, const float offset);
+template void search_key_gpu<unsigned int>(int* idx, const unsigned int* key,
+    const int n_key, const unsigned int* query, const int n_query);
+template void search_key_gpu<unsigned long long>(int* idx,
+    const unsigned long long* key, const int n_key,
+    const unsigned long long* query, const int n_query);
 
 } // namespace octree
 } // namespace caffe
\ No newline at end of file
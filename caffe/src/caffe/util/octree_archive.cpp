@@ -0,0 +1,65 @@
+#include "caffe/util/octree_archive.hpp"
+
+#include <cstring>
+
+namespace caffe {
+namespace octree {
+
+// keep in sync with ocnn/octree/src/octree/octree_archive.cpp
+const char kArchiveMagicStr[16] = "_OCTREE_PK_1.0_";
+
+bool OctreeArchive::open(const string& filename) {
+  close();
+  infile_.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!infile_) return false;
+  infile_.seekg(0, infile_.end);
+  const uint64_t len = infile_.tellg();
+  infile_.seekg(0, infile_.beg);
+
+  ArchiveHeader header;
+  infile_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  const uint64_t index_sz = uint64_t(header.num) * sizeof(ArchiveEntry);
+  if (!infile_ || len < sizeof(header) || header.num < 0 ||
+      memcmp(header.magic, kArchiveMagicStr, sizeof(kArchiveMagicStr)) != 0 ||
+      header.index_offset < sizeof(header) ||
+      header.index_offset + index_sz > len) {
+    close();
+    return false;
+  }
+
+  entries_.resize(header.num);
+  names_.resize(len - header.index_offset - index_sz);
+  infile_.seekg(header.index_offset);
+  infile_.read(reinterpret_cast<char*>(entries_.data()), index_sz);
+  infile_.read(&names_[0], names_.size());
+  bool succ = !infile_.fail();
+  for (int i = 0; i < entries_.size() && succ; ++i) {
+    const ArchiveEntry& e = entries_[i];
+    succ = e.offset + e.size <= header.index_offset && e.name_pos >= 0 &&
+        e.name_len >= 0 && uint64_t(e.name_pos) + e.name_len <= names_.size();
+  }
+  if (!succ) close();
+  return succ;
+}
+
+void OctreeArchive::close() {
+  if (infile_.is_open()) infile_.close();
+  infile_.clear();
+  entries_.clear();
+  names_.clear();
+}
+
+string OctreeArchive::name(const int i) const {
+  return names_.substr(entries_[i].name_pos, entries_[i].name_len);
+}
+
+bool OctreeArchive::read(const int i, string& data) {
+  if (i < 0 || i >= size()) return false;
+  data.resize(entries_[i].size);
+  infile_.seekg(entries_[i].offset);
+  infile_.read(&data[0], data.size());
+  return !infile_.fail();
+}
+
+}  // namespace octree
+}  // namespace caffe
@@ -0,0 +1,292 @@
+#include "caffe/util/octree_codec.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "caffe/util/morton.hpp"
+#include "caffe/util/octree_info.hpp"
+
+namespace caffe {
+namespace octree {
+
+// keep in sync with ocnn/octree/src/octree/octree_codec.cpp
+const char kCompactMagicStr[16] = "_OCTREE_CZ_1.0_";
+
+typedef unsigned long long uint64;
+
+namespace {
+
+// An adaptive binary range coder in the style of LZMA: each probability is
+// the 11-bit estimate of the bit being 0, and it is updated after each bit.
+const int kProbBits = 11;
+const int kProbMove = 5;
+const uint32_t kProbInit = 1u << (kProbBits - 1);
+const uint32_t kRangeTop = 1u << 24;
+
+// the model of a byte, which is coded as 8 bits in a binary tree
+struct ByteModel {
+  uint16_t probs[256];
+  ByteModel() {
+    for (int i = 0; i < 256; ++i) probs[i] = kProbInit;
+  }
+};
+
+class RangeDecoder {
+ public:
+  RangeDecoder(const char* data, const char* end)
+    : ptr_(reinterpret_cast<const uint8_t*>(data)),
+      end_(reinterpret_cast<const uint8_t*>(end)),
+      range_(0xFFFFFFFFu), code_(0), overrun_(false) {
+    for (int i = 0; i < 5; ++i) code_ = (code_ << 8) | next_byte();
+  }
+
+  // the input is corrupted if more bytes than available are consumed
+  bool overrun() const { return overrun_; }
+
+  int decode_bit(uint16_t& prob) {
+    uint32_t bound = (range_ >> kProbBits) * prob;
+    int bit = 0;
+    if (code_ < bound) {
+      range_ = bound;
+      prob += ((1u << kProbBits) - prob) >> kProbMove;
+    } else {
+      code_ -= bound;
+      range_ -= bound;
+      prob -= prob >> kProbMove;
+      bit = 1;
+    }
+    while (range_ < kRangeTop) {
+      range_ <<= 8;
+      code_ = (code_ << 8) | next_byte();
+    }
+    return bit;
+  }
+
+  uint32_t decode_direct(const int nbits) {
+    uint32_t val = 0;
+    for (int i = 0; i < nbits; ++i) {
+      range_ >>= 1;
+      uint32_t bit = code_ >= range_ ? 1u : 0u;
+      if (bit) code_ -= range_;
+      val = (val << 1) | bit;
+      while (range_ < kRangeTop) {
+        range_ <<= 8;
+        code_ = (code_ << 8) | next_byte();
+      }
+    }
+    return val;
+  }
+
+  uint32_t decode_byte(ByteModel& model) {
+    uint32_t m = 1;
+    for (int i = 0; i < 8; ++i) {
+      m = (m << 1) | decode_bit(model.probs[m]);
+    }
+    return m - 256;
+  }
+
+ protected:
+  uint32_t next_byte() {
+    if (ptr_ == end_) {
+      overrun_ = true;
+      return 0;
+    }
+    return *ptr_++;
+  }
+
+ protected:
+  const uint8_t* ptr_;
+  const uint8_t* end_;
+  uint32_t range_;
+  uint32_t code_;
+  bool overrun_;
+};
+
+// the size of the header before the coded stream
+const size_t kHeaderSize = sizeof(kCompactMagicStr) + sizeof(int) + sizeof(OctreeInfo);
+
+// whether the property is stored at the depth
+bool has_property_at(const OctreeInfo& info, OctreeInfo::PropType ptype, int d) {
+  if (!info.has_property(ptype)) return false;
+  int location = info.locations(ptype);
+  return location == -1 || location == d;
+}
+
+// write the key in the serialized layout, refer to Octree::serialize()
+void write_key(char* des, const uint64 key, const int depth, const bool key2xyz,
+    const int channel) {
+  if (!key2xyz) {
+    if (channel == 1) {
+      uint32_t k = static_cast<uint32_t>(key);
+      memcpy(des, &k, sizeof(k));
+    } else {
+      memcpy(des, &key, sizeof(key));
+    }
+    return;
+  }
+
+  uint32_t pt[3];
+  if (depth <= kMortonDepth32) {
+    morton_decode(pt, static_cast<uint32_t>(key), depth);
+  } else {
+    morton_decode64(pt, key, depth);
+  }
+  if (channel == 1) {
+    unsigned char xyz[4] = { 0 };
+    for (int c = 0; c < 3; ++c) xyz[c] = static_cast<unsigned char>(pt[c]);
+    memcpy(des, xyz, sizeof(xyz));
+  } else {
+    unsigned short xyz[4] = { 0 };
+    for (int c = 0; c < 3; ++c) xyz[c] = static_cast<unsigned short>(pt[c]);
+    memcpy(des, xyz, sizeof(xyz));
+  }
+}
+
+// decode num elements of esz bytes, with one model per byte of the element
+void decode_words(RangeDecoder& rc, ByteModel* models, char* data,
+    const int num, const int esz) {
+  for (int i = 0; i < num; ++i) {
+    for (int k = 0; k < esz; ++k) {
+      data[esz * i + k] = static_cast<char>(rc.decode_byte(models[k]));
+    }
+  }
+}
+
+float bits_float(const uint32_t bits) {
+  float val;
+  memcpy(&val, &bits, sizeof(val));
+  return val;
+}
+
+}  // namespace
+
+bool is_compact_octree(const char* data, const size_t sz) {
+  return sz >= sizeof(kCompactMagicStr) &&
+      memcmp(data, kCompactMagicStr, sizeof(kCompactMagicStr)) == 0;
+}
+
+bool read_octree_info(OctreeInfo& info, const char* data, const size_t sz) {
+  if (is_compact_octree(data, sz)) {
+    if (sz < kHeaderSize) return false;
+    data += sizeof(kCompactMagicStr) + sizeof(int);
+  } else if (sz < sizeof(OctreeInfo)) {
+    return false;
+  }
+  memcpy(&info, data, sizeof(OctreeInfo));
+  return true;
+}
+
+bool decompress_octree(vector<char>& buffer, const char* data, const size_t sz) {
+  if (sz < kHeaderSize || !is_compact_octree(data, sz)) return false;
+  int quant_bits = 0;
+  memcpy(&quant_bits, data + sizeof(kCompactMagicStr), sizeof(int));
+  if (quant_bits != 0 && quant_bits != 8 && quant_bits != 16) return false;
+  OctreeInfo info;
+  memcpy(&info, data + sizeof(kCompactMagicStr) + sizeof(int), sizeof(OctreeInfo));
+
+  // validate the header before allocating the buffer
+  string msg;
+  if (!info.check_format(msg)) return false;
+  if (info.locations(OctreeInfo::kChild) != -1) return false;
+  const int depth = info.depth();
+  if (info.node_num_cum(0) != 0) return false;
+  for (int d = 0; d <= depth; ++d) {
+    if (info.node_num(d) < 0 ||
+        info.node_num_cum(d + 1) != info.node_num_cum(d) + info.node_num(d)) {
+      return false;
+    }
+  }
+  if (info.total_nnum_capacity() < info.total_nnum()) return false;
+  info.set_ptr_dis();
+
+  buffer.assign(info.sizeof_octree(), 0);
+  memcpy(buffer.data(), &info, sizeof(OctreeInfo));
+  char* base = buffer.data();
+  RangeDecoder rc(data + kHeaderSize, data + sz);
+
+  // the structure
+  const bool key2xyz = info.key2xyz();
+  const int key_channel = info.channel(OctreeInfo::kKey);
+  const int key_stride = key_channel * sizeof(uint32_t);
+  vector<uint64> parent_keys, keys;
+  vector<ByteModel> occupancy(depth + 1);
+  for (int d = 0; d <= depth; ++d) {
+    const int nnum = info.node_num(d);
+    if (d > 0 && nnum != 8 * static_cast<int>(parent_keys.size())) return false;
+    int* child = reinterpret_cast<int*>(base + info.ptr_dis(OctreeInfo::kChild, d));
+    char* key = has_property_at(info, OctreeInfo::kKey, d) ?
+        base + info.ptr_dis(OctreeInfo::kKey, d) : nullptr;
+
+    keys.clear();
+    for (int i = 0; i < nnum; i += 8) {
+      uint32_t mask = rc.decode_byte(occupancy[d]);
+      for (int j = 0; j < 8 && i + j < nnum; ++j) {
+        uint64 k = d == 0 ? i + j : (parent_keys[i >> 3] << 3) | j;
+        if (key != nullptr) {
+          write_key(key + (i + j) * key_stride, k, d, key2xyz, key_channel);
+        }
+        if ((mask >> j) & 1u) {
+          child[i + j] = keys.size();
+          keys.push_back(k);
+        } else {
+          child[i + j] = -1;
+        }
+      }
+    }
+    if (rc.overrun() || static_cast<int>(keys.size()) != info.node_num_nempty(d)) return false;
+    parent_keys.swap(keys);
+  }
+
+  // the other properties
+  const OctreeInfo::PropType ptypes[] = {
+    OctreeInfo::kNeigh, OctreeInfo::kLabel, OctreeInfo::kSplit, OctreeInfo::kFeature };
+  for (auto ptype : ptypes) {
+    if (!info.has_property(ptype)) continue;
+    const int channel = info.channel(ptype);
+    const int esz = info.sizeof_element(ptype);
+    const bool is_float = info.dtype(ptype) == kFloat32;
+    ByteModel models[4];
+    vector<ByteModel> quant_models(2 * channel);
+    for (int d = 0; d <= depth; ++d) {
+      if (!has_property_at(info, ptype, d)) continue;
+      const int nnum = info.node_num(d);
+      char* des = base + info.ptr_dis(ptype, d);
+      float* fdes = reinterpret_cast<float*>(des);
+
+      if (is_float && (ptype == OctreeInfo::kLabel || ptype == OctreeInfo::kSplit)) {
+        int num = nnum * channel;
+        if (rc.decode_direct(1) != 0) {
+          for (int i = 0; i < num; ++i) {
+            fdes[i] = static_cast<float>(rc.decode_byte(models[0])) - 1.0f;
+          }
+        } else {
+          decode_words(rc, models, des, num, esz);
+        }
+      } else if (is_float && ptype == OctreeInfo::kFeature && quant_bits != 0) {
+        for (int c = 0; c < channel; ++c) {
+          float* fc = fdes + c * nnum;
+          float scale = bits_float(rc.decode_direct(32));
+          if (scale == 0) continue;
+
+          for (int i = 0; i < nnum; ++i) {
+            uint32_t z = 0;
+            if (quant_bits == 16) z = rc.decode_byte(quant_models[2 * c + 1]) << 8;
+            z |= rc.decode_byte(quant_models[2 * c]);
+            int q = static_cast<int>(z >> 1);
+            if (z & 1u) q = -q - 1;  // zigzag
+            fc[i] = q * scale;
+          }
+        }
+      } else {
+        decode_words(rc, models, des, nnum * channel, esz);
+      }
+      if (rc.overrun()) return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace octree
+}  // namespace caffe
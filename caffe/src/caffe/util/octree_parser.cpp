@@ -1,6 +1,7 @@
 #include "caffe/util/octree_parser.hpp"
 
 #include "caffe/common.hpp"
+#include "caffe/util/morton.hpp"
 
 namespace caffe {
 
@@ -66,28 +67,11 @@ OctreeParser::NodeType OctreeParser::node_type(const int t) const {
 }
 
 void OctreeParser::compute_key(uint32& key, const uint32* pt, const int depth) {
-  key = 0;
-  for (int i = 0; i < depth; i++) {
-    uint32 mask = 1u << i;
-    for (int j = 0; j < 3; j++) {
-      key |= (pt[j] & mask) << (2 * i + 2 - j);
-    }
-  }
+  key = octree::morton_encode(pt, depth);
 }
 
 void OctreeParser::compute_pt(uint32* pt, const uint32& key, const int depth) {
-  // init
-  for (int i = 0; i < 3; pt[i++] = 0u);
-
-  // convert
-  for (int i = 0; i < depth; i++) {
-    for (int j = 0; j < 3; j++) {
-      // bit mask
-      uint32 mask = 1u << (3 * i + 2 - j);
-      // put the bit to position i
-      pt[j] |= (key & mask) >> (2 * i + 2 - j);
-    }
-  }
+  octree::morton_decode(pt, key, depth);
 }
 
 const char* OctreeParser::ptr_cpu(const PropType ptype, const int depth) const {
@@ -104,6 +88,10 @@ const unsigned int* OctreeParser::key_cpu(const int depth) const {
   return reinterpret_cast<const unsigned int*>(ptr_cpu(OctreeInfo::kKey, depth));
 }
 
+const OctreeParser::uint64* OctreeParser::key64_cpu(const int depth) const {
+  return reinterpret_cast<const uint64*>(ptr_cpu(OctreeInfo::kKey, depth));
+}
+
 const int* OctreeParser::children_cpu(const int depth) const {
   return reinterpret_cast<const int*>(ptr_cpu(OctreeInfo::kChild, depth));
 }
@@ -133,6 +121,10 @@ unsigned int* OctreeParser::mutable_key_cpu(const int depth) {
   return reinterpret_cast<unsigned int*>(mutable_ptr_cpu(OctreeInfo::kKey, depth));
 }
 
+OctreeParser::uint64* OctreeParser::mutable_key64_cpu(const int depth) {
+  return reinterpret_cast<uint64*>(mutable_ptr_cpu(OctreeInfo::kKey, depth));
+}
+
 int* OctreeParser::mutable_children_cpu(const int depth) {
   return reinterpret_cast<int*>(mutable_ptr_cpu(OctreeInfo::kChild, depth));
 }
@@ -167,6 +159,10 @@ const unsigned int* OctreeParser::key_gpu(const int depth) const {
   return reinterpret_cast<const unsigned int*>(ptr_gpu(OctreeInfo::kKey, depth));
 }
 
+const OctreeParser::uint64* OctreeParser::key64_gpu(const int depth) const {
+  return reinterpret_cast<const uint64*>(ptr_gpu(OctreeInfo::kKey, depth));
+}
+
 const int* OctreeParser::children_gpu(const int depth) const {
   return reinterpret_cast<const int*>(ptr_gpu(OctreeInfo::kChild, depth));
 }
@@ -196,6 +192,10 @@ unsigned int* OctreeParser::mutable_key_gpu(const int depth) {
   return reinterpret_cast<unsigned int*>(mutable_ptr_gpu(OctreeInfo::kKey, depth));
 }
 
+OctreeParser::uint64* OctreeParser::mutable_key64_gpu(const int depth) {
+  return reinterpret_cast<uint64*>(mutable_ptr_gpu(OctreeInfo::kKey, depth));
+}
+
 int* OctreeParser::mutable_children_gpu(const int depth) {
   return reinterpret_cast<int*>(mutable_ptr_gpu(OctreeInfo::kChild, depth));
 }
@@ -0,0 +1,39 @@
+#include "caffe/util/octree_record.hpp"
+
+#include <cstring>
+
+namespace caffe {
+namespace octree {
+
+const char kRecordMagicStr[8] = "_OCT_RW";
+
+void pack_octree_record(string& record, const char* octree, const int size,
+    const int label) {
+  RecordHeader header;
+  memcpy(header.magic, kRecordMagicStr, sizeof(kRecordMagicStr));
+  header.label = label;
+  header.size = size;
+  record.resize(sizeof(RecordHeader) + size);
+  memcpy(&record[0], &header, sizeof(RecordHeader));
+  memcpy(&record[sizeof(RecordHeader)], octree, size);
+}
+
+bool parse_octree_record(const char* record, const size_t record_size,
+    const char** octree, int* size, int* label) {
+  if (record_size < sizeof(RecordHeader) ||
+      memcmp(record, kRecordMagicStr, sizeof(kRecordMagicStr)) != 0) {
+    return false;
+  }
+  RecordHeader header;
+  memcpy(&header, record, sizeof(RecordHeader));
+  if (header.size < 0 || header.size > record_size - sizeof(RecordHeader)) {
+    return false;
+  }
+  *octree = record + sizeof(RecordHeader);
+  *size = header.size;
+  *label = header.label;
+  return true;
+}
+
+}  // namespace octree
+}  // namespace caffe
@@ -0,0 +1,105 @@
+#include "caffe/util/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace caffe {
+
+ThreadPool::ThreadPool(int thread_num) : stop_(false) {
+  if (thread_num <= 0) {
+    thread_num = std::max<int>(boost::thread::hardware_concurrency(), 1);
+  }
+#ifdef _DEBUG
+  thread_num = 1;   // for debug only
+#endif
+  for (int i = 1; i < thread_num; ++i) {
+    workers_.push_back(std::make_shared<boost::thread>(&ThreadPool::WorkerLoop, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  cv_start_.notify_all();
+  for (int i = 0; i < workers_.size(); ++i) workers_[i]->join();
+}
+
+void ThreadPool::Run(const int task_num, const std::function<void(int)>& fn) {
+  if (workers_.empty() || task_num <= 1) {
+    for (int t = 0; t < task_num; ++t) fn(t);
+    return;
+  }
+
+  // the caller, e.g. a prefetching thread, must not leave while the workers
+  // still run fn
+  boost::this_thread::disable_interruption no_interruption;
+  std::shared_ptr<Job> job = std::make_shared<Job>(task_num, fn);
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    jobs_.push_back(job);
+  }
+  cv_start_.notify_all();
+  DoTasks(*job);
+
+  boost::mutex::scoped_lock lock(mutex_);
+  RemoveJob(job);
+  while (job->active > 0) cv_done_.wait(lock);
+}
+
+void ThreadPool::DoTasks(Job& job) {
+  while (true) {
+    int t = job.next_task.fetch_add(1);
+    if (t >= job.task_num) break;
+    job.fn(t);
+  }
+}
+
+void ThreadPool::RemoveJob(const std::shared_ptr<Job>& job) {
+  std::list<std::shared_ptr<Job> >::iterator it =
+      std::find(jobs_.begin(), jobs_.end(), job);
+  if (it != jobs_.end()) jobs_.erase(it);
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::shared_ptr<Job> job;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!stop_ && jobs_.empty()) cv_start_.wait(lock);
+      if (stop_) return;
+      job = jobs_.front();
+      job->active++;
+    }
+    DoTasks(*job);
+    {
+      // all the tasks of the job are taken, so no other worker joins it
+      boost::mutex::scoped_lock lock(mutex_);
+      RemoveJob(job);
+      if (--job->active == 0) cv_done_.notify_all();
+    }
+  }
+}
+
+namespace {
+boost::mutex global_mutex_;
+std::shared_ptr<ThreadPool> global_pool_;
+}  // namespace
+
+std::shared_ptr<ThreadPool> ThreadPool::Global() {
+  boost::mutex::scoped_lock lock(global_mutex_);
+  if (!global_pool_) {
+    global_pool_ = std::make_shared<ThreadPool>(
+        std::min<int>(std::max<int>(boost::thread::hardware_concurrency(), 1), 8));
+  }
+  return global_pool_;
+}
+
+void ThreadPool::SetGlobalThreadNum(const int thread_num) {
+  boost::mutex::scoped_lock lock(global_mutex_);
+  if (global_pool_ && global_pool_->thread_num() == thread_num) return;
+  // the callers of the previous pool keep it alive until they are done
+  global_pool_ = std::make_shared<ThreadPool>(thread_num);
+}
+
+}  // namespace caffe
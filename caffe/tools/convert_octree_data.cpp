@@ -3,10 +3,16 @@
 // by caffe to perform classification.
 
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "boost/scoped_ptr.hpp"
+#include "boost/thread.hpp"
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "google/protobuf/text_format.h"
@@ -15,7 +21,10 @@
 #include "caffe/proto/caffe.pb.h"
 #include "caffe/util/db.hpp"
 #include "caffe/util/format.hpp"
+#include "caffe/util/octree_archive.hpp"
+#include "caffe/util/octree_record.hpp"
 #include "caffe/util/rng.hpp"					// shuffle
+#include "caffe/util/thread_pool.hpp"
 
 using caffe::Datum;
 using boost::scoped_ptr;
@@ -29,23 +38,120 @@ DEFINE_bool(remove, false,
     "Remove the original octree when generating lmdb");
 DEFINE_string(backend, "lmdb",
     "The backend {lmdb, leveldb} for storing the result");
+DEFINE_bool(raw, false,
+    "Store the raw octree records instead of the Datum protobuf");
+DEFINE_int32(threads, 4,
+    "The number of threads reading the octrees");
+DEFINE_int32(queue_size, 64,
+    "The maximum number of octrees read but not yet written");
+DEFINE_int32(commit_num, 1000,
+    "Commit the transaction after this number of records");
+DEFINE_int32(commit_mb, 256,
+    "Commit the transaction after this size of records in MB");
 
-void ReadOctreeToDatum(const string& filename, const int label, Datum* datum) {
+void ReadOctree(const string& filename, string* buffer) {
   size_t size;
   std::ifstream file(filename.c_str(),
       std::ios::in | std::ios::binary | std::ios::ate);
   CHECK(file) << "Unable to open train file #" << filename;
   size = file.tellg();
-  std::string buffer(size, ' ');
+  buffer->resize(size);
   file.seekg(0, std::ios::beg);
-  file.read(&buffer[0], size);
+  file.read(&(*buffer)[0], size);
   file.close();
+}
+
+// serialize the octree into a raw record or a datum according to FLAGS_raw
+void SerializeOctree(const string& buffer, const int label, Datum* datum,
+    string* out) {
+  if (FLAGS_raw) {
+    caffe::octree::pack_octree_record(*out, buffer.data(), buffer.size(), label);
+    return;
+  }
   datum->set_label(label);
   datum->set_data(buffer);
-  datum->set_channels(size);
+  datum->set_channels(buffer.size());
   datum->set_height(1);
   datum->set_width(1);
-  // std::cout << "Size:\t" << size << std::endl;
+  CHECK(datum->SerializeToString(out));
+}
+
+// Serialize the id^th record into key and value, thread_id is in [0, FLAGS_threads)
+typedef std::function<void(int thread_id, int id, string* key, string* value)>
+    RecordReader;
+
+// The records are read and serialized in batches by a caffe::ThreadPool, and
+// the next batch is read while the calling thread writes the current one to
+// the db in the order of the ids, so the db only depends on the order of the
+// ids. Two batches of FLAGS_queue_size / 2 records are kept in memory, and
+// the transaction is committed by the number and the size of the records.
+void write_records(const string& db_name, const int num,
+    const RecordReader& reader) {
+  const int thread_num = std::max(FLAGS_threads, 1);
+  const int batch_size = std::max(FLAGS_queue_size / 2, thread_num);
+  const size_t commit_bytes = size_t(std::max(FLAGS_commit_mb, 1)) << 20;
+  const int commit_num = std::max(FLAGS_commit_num, 1);
+
+  // each task of the pool is one reading thread, which takes the records of
+  // the batch one by one, so that the thread_id is unique within the batch
+  caffe::ThreadPool pool(thread_num);
+  auto read_batch = [&](const int start, std::vector<string>* keys,
+      std::vector<string>* values) {
+    const int n = std::min(batch_size, num - start);
+    keys->resize(n);
+    values->resize(n);
+    std::atomic<int> next(0);
+    pool.Run(thread_num, [&](int thread_id) {
+      for (int i = next++; i < n; i = next++) {
+        reader(thread_id, start + i, &(*keys)[i], &(*values)[i]);
+      }
+    });
+  };
+
+  // Create new DB
+  LOG(INFO) << "Writing data to DB with " << thread_num << " threads";
+  scoped_ptr<db::DB> db(db::GetDB(FLAGS_backend));
+  db->Open(db_name, db::NEW);
+  scoped_ptr<db::Transaction> txn(db->NewTransaction());
+
+  auto start_time = std::chrono::steady_clock::now();
+  size_t total_bytes = 0, txn_bytes = 0;
+  int txn_num = 0;
+  std::vector<string> keys[2], values[2];
+  if (num > 0) read_batch(0, &keys[0], &values[0]);
+  for (int start = 0, cur = 0; start < num; start += batch_size, cur = 1 - cur) {
+    boost::thread next_batch;
+    if (start + batch_size < num) {
+      next_batch = boost::thread(read_batch, start + batch_size,
+          &keys[1 - cur], &values[1 - cur]);
+    }
+
+    const int n = keys[cur].size();
+    for (int i = 0; i < n; ++i) {
+      const int id = start + i;
+      txn->Put(keys[cur][i], values[cur][i]);
+      txn_bytes += values[cur][i].size();
+      txn_num++;
+
+      if (txn_num >= commit_num || txn_bytes >= commit_bytes || id + 1 == num) {
+        // Commit db
+        txn->Commit();
+        txn.reset(db->NewTransaction());
+        total_bytes += txn_bytes;
+        txn_bytes = 0;
+        txn_num = 0;
+
+        double sec = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time).count();
+        double mb = total_bytes / 1048576.0;
+        sec = std::max(sec, 1.0e-6);
+        LOG(INFO) << "Processed " << id + 1 << " files, " << mb << " MB, "
+            << (id + 1) / sec << " files/s, " << mb / sec << " MB/s.";
+      }
+    }
+
+    if (next_batch.joinable()) next_batch.join();
+  }
 }
 
 void convert_dataset(const string& root_folder, const string& list_file,
@@ -82,40 +188,49 @@ void convert_dataset(const string& root_folder, const string& list_file,
   }
   LOG(INFO) << "A total of " << lines.size() << " octree files.";
 
-  // Create new DB
-  LOG(INFO) << "Writing data to DB";
-  scoped_ptr<db::DB> db(db::GetDB(FLAGS_backend));
-  db->Open(db_name, db::NEW);
-  scoped_ptr<db::Transaction> txn(db->NewTransaction());
-
-  // Data buffer
-  Datum datum;
-  int count = 0;
-
-  for (int line_id = 0; line_id < lines.size(); ++line_id) {
+  write_records(db_name, lines.size(),
+      [&](int thread_id, int line_id, string* key_str, string* out) {
+    string buffer;
     string filename = root_folder + lines[line_id].first;
-    ReadOctreeToDatum(filename, lines[line_id].second, &datum);
+    ReadOctree(filename, &buffer);
 
     // delete the file to save disk space
     if (FLAGS_remove) remove(filename.c_str());
 
-    string key_str = caffe::format_int(line_id, 8) + "_" + lines[line_id].first;
-    string out;
-    CHECK(datum.SerializeToString(&out));
-    txn->Put(key_str, out);
+    *key_str = caffe::format_int(line_id, 8) + "_" + lines[line_id].first;
+    Datum datum;
+    SerializeOctree(buffer, lines[line_id].second, &datum, out);
+  });
+}
 
-    if (++count % 1000 == 0) {
-      // Commit db
-      txn->Commit();
-      txn.reset(db->NewTransaction());
-      LOG(INFO) << "Processed " << count << " files.";
-    }
+// convert the octree archive built by the octree library, the labels are
+// taken from the index of the archive
+void convert_archive(const string& archive_name, const string& db_name) {
+  // each reading thread has its own archive
+  std::vector<caffe::octree::OctreeArchive> archives(std::max(FLAGS_threads, 1));
+  for (int i = 0; i < archives.size(); ++i) {
+    CHECK(archives[i].open(archive_name)) << "Unable to open archive #" << archive_name;
   }
-  // write the last batch
-  if (count % 1000 != 0) {
-    txn->Commit();
-    LOG(INFO) << "Processed " << count << " files.";
+
+  std::vector<int> ids(archives[0].size());
+  for (int i = 0; i < ids.size(); ++i) ids[i] = i;
+  if (FLAGS_shuffle) {
+    LOG(INFO) << "Shuffling data";
+    caffe::shuffle(ids.begin(), ids.end());
   }
+  LOG(INFO) << "A total of " << ids.size() << " octrees.";
+
+  write_records(db_name, ids.size(),
+      [&](int thread_id, int line_id, string* key_str, string* out) {
+    caffe::octree::OctreeArchive& archive = archives[thread_id];
+    const int id = ids[line_id];
+    string buffer;
+    CHECK(archive.read(id, buffer)) << "Unable to read octree #" << id;
+
+    *key_str = caffe::format_int(line_id, 8) + "_" + archive.name(id);
+    Datum datum;
+    SerializeOctree(buffer, archive.label(id), &datum, out);
+  });
 }
 
 // convert the database from one to another
@@ -173,15 +288,18 @@ int main(int argc, char** argv) {
   gflags::SetUsageMessage("This script converts the ModelNet dataset to\n"
       "the leveldb/lmdb format used by caffe to perform classification.\n"
       "Usage:\n"
-      "    convert_octree [FLAGS] ROOTFOLDER/ LISTFILE DB_NAME\n");
+      "    convert_octree [FLAGS] ROOTFOLDER/ LISTFILE DB_NAME\n"
+      "    convert_octree [FLAGS] ARCHIVE DB_NAME\n");
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
-  if (argc != 4) {
+  if (argc == 3) {
+    convert_archive(string(argv[1]), string(argv[2]));
+  } else if (argc == 4) {
+    convert_dataset(string(argv[1]), string(argv[2]), string(argv[3]));
+  } else {
     gflags::ShowUsageWithFlagsRestrict(argv[0], "convert_modelnet_data");
     return 1;
   }
 
-  convert_dataset(string(argv[1]), string(argv[2]), string(argv[3]));
-
   return 0;
 }
\ No newline at end of file
@@ -5,8 +5,13 @@
 #include <caffe/util/db.hpp>
 #include <caffe/util/format.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "google/protobuf/text_format.h"
@@ -16,23 +21,48 @@ using std::shared_ptr;
 using std::string;
 using caffe::Datum;
 
+// The records are serialized on the calling thread and are written to the
+// database by a background thread, so that AddData only blocks when the
+// queue of pending records is full, never on the commits of LMDB.
 class LmdbBuilder
 {
 public:
     LmdbBuilder();
     virtual ~LmdbBuilder();
 
-    void AddData(const string& buffer, int label);
+    // The buffer is taken over by the builder, so each record costs one copy:
+    // the Datum takes the buffer and is serialized, or the buffer is copied
+    // after the header of the raw record
+    void AddData(string buffer, int label);
+    // Write all the pending records and commit them
     void Close();
-    void Open(const string& dbPath);
+    // If raw is true, the octrees are stored as the raw records of
+    // caffe/util/octree_record.hpp instead of the Datum protobuf
+    void Open(const string& dbPath, bool raw = false);
+
+    // The transaction is committed once this size of records is written
+    static const size_t kCommitBytes = 64 << 20;
+    // AddData blocks while the pending records exceed this size
+    static const size_t kMaxQueueBytes = 256 << 20;
 
 private:
     void CheckOpen();
     void CheckClosed();
+    void WriteLoop();
     shared_ptr<db::DB> m_db;
     shared_ptr<db::Transaction> m_txn;
     int m_count;
     bool m_open;
+    bool m_raw;
+
+    // the queue of the (key, value) records shared with the writer thread
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_cvPush;
+    std::condition_variable m_cvPop;
+    std::deque<std::pair<string, string> > m_queue;
+    size_t m_queueBytes;
+    bool m_stop;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include <caffe/proto/caffe.pb.h>
 #include <caffe/util/db.hpp>
 #include <caffe/util/format.hpp>
+#include <caffe/util/octree_record.hpp>
 
 #include <string>
 #include <sstream>
@@ -17,7 +18,10 @@ namespace db = caffe::db;
 
 LmdbBuilder::LmdbBuilder()
     : m_count(0),
-      m_open(false)
+      m_open(false),
+      m_raw(false),
+      m_queueBytes(0),
+      m_stop(false)
 {
 }
 
@@ -37,7 +41,7 @@ void LmdbBuilder::CheckClosed()
     }
 }
 
-void LmdbBuilder::Open(const string& dbPath)
+void LmdbBuilder::Open(const string& dbPath, bool raw)
 {
     CheckClosed();
     m_db = unique_ptr<db::DB>(db::GetDB("lmdb"));
@@ -46,16 +50,25 @@ void LmdbBuilder::Open(const string& dbPath)
 
     m_count = 0;
     m_open = true;
+    m_raw = raw;
+    m_queue.clear();
+    m_queueBytes = 0;
+    m_stop = false;
+    m_writer = thread(&LmdbBuilder::WriteLoop, this);
 }
 
 void LmdbBuilder::Close()
 {
     if (m_open)
     {
-        if (m_count % 1000 != 0)
         {
-            m_txn->Commit();
+            lock_guard<mutex> lock(m_mutex);
+            m_stop = true;
         }
+        m_cvPush.notify_all();
+        m_writer.join();
+        m_txn.reset();
+        m_db.reset();
     }
     m_open = false;
     m_count = 0;
@@ -63,26 +76,80 @@ void LmdbBuilder::Close()
 
 LmdbBuilder::~LmdbBuilder()
 {
+    Close();
 }
 
-void LmdbBuilder::AddData(const string& buffer, int label)
+void LmdbBuilder::AddData(string buffer, int label)
 {
-    Datum datum;
-    datum.set_label(label);
-    datum.set_data(buffer);
-    datum.set_channels(buffer.size());
-    datum.set_height(1);
-    datum.set_width(1);
-
-    string key_str = caffe::format_int(m_count, 8);
+    CheckOpen();
     string out;
-    CHECK(datum.SerializeToString(&out));
-    m_txn->Put(key_str, out);
+    if (m_raw)
+    {
+        caffe::octree::pack_octree_record(out, buffer.data(), buffer.size(), label);
+    }
+    else
+    {
+        Datum datum;
+        datum.set_label(label);
+        datum.set_channels(buffer.size());
+        datum.set_height(1);
+        datum.set_width(1);
+        datum.set_data(std::move(buffer));
+        CHECK(datum.SerializeToString(&out));
+    }
 
-    m_count += 1;
-    if (m_count % 1000 == 0) {
-        m_txn->Commit();
-        m_txn.reset(m_db->NewTransaction());
+    {
+        unique_lock<mutex> lock(m_mutex);
+        // one record is always accepted, even if it exceeds the limit itself
+        m_cvPop.wait(lock, [this, &out] {
+            return m_queue.empty() || m_queueBytes + out.size() <= kMaxQueueBytes;
+        });
+        m_queueBytes += out.size();
+        m_queue.emplace_back(caffe::format_int(m_count, 8), std::move(out));
+        m_count += 1;
     }
+    m_cvPush.notify_one();
 }
 
+void LmdbBuilder::WriteLoop()
+{
+    size_t txnBytes = 0;
+    int txnCount = 0;
+    while (true)
+    {
+        pair<string, string> record;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_cvPush.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                break;  // stopped and all the records are written
+            }
+            record = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        m_txn->Put(record.first, record.second);
+        txnBytes += record.second.size();
+        txnCount += 1;
+        if (txnBytes >= kCommitBytes)
+        {
+            m_txn->Commit();
+            m_txn.reset(m_db->NewTransaction());
+            txnBytes = 0;
+            txnCount = 0;
+        }
+
+        // the record is released from the queue after it is written
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_queueBytes -= record.second.size();
+        }
+        m_cvPop.notify_all();
+    }
+
+    if (txnCount > 0)
+    {
+        m_txn->Commit();
+    }
+}
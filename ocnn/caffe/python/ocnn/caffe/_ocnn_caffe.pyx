@@ -4,6 +4,7 @@ from ocnn.dataset._writable_data cimport WritableData
 import os
 
 from libcpp.string cimport string
+from libcpp.utility cimport move
 
 cdef class LmdbBuilder:
     cdef _ocnn_caffe_extern.LmdbBuilder c_builder
@@ -11,18 +12,29 @@ cdef class LmdbBuilder:
     def __cinit__(self):
         pass
 
-    def open(self, db_path):
+    def open(self, db_path, raw=False):
+        """ Opens a new database.
+
+        Args:
+          db_path: Path of the database, which must not exist.
+          raw: Store the octrees as raw records instead of Datum protobufs.
+        """
         if os.path.exists(db_path):
             raise RuntimeError("DB Path {0} already exists".format(db_path))
 
         cdef string stl_string = db_path.encode('UTF-8')
-        self.c_builder.Open(stl_string)
+        self.c_builder.Open(stl_string, raw)
 
     def close(self):
         self.c_builder.Close()
 
     def add_data(self, WritableData writable_data, int label):
+        """ Adds one record, the data is moved out of writable_data, which is
+        empty afterwards.
+        """
+        cdef string data
+        data.swap(writable_data.cpp_string)
         with nogil:
-            self.c_builder.AddData(writable_data.cpp_string, label)
+            self.c_builder.AddData(move(data), label)
 
 
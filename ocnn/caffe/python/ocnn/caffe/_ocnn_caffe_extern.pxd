@@ -6,6 +6,6 @@ from libcpp cimport bool
 cdef extern from "ocnn/caffe/lmdb_builder.h" nogil:
     cdef cppclass LmdbBuilder:
         LmdbBuilder()
-        void Open(const string&)
-        void AddData(const string&, int)
-        void Close()
+        void Open(const string&, bool) except +
+        void AddData(string, int) except +
+        void Close() except +
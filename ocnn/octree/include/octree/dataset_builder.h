@@ -0,0 +1,105 @@
+#ifndef _OCTREE_DATASET_BUILDER_
+#define _OCTREE_DATASET_BUILDER_
+
+#include <string>
+#include <vector>
+
+#include "points.h"
+#include "octree.h"
+#include "octree_info.h"
+
+using std::string;
+using std::vector;
+
+// The parameters of OctreeInfo::initialize(), the same as the Python class
+// ocnn.octree.OctreeSettings
+struct OctreeSettings {
+  OctreeSettings() : depth(6), full_depth(2), node_displacement(true),
+    node_feature(false), split_label(false), adaptive(false),
+    adaptive_depth(4), threshold_distance(0.866f), threshold_normal(0.2f),
+    key2xyz(false) {}
+
+  int depth;
+  int full_depth;
+  bool node_displacement;
+  bool node_feature;
+  bool split_label;
+  bool adaptive;
+  int adaptive_depth;
+  float threshold_distance;
+  float threshold_normal;
+  bool key2xyz;
+};
+
+// The augmentations of the point cloud, which are applied in the order they
+// are added, the same as ocnn.octree.OctreeAugmentorCollection
+class PointsAugmentor {
+ public:
+  PointsAugmentor(const int num_aug = 1) : num_aug_(num_aug) {}
+  int num_aug() const { return num_aug_; }
+
+  void add_centering();
+  // displace the points by displacement * 2 * radius / 2^depth along the normals
+  void add_displacing(const double displacement, const int depth);
+  // rotate by 2 * pi * aug_idx / num_aug about the axis
+  void add_axial_rotation(const float* axis);
+  // align to the aug_idx^th point of the Fibonacci sphere, rnd in [0, num_aug)
+  // is the random shift of the points
+  void add_rotation(const double rnd);
+
+  void augment(Points& points, const int aug_idx) const;
+
+ protected:
+  enum AugType { kCentering, kDisplacing, kAxialRotation, kRotation };
+  struct Augmentation {
+    AugType type;
+    float param[3];  // the axis of kAxialRotation, or the depth of kDisplacing
+    // the displacement of kDisplacing or the shift of kRotation, kept and
+    // computed in double as on the python side
+    double value;
+  };
+  int num_aug_;
+  vector<Augmentation> augs_;
+};
+
+// Build the octrees of a dataset with a pool of threads: each item is read,
+// augmented, built into an octree and serialized by one of the threads, and
+// the octrees are handed to the writer on the calling thread in the order of
+// the items, so the output only depends on the order of the items.
+class DatasetBuilder {
+ public:
+  struct Item {
+    string filename;  // the points file
+    int label;
+    int aug_idx;
+  };
+
+  // The writer is called with the octree of the idx^th item, which can be
+  // swapped out; the octree is empty if the points can not be loaded. Return
+  // false to stop building.
+  typedef bool (*Writer)(void* context, const int idx, const Item& item,
+      string& octree);
+
+ public:
+  DatasetBuilder(const OctreeSettings& settings, const PointsAugmentor& augmentor)
+    : settings_(settings), augmentor_(augmentor) {}
+
+  // Return the number of the octrees written. At most queue_size octrees are
+  // kept in memory, 0 means 4 * thread_num.
+  int build(const vector<Item>& items, Writer writer, void* context,
+      const int thread_num, const int queue_size = 0) const;
+  // write the octrees into an archive (refer to octree_archive.h), named by
+  // the filename of the points and the augmentation index
+  int build_archive(const vector<Item>& items, const string& archive,
+      const int thread_num, const bool append = false) const;
+
+  // build the octree of one item, return false if the points can not be loaded;
+  // the builder can be reused across items to keep its scratch buffers
+  bool build_octree(string& octree, const Item& item, Octree& builder) const;
+
+ protected:
+  OctreeSettings settings_;
+  PointsAugmentor augmentor_;
+};
+
+#endif // _OCTREE_DATASET_BUILDER_
@@ -0,0 +1,32 @@
+#ifndef _OCTREE_MAPPED_FILE_
+#define _OCTREE_MAPPED_FILE_
+
+#include <string>
+
+using std::string;
+
+// A private (copy-on-write) memory mapping of a whole file. The pages are
+// backed by the page cache and are only copied when they are written, and
+// the writes never reach the file. The mapping is released on destruction.
+class MappedFile {
+ public:
+  MappedFile() : data_(nullptr), size_(0), handle_(nullptr) {}
+  ~MappedFile() { close(); }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // return false if the file can not be opened or is empty
+  bool open(const string& filename);
+  void close();
+
+  bool is_open() const { return data_ != nullptr; }
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ protected:
+  char* data_;
+  size_t size_;
+  void* handle_;  // the file mapping handle on Windows
+};
+
+#endif // _OCTREE_MAPPED_FILE_
@@ -14,46 +14,105 @@ using std::string;
 
 class Octree : public OctreeParser {
  public:
-  Octree() {}
+  Octree() : max_label_(0), feature_channel_(), direct_(false) {}
 
   void build(const OctreeInfo& octree_info, const Points& point_cloud);
+  // Build the octrees of the point cloud in several poses in one call, the
+  // rotations contain one 3x3 matrix per pose (in the layout produced by
+  // rotation_matrix() in util.h), and the serialized octrees are returned
+  // in the same order. The octrees are copied into the vectors of the caller,
+  // so that their memory is reused when the same vectors are passed again.
+  // After this call, this Octree holds no octree.
+  void build_poses(vector<vector<char> >& octrees, const OctreeInfo& octree_info,
+      const Points& point_cloud, const vector<float>& rotations);
   bool save(const string& filename);
 
   // serialize the results of the function build() into the buffer_
   void serialize();
 
+  // build() retains the memory of the previous build to avoid reallocation
+  // when it is called repeatedly, call release() to free the memory
+  void release();
+
  protected:
   void trim_octree();
   void save(ostream& stream);
   void clear(int depth = 0);
 
-  void normalize_pts(vector<float>& pts_scaled, const Points& pts);
-  void sort_keys(vector<uint32>& sorted_keys, vector<uint32>& sorted_idx,
+  // rotation is a 3x3 matrix applied to the points and normals, or nullptr
+  void build_pose(const OctreeInfo& octree_info, const Points& point_cloud,
+      const float* rotation);
+
+  void normalize_pts(vector<float>& pts_scaled, const Points& pts,
+      const float* rotation);
+  void sort_keys(vector<uint64>& sorted_keys, vector<uint32>& sorted_idx,
+      const vector<float>& pts_scaled);
+  // the fallback of sort_keys() when the point index does not fit in the code
+  void sort_keys_unpacked(vector<uint64>& sorted_keys, vector<uint32>& sorted_idx,
       const vector<float>& pts_scaled);
-  void unique_key(vector<uint32>& node_key, vector<uint32>& pidx);
+  void unique_key(vector<uint64>& node_key, vector<uint32>& pidx);
 
-  void build_structure(vector<uint32>& node_keys);
+  void build_structure(vector<uint64>& node_keys);
   void calc_node_num();  // called after the function build_structure()
 
-  void calc_signal(const Points& point_cloud, const vector<float>& pts_scaled,
-      const vector<uint32>& sorted_idx, const vector<uint32>& unique_idx);
+  void calc_signal(const Points& point_cloud, const float* normals,
+      const vector<float>& pts_scaled, const vector<uint32>& sorted_idx,
+      const vector<uint32>& unique_idx);
   void calc_signal(const bool calc_normal_err, const bool calc_dist_err);
+  // aggregate the signal of the coarse layers bottom-up from the 8 children,
+  // which is used when the error metrics of the adaptive octree are not needed
+  void calc_signal_bottom_up();
 
-  void key_to_xyz(vector<vector<uint32> >& xyz);
+  // convert the keys to xyz and write them to the key slots of buffer_
+  void key_to_xyz(uint32* xyz);
   void calc_split_label();
 
-  template<typename Dtype>
-  void serialize(Dtype* des, const vector<vector<Dtype> >& src, const int location);
+  template<typename Dtype, typename Stype>
+  void serialize(Dtype* des, const vector<vector<Stype> >& src, const int location);
+  // compute the scale of the int8/int16 property if it is not given, or
+  // switch it to fp16 if its channel ranges differ too much; return true if
+  // the size of the property changes
+  bool calc_data_scale(OctreeInfo::PropType ptype,
+      const vector<const vector<vector<float> >*>& signals);
+  // serialize the float property, which is the concatenation of the signals
+  // at each depth, and quantize it if its dtype is fp16 or int8/int16
+  void serialize_data(OctreeInfo::PropType ptype,
+      const vector<const vector<vector<float> >*>& signals);
 
   void covered_depth_nodes();
 
+  // set feature_channel_ according to the points and the normals
+  void calc_feature_channel(const Points& point_cloud, const float* normals);
+  // Allocate buffer_ for the final node numbers, so that the signals are
+  // written into their slots directly instead of into the per-level arrays.
+  // It is skipped if the octree is adaptive, whose node numbers change after
+  // trimming, or if a float property is not fp32, whose dtype and scale
+  // depend on all the values. Return true if buffer_ is allocated.
+  bool alloc_buffer();
+  // true if the signal of the ptype at depth d is written into buffer_
+  bool in_buffer(OctreeInfo::PropType ptype, const int d) const;
+  // return the storage of the signal at depth d, which is the slot of the
+  // ptype in buffer_ starting at the channel `offset` if buffer_ is allocated
+  // by alloc_buffer(), or signal[d] otherwise; alloc_signal() also resizes
+  // and fills the storage with value
+  float* signal_ptr(vector<vector<float> >& signal, OctreeInfo::PropType ptype,
+      const int d, const int offset);
+  float* alloc_signal(vector<vector<float> >& signal, OctreeInfo::PropType ptype,
+      const int d, const int offset, const int channel, const float value);
+
 
  protected:
   // Note: structure of arrays(SoA), instead of array of structures(AoS), is
   // adopted. The reason is that the SoA is more friendly to GPU-based implementation.
   // In the future, probably I will try to implement this class with CUDA accroding
   // to this CPU-based code.
-  vector<vector<uint32> > keys_;
+  // The signals of a non-adaptive octree with fp32 properties are written
+  // into buffer_ directly, see alloc_buffer(). Otherwise they are kept in
+  // these per-level arrays until serialize(), since the coarse-level signals,
+  // trim_octree() and the split labels read them.
+  // the keys are kept in 64 bits, and are serialized in 32 bits when the key
+  // channel of oct_info_ is 1
+  vector<vector<uint64> > keys_;
   vector<vector<int> > children_;
 
   vector<vector<float> > displacement_;
@@ -67,6 +126,10 @@ class Octree : public OctreeParser {
   vector<vector<float> > avg_pts_;       // 3 x N matrix
   vector<vector<float> > avg_labels_;
   int max_label_;
+  // the channels of normal, displacement, feature, fpfh and roughness, which
+  // are concatenated in this order as the kFeature property
+  int feature_channel_[5];
+  bool direct_;  // true if the signals are written into buffer_ directly
 
   OctreeInfo oct_info_;
 
@@ -75,6 +138,20 @@ class Octree : public OctreeParser {
   vector<vector<int> > didx_;
   vector<vector<float> > normal_err_;
   vector<vector<float> > distance_err_;
+
+  // the scratch buffers used by build(), retained across builds
+  struct Scratch {
+    vector<float> pts_scaled;
+    vector<float> normals;
+    vector<uint64> node_keys;
+    vector<uint32> sorted_idx;
+    vector<uint32> unique_idx;
+    vector<uint64> key_buffer;
+    vector<uint64> codes;
+    vector<uint64> codes_buffer;
+    vector<float> sums[2];
+    vector<int> votes[2];
+  } scratch_;
 };
 
 #endif // _OCTREE_OCTREE_
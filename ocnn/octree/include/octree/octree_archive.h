@@ -0,0 +1,96 @@
+#ifndef _OCTREE_OCTREE_ARCHIVE_
+#define _OCTREE_OCTREE_ARCHIVE_
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+using std::string;
+using std::vector;
+
+// The octree archive packs many octrees into one file, so that a dataset can
+// be built, copied and shuffled as a unit instead of as millions of small
+// files. Each octree is stored as it is (the original or the compact format)
+// and is aligned to 8 bytes, so that it can be parsed in place from a memory
+// mapping of the archive.
+//
+// Layout: ArchiveHeader, the octrees, the index (header.num ArchiveEntry),
+// the names of the entries. The header is rewritten when the archive is
+// closed, since the index is only known after all the octrees are written.
+
+extern const char kArchiveMagicStr[16];
+
+struct ArchiveHeader {
+  char magic[16];
+  uint64_t index_offset;
+  int num;
+  int reserved;
+};
+
+struct ArchiveEntry {
+  uint64_t offset;    // the position of the octree in the archive
+  uint64_t size;      // the size of the octree in bytes
+  int label;
+  int pose;           // the pose id, i.e. the index of the rotation
+  int name_pos;       // the position of the name in the name table
+  int name_len;
+};
+
+// the layout is also read by caffe/include/caffe/util/octree_archive.hpp
+static_assert(sizeof(ArchiveHeader) == 32, "The size of ArchiveHeader is changed");
+static_assert(sizeof(ArchiveEntry) == 32, "The size of ArchiveEntry is changed");
+
+class OctreeArchiveWriter {
+ public:
+  OctreeArchiveWriter() : offset_(0) {}
+  ~OctreeArchiveWriter() { close(); }
+
+  // If append is true and the file exists, the new octrees are appended to
+  // it, and false is returned if it is not a valid archive; otherwise a new
+  // archive is created. The old index is left in place as unused bytes, so
+  // the archive stays readable if the writer is not closed
+  bool open(const string& filename, const bool append = false);
+  // add one octree, it can be called from multiple threads
+  bool add(const char* data, const size_t sz, const string& name,
+      const int label = 0, const int pose = 0);
+  // write the index and the header
+  bool close();
+  bool is_open() const { return outfile_.is_open(); }
+
+ protected:
+  std::ofstream outfile_;
+  std::mutex mutex_;
+  vector<ArchiveEntry> entries_;
+  string names_;
+  uint64_t offset_;   // the end of the written octrees
+};
+
+class OctreeArchive {
+ public:
+  OctreeArchive() : names_(nullptr) {}
+  // the archive is memory-mapped, return false if it is not a valid archive
+  bool open(const string& filename);
+  void close();
+
+  int size() const { return static_cast<int>(entries_.size()); }
+  const ArchiveEntry& entry(const int i) const { return entries_[i]; }
+  int label(const int i) const { return entries_[i].label; }
+  int pose(const int i) const { return entries_[i].pose; }
+  string name(const int i) const;
+  const char* data(const int i) const { return mapped_->data() + entries_[i].offset; }
+  size_t data_size(const int i) const { return entries_[i].size; }
+  // the mapping is shared with the OctreeParsers reading from the archive
+  const std::shared_ptr<MappedFile>& mapped_file() const { return mapped_; }
+
+ protected:
+  std::shared_ptr<MappedFile> mapped_;
+  vector<ArchiveEntry> entries_;
+  const char* names_;
+};
+
+#endif // _OCTREE_OCTREE_ARCHIVE_
@@ -0,0 +1,37 @@
+#ifndef _OCTREE_OCTREE_CODEC_
+#define _OCTREE_OCTREE_CODEC_
+
+#include <vector>
+#include <string>
+
+#include "octree_parser.h"
+
+using std::vector;
+using std::string;
+
+// The compact octree format. Instead of one child pointer and one key per
+// node, the structure is stored as one 8-bit occupancy mask per group of
+// 8 sibling nodes, from which the children and keys of all layers are
+// recovered. The masks and the remaining properties are entropy coded with
+// an adaptive binary range coder. The features can optionally be quantized
+// to 8 or 16 bits per value with a per-channel scale, in which case the
+// zero features of the empty nodes are still exact. The fp16 and int8/int16
+// properties are coded without further quantization.
+//
+// Layout: kCompactMagicStr[16], quant_bits, OctreeInfo, coded stream.
+
+extern const char kCompactMagicStr[16];
+
+// return true if the data starts with kCompactMagicStr
+bool is_compact_octree(const char* data, const size_t sz);
+
+// Encode the octree, quant_bits is 0 (lossless), 8 or 16. Return false if the
+// octree can not be described by the occupancy masks, e.g. a batch of
+// merged octrees, in which case it should be saved in the original format.
+bool compress_octree(vector<char>& out, const OctreeParser& octree,
+    const int quant_bits = 0);
+
+// Decode the compact octree into the original serialized layout
+bool decompress_octree(vector<char>& buffer, const char* data, const size_t sz);
+
+#endif // _OCTREE_OCTREE_CODEC_
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "points.h"
+#include "quantize.h"
 
 using std::string;
 
@@ -13,6 +14,8 @@ class OctreeInfo {
     kKey = 1, kChild = 2, kNeigh = 4, kFeature = 8, kLabel = 16, kSplit = 32
   };
   static const int kPTypeNum = 6;
+  // bounded by the size of nnum_cum_[], which holds depth + 3 numbers
+  static const int kMaxDepth = 13;
   static const char kMagicStr[16];
 
  public:
@@ -53,6 +56,12 @@ class OctreeInfo {
   int channel(PropType ptype) const;
   int locations(PropType ptype) const;
   int ptr_dis(PropType ptype, const int depth) const;
+  // the element type of the property, only kFeature, kLabel and kSplit can be
+  // stored as fp16 or int8/int16, the others are always 32-bit
+  DataType dtype(PropType ptype) const;
+  float scale(PropType ptype) const;
+  float offset(PropType ptype) const;
+  int sizeof_element(PropType ptype) const { return sizeof_dtype(dtype(ptype)); }
   float bbox_max_width() const;
   bool key2xyz() const { return key2xyz_; }
   const float* bbmin() const { return bbmin_; }
@@ -69,6 +78,11 @@ class OctreeInfo {
   void set_channel(PropType ptype, int ch);
   void set_location(PropType ptype, int lc);
   void set_ptr_dis();
+  // For the integer types, value = element * scale + offset. If the scale is
+  // 0, it is computed from the data when the octree is serialized; since one
+  // scale covers all the channels, fp16 is used instead if the ranges of the
+  // channels differ by more than 4 times.
+  void set_dtype(PropType ptype, DataType dtype, float scale = 0, float offset = 0);
   void set_bbox(float radius, const float* center);
   void set_bbox(const float* bbmin, const float* bbmax);
   void set_key2xyz(bool b) { key2xyz_ = b; }
@@ -100,7 +114,10 @@ class OctreeInfo {
   int locations_[16];   // -1: at all levels; d: at the d^th level
   float bbmin_[3];
   float bbmax_[3];
-  char reserved_[256];  // reserved for future usage: 2018/10/31
+  int dtypes_[8];       // the element type of the properties, refer to DataType
+  float scales_[8];     // the scale and offset of the integer types
+  float offsets_[8];
+  char reserved_[160];  // reserved for future usage: 2018/10/31
 
  private:
   int ptr_dis_[16];
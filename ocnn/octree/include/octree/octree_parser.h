@@ -3,9 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "points.h"
 #include "octree_info.h"
+#include "mapped_file.h"
+#include "octree_archive.h"
 
 using std::vector;
 using std::string;
@@ -17,8 +20,9 @@ class OctreeParser {
   enum NodeType {kNonEmptyLeaf = -2, kLeaf = -1, kInternelNode = 0 };
 
  public:
-  OctreeParser() : info_(nullptr) {}
+  OctreeParser() : info_(nullptr), mapped_size_(0) {}
   const OctreeInfo& info() const { return *info_; }
+  // the buffer is empty if the octree is memory-mapped by read_octree()
   const vector<char>& buffer() const { return buffer_; }
   bool is_empty() const { return info_ == nullptr; }
   NodeType node_type(const int t) const;
@@ -30,6 +34,11 @@ class OctreeParser {
   const float* feature(const int depth) const;
   const float* label(const int depth) const;
   const float* split(const int depth) const;
+  // Return the float data of the property at the depth. If the property is
+  // stored as fp16 or int8/int16, it is dequantized into buf, otherwise the
+  // pointer into the octree is returned without copying.
+  const float* float_ptr(vector<float>& buf, const OctreeInfo::PropType ptype,
+      const int depth) const;
 
   void set_octree(vector<char>& data); // swap data and buffer_
   void set_octree(const char* data, const int sz);
@@ -43,8 +52,33 @@ class OctreeParser {
   float* mutable_label(const int depth);
   float* mutable_split(const int depth);
 
-  bool read_octree(const string& filename);
+  // The readers release the previous octree first, and leave the parser empty
+  // if they fail.
+  // If use_mmap is true, the file is memory-mapped instead of being copied
+  // into buffer_, and info_ points into the mapping; it falls back to the
+  // copying read if the file can not be mapped. The compact octree (refer to
+  // octree_codec.h) is detected and decoded into buffer_.
+  bool read_octree(const string& filename, const bool use_mmap = false);
+  // Read only the properties in content_flags, a combination of the
+  // OctreeInfo::PropType, at the depths in [depth_start, depth_end], seeking
+  // to each section with the ptr_dis offsets of the header. The other
+  // properties are removed from the info, and the data of the other depths is
+  // left as zero. depth_end = -1 means the maximum depth. The compact octree
+  // is decoded as a whole first. Only the I/O is reduced: the buffer_ still
+  // holds all the depths of the selected properties, so that the layout
+  // matches the info.
+  bool read_octree_partial(const string& filename, const int content_flags,
+      const int depth_start = 0, const int depth_end = -1);
+  // Read the idx^th octree of the archive. The octree is parsed in place, and
+  // the parsers reading from one archive share its mapping, which is kept
+  // alive until all of them are released, so the writes via the mutable_*
+  // accessors are visible to the other parsers. The compact octree is decoded.
+  // The entry is rejected if its header is invalid or the entry is shorter
+  // than the octree described by the header.
+  bool read_octree(const OctreeArchive& archive, const int idx);
   bool write_octree(const string& filename) const;
+  // save in the compact format, quant_bits is 0 (lossless), 8 or 16
+  bool write_octree_compact(const string& filename, const int quant_bits = 0) const;
   string get_binary_string() const;
 
   void octree2pts(Points& point_cloud, int depth_start, int depth_end);
@@ -57,13 +91,23 @@ class OctreeParser {
   void compute_key(uint32& key, const uint32* pt, const int depth);
   // compute the point coordinate given the key
   void compute_pt(uint32* pt, const uint32& key, const int depth);
+  // the 64-bit versions, which take the 32-bit fast path when depth <= 10
+  void compute_key(uint64& key, const uint32* pt, const int depth);
+  void compute_pt(uint32* pt, const uint64& key, const int depth);
+  // get the coordinate of the i-th node of the depth layer from the serialized
+  // key, which can be the 32/64-bit key, or the xyz in 8/16-bit per axis
+  void node_pt(uint32* pt, const int i, const int depth) const;
 
   int clamp(int val, int val_min, int val_max);
+  // release the buffer_ and the mapping, and make the parser empty
+  void reset_octree();
 
  protected:
-  // the octree is serialized into buffer_
+  // the octree is serialized into buffer_, or is in the mapped_ file
   vector<char> buffer_;
+  std::shared_ptr<MappedFile> mapped_;
   OctreeInfo* info_;
+  size_t mapped_size_;  // the size of the octree in the mapped_ file
 
   // const
   const float ESP = 1.0e-30f;
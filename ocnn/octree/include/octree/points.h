@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+
+#include "mapped_file.h"
 
 using std::vector;
 using std::string;
@@ -76,7 +79,11 @@ class Points {
   PointsData get_points_data() const;
   PointsBounds get_points_bounds() const;
 
-  bool read_points(const string& filename);
+  // If use_mmap is true, the file is memory-mapped instead of being copied
+  // into buffer_; it falls back to the copying read if the mapping fails.
+  // The mapping is private, so the pages written by the transforms are
+  // copied: only map the points which are not modified.
+  bool read_points(const string& filename, const bool use_mmap = false);
   bool write_points(const string& filename) const;
   bool write_ply(const string& filename) const;
 
@@ -92,6 +99,7 @@ class Points {
  protected:
   PtsInfo* info_;
   vector<char> buffer_;
+  std::shared_ptr<MappedFile> mapped_;
 };
 
 #endif // _OCTREE_POINTS_
@@ -0,0 +1,155 @@
+#ifndef _OCTREE_QUANTIZE_
+#define _OCTREE_QUANTIZE_
+
+// The element types of the data properties of the octree. The integer types
+// store round((value - offset) / scale), and are dequantized as
+// element * scale + offset; the loops are simple enough to be vectorized. The
+// fp16 values are converted 8 at a time with the F16C and AVX instructions
+// when the compiler targets both (-mf16c -mavx or -march=native), and with the
+// bit manipulations otherwise.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__F16C__) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+enum DataType { kFloat32 = 0, kFloat16 = 1, kInt16 = 2, kInt8 = 3 };
+const int kDataTypeNum = 4;
+
+inline int sizeof_dtype(const DataType dtype) {
+  const int sz[] = { 4, 2, 2, 1 };
+  return sz[dtype];
+}
+
+// the largest magnitude of the integer types
+inline int dtype_max(const DataType dtype) {
+  return dtype == kInt8 ? 127 : 32767;
+}
+
+inline float half_to_float(const uint16_t h) {
+  const uint32_t shifted_exp = 0x7C00u << 13;
+  uint32_t u = (h & 0x7FFFu) << 13;
+  const uint32_t exp = u & shifted_exp;
+  u += (127u - 15u) << 23;
+  if (exp == shifted_exp) {
+    u += (128u - 16u) << 23;           // Inf/NaN
+  } else if (exp == 0) {
+    u += 1u << 23;                     // denormal: renormalize
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    f -= 6.103515625e-05f;             // 2^-14
+    memcpy(&u, &f, sizeof(u));
+  }
+  u |= static_cast<uint32_t>(h & 0x8000u) << 16;
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// round to the nearest even
+inline uint16_t float_to_half(const float val) {
+  const uint32_t f32_inf = 255u << 23;
+  const uint32_t f16_max = (127u + 16) << 23;
+  const uint32_t denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+  uint32_t u;
+  memcpy(&u, &val, sizeof(u));
+  const uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+
+  uint16_t h;
+  if (u >= f16_max) {
+    h = u > f32_inf ? 0x7E00 : 0x7C00;  // NaN or Inf
+  } else if (u < (113u << 23)) {
+    float f, magic;
+    memcpy(&f, &u, sizeof(f));
+    memcpy(&magic, &denorm_magic, sizeof(magic));
+    f += magic;
+    memcpy(&u, &f, sizeof(u));
+    h = static_cast<uint16_t>(u - denorm_magic);
+  } else {
+    uint32_t mant_odd = (u >> 13) & 1u;
+    u += ((15u - 127u) << 23) + 0xFFFu;
+    u += mant_odd;
+    h = static_cast<uint16_t>(u >> 13);
+  }
+  return h | static_cast<uint16_t>(sign >> 16);
+}
+
+// convert num elements of the type dtype in src to float
+inline void dequantize(float* des, const void* src, const int num,
+    const DataType dtype, const float scale, const float offset) {
+  int i = 0;
+  switch (dtype) {
+    case kFloat32: {
+      memcpy(des, src, num * sizeof(float));
+      break;
+    }
+    case kFloat16: {
+      const uint16_t* s = static_cast<const uint16_t*>(src);
+#if defined(__F16C__) && defined(__AVX__)
+      for (; i + 8 <= num; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        _mm256_storeu_ps(des + i, _mm256_cvtph_ps(h));
+      }
+#endif
+      for (; i < num; ++i) des[i] = half_to_float(s[i]);
+      break;
+    }
+    case kInt16: {
+      const int16_t* s = static_cast<const int16_t*>(src);
+      for (; i < num; ++i) des[i] = s[i] * scale + offset;
+      break;
+    }
+    case kInt8: {
+      const int8_t* s = static_cast<const int8_t*>(src);
+      for (; i < num; ++i) des[i] = s[i] * scale + offset;
+      break;
+    }
+  }
+}
+
+// convert num floats in src to the type dtype
+inline void quantize(void* des, const float* src, const int num,
+    const DataType dtype, const float scale, const float offset) {
+  int i = 0;
+  switch (dtype) {
+    case kFloat32: {
+      memcpy(des, src, num * sizeof(float));
+      break;
+    }
+    case kFloat16: {
+      uint16_t* d = static_cast<uint16_t*>(des);
+#if defined(__F16C__) && defined(__AVX__)
+      for (; i + 8 <= num; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), h);
+      }
+#endif
+      for (; i < num; ++i) d[i] = float_to_half(src[i]);
+      break;
+    }
+    case kInt16: {
+      int16_t* d = static_cast<int16_t*>(des);
+      const float inv = 1.0f / scale;
+      for (; i < num; ++i) {
+        float q = std::nearbyint((src[i] - offset) * inv);
+        d[i] = static_cast<int16_t>(std::fmin(std::fmax(q, -32767.0f), 32767.0f));
+      }
+      break;
+    }
+    case kInt8: {
+      int8_t* d = static_cast<int8_t*>(des);
+      const float inv = 1.0f / scale;
+      for (; i < num; ++i) {
+        float q = std::nearbyint((src[i] - offset) * inv);
+        d[i] = static_cast<int8_t>(std::fmin(std::fmax(q, -127.0f), 127.0f));
+      }
+      break;
+    }
+  }
+}
+
+#endif // _OCTREE_QUANTIZE_
@@ -20,6 +20,16 @@ void inverse_transpose_3x3(float* const out, const float* const mat);
 bool almost_equal_3x3(const float* const mat1, const float* const mat2);
 void normalize_nx3(float* const pts, int npt);
 
+// Stable LSD radix sort of the 64-bit codes, only the bits in the range
+// [bit_begin, bit_end) are compared. The passes are parallelized with OpenMP,
+// and std::stable_sort is used for small inputs. The buffer is used as the
+// scratch of the passes, and it is swapped with codes if necessary.
+void radix_sort(vector<unsigned long long>& codes,
+    vector<unsigned long long>& buffer, const int bit_begin = 0,
+    const int bit_end = 64);
+void radix_sort(vector<unsigned long long>& codes, const int bit_begin = 0,
+    const int bit_end = 64);
+
 void get_all_filenames(vector<string>& all_filenames, const string& filename);
 
 bool write_obj(const string& filename, const vector<float>& V, const vector<int>& F);
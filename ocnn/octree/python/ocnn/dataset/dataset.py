@@ -26,6 +26,7 @@ class Dataset:
         self.dataset_structure = dataset_structure
         self.data_processor = None
         self.builder = None
+        self.use_native = True
 
     def _consume_function(self, item):
         """ Consume function used by builder object.
@@ -47,6 +48,19 @@ class Dataset:
 
         return (writable_data, label)
 
+    def _native_builder(self):
+        """ Returns the native builder of the data processor, or None if the
+        data processor only works in Python, e.g. it has an augmentor which is
+        not supported natively.
+        """
+        native_builder = getattr(self.data_processor, 'native_builder', None)
+        if native_builder is None or not self.use_native:
+            return None
+        try:
+            return native_builder()
+        except ValueError:
+            return None
+
     def _generate_class_label_map(self, dataset_map):
         """ Iterates through dataset splits and merges classes to create a map
         between class label and an class label index.
@@ -60,17 +74,21 @@ class Dataset:
             class_set = class_set.union(split_class_set)
         return dict(zip(class_set, range(len(class_set))))
 
-    def produce_dataset(self, data_processor, builder, output_folder, num_threads=8):
+    def produce_dataset(self, data_processor, builder, output_folder, num_threads=8,
+                        use_native=True):
         """ Produces dataset
         Args:
           data_processor: DataProcessor object.
           builder: Builder object.
           output_folder: Folder to output dataset.
           num_threads: Number of worker threads to generate dataset.
+          use_native: Build the data on native threads if the data processor
+            provides a native_builder, otherwise with Python threads.
         """
 
         self.data_processor = data_processor
         self.builder = builder
+        self.use_native = use_native
 
         dataset_map = {split: defaultdict(list) for split in Dataset.SPLITS}
 
@@ -92,20 +110,29 @@ class Dataset:
                 permutation_sequence = np.random.permutation(class_position_cumsum[-1])
                 class_list = list(class_model_map.keys())
 
-                with OrderedProducerConsumer(num_threads,
-                                             self._produce_function,
-                                             self._consume_function) as pc:
-                    for permutation_idx in permutation_sequence:
-                        prev_sum = 0
-                        for idx, cur_sum in enumerate(class_position_cumsum):
-                            if permutation_idx < cur_sum:
-                                class_type = class_list[idx]
-                                break
-                            prev_sum = cur_sum
-                        shift_idx = permutation_idx - prev_sum
-                        model_idx = int(shift_idx / self.data_processor.num_aug)
-                        aug_idx = shift_idx % self.data_processor.num_aug
-                        file_path = class_model_map[class_type][model_idx]
-                        pc.put((file_path, class_label_map[class_type], aug_idx))
+                items = []
+                for permutation_idx in permutation_sequence:
+                    prev_sum = 0
+                    for idx, cur_sum in enumerate(class_position_cumsum):
+                        if permutation_idx < cur_sum:
+                            class_type = class_list[idx]
+                            break
+                        prev_sum = cur_sum
+                    shift_idx = permutation_idx - prev_sum
+                    model_idx = int(shift_idx / self.data_processor.num_aug)
+                    aug_idx = shift_idx % self.data_processor.num_aug
+                    file_path = class_model_map[class_type][model_idx]
+                    items.append((file_path, class_label_map[class_type], aug_idx))
+
+                native_builder = self._native_builder()
+                if native_builder is not None:
+                    count = native_builder.build(items, self.builder.add_data, num_threads)
+                    print('Inserted {0} of {1} into {2}'.format(count, len(items), split))
+                else:
+                    with OrderedProducerConsumer(num_threads,
+                                                 self._produce_function,
+                                                 self._consume_function) as pc:
+                        for item in items:
+                            pc.put(item)
 
                 self.builder.close()
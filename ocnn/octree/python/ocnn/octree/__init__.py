@@ -1,4 +1,4 @@
-from ocnn.octree._octree import Points, OctreeInfo, Octree
+from ocnn.octree._octree import Points, OctreeInfo, Octree, DatasetBuilder
 from ocnn.octree.octree_augmentor import OctreeAugmentorCollection
 from ocnn.octree.octree_processor import OctreeProcessor
 from ocnn.octree.octree_settings import OctreeSettings
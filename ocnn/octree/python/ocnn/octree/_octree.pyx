@@ -7,6 +7,7 @@ cimport numpy as np
 from cython.operator cimport dereference
 from libcpp cimport bool
 from libcpp.string cimport string
+from libcpp.vector cimport vector
 
 def _check_array(array, shape):
     if shape != array.shape:
@@ -20,11 +21,19 @@ def _ensure_contiguous(np.ndarray array):
 cdef class Points:
     cdef _octree_extern.Points c_points
 
-    def __cinit__(self, filename):
+    def __cinit__(self, filename, bool use_mmap=False):
+        """ Reads the points file.
+        Args:
+          filename: Path to the points file.
+          use_mmap: Memory-map the file instead of copying it, which only
+            saves memory if the points are not modified: the written pages
+            are copied. The file must not be overwritten, e.g. by
+            write_file, while it is mapped.
+        """
         cdef string stl_string = filename.encode('UTF-8')
         cdef bool points_read
         with nogil:
-            points_read = self.c_points.read_points(stl_string)
+            points_read = self.c_points.read_points(stl_string, use_mmap)
         if not points_read:
             raise RuntimeError('Could not read points file: {0}'.format(filename))
 
@@ -153,3 +162,123 @@ cdef class Octree(WritableData):
         cdef string stl_string = filename.encode('UTF-8')
         with nogil:
             self.c_octree.save(stl_string)
+
+
+cdef bool _write_octree(void* context, const int idx,
+                        const _octree_extern.DatasetItem& item,
+                        string& octree) noexcept with gil:
+    """ Hands the octree built by DatasetBuilder to the Python writer, an
+    exception of the writer is kept in the context and stops the building.
+    """
+    state = <list>context
+    if octree.empty():
+        return True
+    cdef WritableData writable_data = WritableData()
+    writable_data.cpp_string.swap(octree)
+    try:
+        state[0](writable_data, item.label)
+    except BaseException as e:
+        state[1] = e
+        return False
+    return True
+
+cdef vector[_octree_extern.DatasetItem] _dataset_items(items):
+    cdef vector[_octree_extern.DatasetItem] c_items
+    cdef _octree_extern.DatasetItem c_item
+    c_items.reserve(len(items))
+    for file_path, label, aug_idx in items:
+        c_item.filename = file_path.encode('UTF-8')
+        c_item.label = label
+        c_item.aug_idx = aug_idx
+        c_items.push_back(c_item)
+    return c_items
+
+cdef class DatasetBuilder:
+    """ Builds the octrees of a dataset on a pool of native threads, the same as
+    OctreeProcessor.process, without holding the GIL. The octrees are output in
+    the order of the items.
+    """
+    cdef _octree_extern.DatasetBuilder* c_builder
+
+    def __cinit__(self, octree_settings, augmentor_collection=None):
+        """ Initializes DatasetBuilder
+        Args:
+          octree_settings: OctreeSettings object.
+          augmentor_collection: OctreeAugmentorCollection object.
+        """
+        from ocnn.octree.octree_augmentor import (AxialRotationAugmentor,
+            CenteringAugmentor, DisplacingAugmentor, RotationAugmentor)
+
+        cdef _octree_extern.OctreeSettings c_settings
+        c_settings.depth = octree_settings.depth
+        c_settings.full_depth = octree_settings.full_depth
+        c_settings.node_displacement = octree_settings.node_displacement
+        c_settings.node_feature = octree_settings.node_feature
+        c_settings.split_label = octree_settings.split_label
+        c_settings.adaptive = octree_settings.adaptive
+        c_settings.adaptive_depth = octree_settings.adaptive_depth
+        c_settings.threshold_distance = octree_settings.threshold_distance
+        c_settings.threshold_normal = octree_settings.threshold_normal
+        c_settings.key2xyz = octree_settings.key2xyz
+
+        num_aug = 1 if augmentor_collection is None else augmentor_collection.num_aug
+        cdef _octree_extern.PointsAugmentor* c_augmentor = new _octree_extern.PointsAugmentor(num_aug)
+        cdef float[::1] axis_view
+        augmentors = [] if augmentor_collection is None else augmentor_collection._augmentors
+        try:
+            for augmentor in augmentors:
+                if isinstance(augmentor, CenteringAugmentor):
+                    c_augmentor.add_centering()
+                elif isinstance(augmentor, DisplacingAugmentor):
+                    c_augmentor.add_displacing(augmentor.displacement, augmentor.depth)
+                elif isinstance(augmentor, AxialRotationAugmentor):
+                    axis_view = np.ascontiguousarray(augmentor.axis, dtype=np.float32)
+                    c_augmentor.add_axial_rotation(&axis_view[0])
+                elif isinstance(augmentor, RotationAugmentor):
+                    c_augmentor.add_rotation(augmentor.rnd)
+                else:
+                    raise ValueError('Augmentor {0} is not supported natively'.format(
+                        type(augmentor).__name__))
+            self.c_builder = new _octree_extern.DatasetBuilder(c_settings, dereference(c_augmentor))
+        finally:
+            del c_augmentor
+
+    def __dealloc__(self):
+        del self.c_builder
+
+    def build(self, items, writer, int num_threads=8):
+        """ Builds the octrees and writes them in the order of the items.
+        Args:
+          items: List of tuples of file_path, label and augmentation index.
+          writer: Callable taking a WritableData and the label, such as
+            LmdbBuilder.add_data.
+          num_threads: Number of worker threads.
+        Returns:
+          The number of the octrees written.
+        """
+        cdef vector[_octree_extern.DatasetItem] c_items = _dataset_items(items)
+        state = [writer, None]
+        cdef void* context = <void*>state
+        cdef int count
+        with nogil:
+            count = self.c_builder.build(c_items, _write_octree, context, num_threads, 0)
+        if state[1] is not None:
+            raise state[1]
+        return count
+
+    def build_archive(self, items, archive_path, int num_threads=8, bool append=False):
+        """ Builds the octrees and packs them into an octree archive.
+        Args:
+          items: List of tuples of file_path, label and augmentation index.
+          archive_path: Path of the archive.
+          num_threads: Number of worker threads.
+          append: Append to the archive if it exists.
+        Returns:
+          The number of the octrees written.
+        """
+        cdef vector[_octree_extern.DatasetItem] c_items = _dataset_items(items)
+        cdef string stl_string = archive_path.encode('UTF-8')
+        cdef int count
+        with nogil:
+            count = self.c_builder.build_archive(c_items, stl_string, num_threads, append)
+        return count
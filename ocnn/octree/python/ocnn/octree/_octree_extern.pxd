@@ -2,6 +2,7 @@
 
 from libcpp.string cimport string
 from libcpp cimport bool
+from libcpp.vector cimport vector
 
 cdef extern from "points.h":
     cdef cppclass PointsData:
@@ -20,7 +21,7 @@ cdef extern from "points.h":
 cdef extern from "points.h" nogil:
     cdef cppclass Points:
         Points()
-        bool read_points(const string&)
+        bool read_points(const string&, bool)
         bool write_points(const string&)
         PointsData get_points_data()
         PointsBounds get_points_bounds()
@@ -43,3 +44,37 @@ cdef extern from "octree.h" nogil:
         void build(const OctreeInfo&, const Points&);
         bool save(const string&)
         string get_binary_string()
+
+cdef extern from "dataset_builder.h" nogil:
+    cdef cppclass OctreeSettings:
+        OctreeSettings()
+        int depth
+        int full_depth
+        bool node_displacement
+        bool node_feature
+        bool split_label
+        bool adaptive
+        int adaptive_depth
+        float threshold_distance
+        float threshold_normal
+        bool key2xyz
+
+    cdef cppclass PointsAugmentor:
+        PointsAugmentor(int)
+        int num_aug()
+        void add_centering()
+        void add_displacing(double, int)
+        void add_axial_rotation(const float*)
+        void add_rotation(double)
+
+    cdef cppclass DatasetItem "DatasetBuilder::Item":
+        string filename
+        int label
+        int aug_idx
+
+    ctypedef bool (*DatasetWriter)(void*, const int, const DatasetItem&, string&)
+
+    cdef cppclass DatasetBuilder:
+        DatasetBuilder(const OctreeSettings&, const PointsAugmentor&)
+        int build(const vector[DatasetItem]&, DatasetWriter, void*, int, int)
+        int build_archive(const vector[DatasetItem]&, const string&, int, bool)
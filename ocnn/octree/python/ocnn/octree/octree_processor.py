@@ -9,6 +9,7 @@ import random
 import numpy as np
 
 from ocnn.dataset.data_processor import DataProcessor
+from ocnn.octree._octree import DatasetBuilder
 from ocnn.octree._octree import Octree
 from ocnn.octree._octree import OctreeInfo
 from ocnn.octree._octree import Points
@@ -30,6 +31,8 @@ class OctreeProcessor(DataProcessor):
           file_path: Path to points file
           aug_index: Augmentation index of total augmentations.
         """
+        # the points are transformed in place by the augmentors, so the file
+        # is copied instead of mapped
         points = Points(file_path)
         octree_info = OctreeInfo()
         octree_info.initialize(
@@ -51,3 +54,9 @@ class OctreeProcessor(DataProcessor):
         octree_info.set_bbox(radius, center)
 
         return Octree(octree_info, points)
+
+    def native_builder(self):
+        """ Returns a DatasetBuilder, which does the same as process() for a
+        list of items on native threads.
+        """
+        return DatasetBuilder(self.octree_settings, self.augmentor_collection)
@@ -0,0 +1,188 @@
+#include "dataset_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "octree.h"
+#include "octree_archive.h"
+#include "util.h"
+
+void PointsAugmentor::add_centering() {
+  Augmentation aug = { kCentering, { 0.0f, 0.0f, 0.0f }, 0.0 };
+  augs_.push_back(aug);
+}
+
+void PointsAugmentor::add_displacing(const double displacement, const int depth) {
+  Augmentation aug = { kDisplacing, { float(depth), 0.0f, 0.0f }, displacement };
+  augs_.push_back(aug);
+}
+
+void PointsAugmentor::add_axial_rotation(const float* axis) {
+  float len = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+  Augmentation aug = { kAxialRotation, { axis[0] / len, axis[1] / len, axis[2] / len }, 0.0 };
+  augs_.push_back(aug);
+}
+
+void PointsAugmentor::add_rotation(const double rnd) {
+  Augmentation aug = { kRotation, { 0.0f, 0.0f, 0.0f }, rnd };
+  augs_.push_back(aug);
+}
+
+void PointsAugmentor::augment(Points& points, const int aug_idx) const {
+  const double kPI = 3.14159265358979323846;
+  for (const Augmentation& aug : augs_) {
+    switch (aug.type) {
+      case kCentering: {
+        PointsBounds bounds = points.get_points_bounds();
+        points.center_about(bounds.center);
+        break;
+      }
+      case kDisplacing: {
+        PointsBounds bounds = points.get_points_bounds();
+        double offset = aug.value * 2.0 * bounds.radius / pow(2.0, aug.param[0]);
+        points.displace(float(offset));
+        break;
+      }
+      case kAxialRotation: {
+        float angle = float(2.0 * kPI / num_aug_ * aug_idx);
+        points.rotate(angle, aug.param);
+        break;
+      }
+      case kRotation: {
+        // the rotation aligning the z axis to the point on the Fibonacci sphere
+        double offset = 2.0 / num_aug_;
+        double increment = kPI * (3.0 - sqrt(5.0));
+        double y = aug_idx * offset - 1.0 + offset / 2.0;
+        double r = sqrt(1.0 - y * y);
+        double fib_phi = fmod(aug_idx + aug.value, double(num_aug_)) * increment;
+        double x = cos(fib_phi) * r, z = sin(fib_phi) * r;
+        double theta = acos(z), phi = atan2(y, x);
+        float rot[9] = {
+          float(cos(theta) * cos(phi)), float(-sin(phi)), float(sin(theta) * cos(phi)),
+          float(cos(theta) * sin(phi)), float(cos(phi)), float(sin(theta) * sin(phi)),
+          float(-sin(theta)), 0.0f, float(cos(theta)) };
+        points.transform(rot);
+        break;
+      }
+    }
+  }
+}
+
+bool DatasetBuilder::build_octree(string& octree, const Item& item,
+    Octree& builder) const {
+  // the points are augmented in place, so they are copied instead of mapped
+  Points points;
+  if (!points.read_points(item.filename) || points.is_empty()) return false;
+
+  OctreeInfo info;
+  info.initialize(settings_.depth, settings_.full_depth,
+      settings_.node_displacement, settings_.node_feature, settings_.split_label,
+      settings_.adaptive, settings_.adaptive_depth, settings_.threshold_distance,
+      settings_.threshold_normal, settings_.key2xyz, points);
+
+  augmentor_.augment(points, item.aug_idx);
+  PointsBounds bounds = points.get_points_bounds();
+  info.set_bbox(bounds.radius, bounds.center);
+
+  builder.build(info, points);
+  octree = builder.get_binary_string();
+  return true;
+}
+
+int DatasetBuilder::build(const vector<Item>& items, Writer writer,
+    void* context, const int thread_num, const int queue_size) const {
+  const int num = items.size();
+  const int worker_num = std::max(thread_num, 1);
+  const int slot_num = queue_size > 0 ? std::max(queue_size, worker_num) : 4 * worker_num;
+
+  // the octree of the idx^th item is in the slot (idx % slot_num)
+  vector<string> octrees(slot_num);
+  vector<char> ready(slot_num, 0);
+  std::mutex mutex;
+  std::condition_variable cv_ready, cv_free;
+  int next_idx = 0, written = 0;
+  bool stop = false;
+
+  auto worker = [&]() {
+#ifdef _OPENMP
+    // the items are built in parallel, not the octree of one item
+    if (worker_num > 1) omp_set_num_threads(1);
+#endif
+    string octree;
+    Octree builder;
+    while (true) {
+      int idx = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_free.wait(lock, [&] {
+          return stop || next_idx >= num || next_idx < written + slot_num; });
+        if (stop || next_idx >= num) return;
+        idx = next_idx++;
+      }
+      if (!build_octree(octree, items[idx], builder)) octree.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        octrees[idx % slot_num].swap(octree);
+        ready[idx % slot_num] = 1;
+      }
+      cv_ready.notify_all();
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 0; i < worker_num; ++i) threads.emplace_back(worker);
+
+  int count = 0;
+  for (int idx = 0; idx < num; ++idx) {
+    const int slot = idx % slot_num;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv_ready.wait(lock, [&] { return ready[slot] != 0; });
+    }
+    // the slot is not touched by the workers until it is marked as free
+    const bool valid = !octrees[slot].empty();
+    const bool succ = writer(context, idx, items[idx], octrees[slot]);
+    if (succ && valid) count++;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      octrees[slot].clear();
+      ready[slot] = 0;
+      written = idx + 1;
+      stop = !succ;
+    }
+    cv_free.notify_all();
+    if (!succ) break;
+  }
+
+  for (auto& t : threads) t.join();
+  return count;
+}
+
+namespace {
+
+bool write_archive(void* context, const int /*idx*/,
+    const DatasetBuilder::Item& item, string& octree) {
+  if (octree.empty()) return true;  // skip the invalid points
+  char suffix[64];
+  sprintf(suffix, "_%03d.octree", item.aug_idx);
+  string name = extract_filename(item.filename) + suffix;
+  OctreeArchiveWriter* writer = static_cast<OctreeArchiveWriter*>(context);
+  return writer->add(octree.data(), octree.size(), name, item.label, item.aug_idx);
+}
+
+}  // namespace
+
+int DatasetBuilder::build_archive(const vector<Item>& items,
+    const string& archive, const int thread_num, const bool append) const {
+  OctreeArchiveWriter writer;
+  if (!writer.open(archive, append)) return 0;
+  int count = build(items, write_archive, &writer, thread_num);
+  return writer.close() ? count : 0;
+}
@@ -0,0 +1,81 @@
+#include "mapped_file.h"
+
+#if defined _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined _MSC_VER
+
+bool MappedFile::open(const string& filename) {
+  close();
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER len;
+  if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  // the mapping object keeps the file alive, so close the file handle here
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) return false;
+
+  void* addr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+  if (addr == nullptr) {
+    CloseHandle(mapping);
+    return false;
+  }
+
+  data_ = static_cast<char*>(addr);
+  size_ = static_cast<size_t>(len.QuadPart);
+  handle_ = mapping;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_ != nullptr) UnmapViewOfFile(data_);
+  if (handle_ != nullptr) CloseHandle(static_cast<HANDLE>(handle_));
+  data_ = nullptr;
+  size_ = 0;
+  handle_ = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const string& filename) {
+  close();
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  // the mapping keeps the file alive, so close the descriptor here
+  size_t len = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) return false;
+
+  data_ = static_cast<char*>(addr);
+  size_ = len;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_ != nullptr) munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
@@ -1,26 +1,78 @@
 #include "octree.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "marching_cube.h"
+#include "morton.h"
+#include "util.h"
 
 
 void Octree::build(const OctreeInfo& octree_info, const Points& point_cloud) {
+  build_pose(octree_info, point_cloud, nullptr);
+}
+
+void Octree::build_poses(vector<vector<char> >& octrees, const OctreeInfo& octree_info,
+    const Points& point_cloud, const vector<float>& rotations) {
+  const int num = rotations.size() / 9;
+  octrees.resize(num);
+
+  // If there are enough poses, parallelize across the poses: each group of
+  // poses is built by one Octree, whose memory is reused by the poses in the
+  // group. Otherwise, build the poses one by one and parallelize within them.
+  int thread_num = 1;
+#ifdef _OPENMP
+  if (!omp_in_parallel()) thread_num = omp_get_max_threads();
+#endif
+  const int group_num = num >= thread_num ? thread_num : 1;
+  vector<Octree> builders(group_num - 1);
+
+  #pragma omp parallel for if (group_num > 1)
+  for (int g = 0; g < group_num; ++g) {
+    Octree& builder = g == 0 ? *this : builders[g - 1];
+    for (int i = g; i < num; i += group_num) {
+      builder.build_pose(octree_info, point_cloud, rotations.data() + 9 * i);
+      // copy instead of swapping, so that both the buffer of the builder and
+      // the buffers of the caller keep their capacity for the next build
+      octrees[i].assign(builder.buffer_.begin(), builder.buffer_.end());
+    }
+  }
+  buffer_.clear();
+  info_ = nullptr;
+}
+
+void Octree::build_pose(const OctreeInfo& octree_info, const Points& point_cloud,
+    const float* rotation) {
   // init
   clear(octree_info.depth());
   oct_info_ = octree_info;
 
+  // rotate the normals, the other properties are invariant to the rotation
+  const float* normals = point_cloud.ptr(PtsInfo::kNormal);
+  if (rotation != nullptr && normals != nullptr) {
+    const int npt = point_cloud.info().pt_num();
+    scratch_.normals.resize(3 * npt);
+    matrix_prod(scratch_.normals.data(), rotation, normals, 3, npt, 3);
+    normals = scratch_.normals.data();
+  }
+
   // preprocess, get key and sort
-  vector<float> pts_scaled;
-  normalize_pts(pts_scaled, point_cloud);
-  vector<uint32> node_keys, sorted_idx;
+  vector<float>& pts_scaled = scratch_.pts_scaled;
+  normalize_pts(pts_scaled, point_cloud, rotation);
+  vector<uint64>& node_keys = scratch_.node_keys;
+  vector<uint32>& sorted_idx = scratch_.sorted_idx;
   sort_keys(node_keys, sorted_idx, pts_scaled);
-  vector<uint32> unique_idx;
+  vector<uint32>& unique_idx = scratch_.unique_idx;
   unique_key(node_keys, unique_idx);
 
   // build octree structure
@@ -29,72 +81,142 @@ void Octree::build(const OctreeInfo& octree_info, const Points& point_cloud) {
   // set nnum_[], nnum_cum_[], nnum_nempty_[] and ptr_dis_[]
   calc_node_num();
 
+  // write the signals into buffer_ directly if possible
+  calc_feature_channel(point_cloud, normals);
+  direct_ = alloc_buffer();
+
   // average the signal for the last octree layer
-  calc_signal(point_cloud, pts_scaled, sorted_idx, unique_idx);
+  calc_signal(point_cloud, normals, pts_scaled, sorted_idx, unique_idx);
 
   // average the signal for the octher octree layer
   if (oct_info_.locations(OctreeInfo::kFeature) == -1) {
-    covered_depth_nodes();
-
-    bool calc_norm_err = oct_info_.is_adaptive();
-    bool calc_dist_err = oct_info_.is_adaptive() && oct_info_.has_displace();
-    calc_signal(calc_norm_err, calc_dist_err);
+    if (oct_info_.is_adaptive()) {
+      covered_depth_nodes();
+
+      bool calc_norm_err = true;
+      bool calc_dist_err = oct_info_.has_displace();
+      calc_signal(calc_norm_err, calc_dist_err);
+    } else {
+      calc_signal_bottom_up();
+    }
   }
 
-  // generate split label
-  if (oct_info_.has_property(OctreeInfo::kSplit)) {
-    calc_split_label();
+  if (oct_info_.is_adaptive()) {
+    // trim_octree() updates the node numbers, generates the split label and
+    // serializes the trimmed octree, so the properties are written only once
+    trim_octree();
+  } else {
+    // generate split label
+    if (oct_info_.has_property(OctreeInfo::kSplit)) {
+      calc_split_label();
+    }
+
+    // serialization
+    serialize();
   }
+}
 
-  // serialization
-  serialize();
+// clear the contents of each layer but retain the capacity
+template <typename Dtype>
+void clear_layers(vector<vector<Dtype> >& data, const int depth) {
+  for (auto& d : data) d.clear();
+  if (depth != 0) data.resize(depth + 1);
+}
 
-  trim_octree();
+template <typename Dtype>
+void release_vector(vector<Dtype>& data) {
+  vector<Dtype>().swap(data);
 }
 
 void Octree::clear(int depth) {
-  keys_.clear();
-  children_.clear();
-  displacement_.clear();
-  split_labels_.clear();
-  avg_normals_.clear();
-  avg_features_.clear();
-  avg_fpfh_.clear();
-  avg_roughness_.clear();
-  avg_pts_.clear();
-  avg_labels_.clear();
+  // Note: the memory is retained and reused by the next build(),
+  // call release() to free it
+  clear_layers(keys_, depth);
+  clear_layers(children_, depth);
+  clear_layers(displacement_, depth);
+  clear_layers(split_labels_, depth);
+  clear_layers(avg_normals_, depth);
+  clear_layers(avg_features_, depth);
+  clear_layers(avg_fpfh_, depth);
+  clear_layers(avg_roughness_, depth);
+  clear_layers(avg_pts_, depth);
+  clear_layers(avg_labels_, depth);
   max_label_ = 0;
+  direct_ = false;
   buffer_.clear();
+  mapped_.reset();
+  info_ = nullptr;
+  clear_layers(dnum_, depth);
+  clear_layers(didx_, depth);
+  clear_layers(normal_err_, depth);
+  clear_layers(distance_err_, depth);
+}
+
+void Octree::release() {
+  release_vector(keys_);
+  release_vector(children_);
+  release_vector(displacement_);
+  release_vector(split_labels_);
+  release_vector(avg_normals_);
+  release_vector(avg_features_);
+  release_vector(avg_fpfh_);
+  release_vector(avg_roughness_);
+  release_vector(avg_pts_);
+  release_vector(avg_labels_);
+  max_label_ = 0;
+  direct_ = false;
+  release_vector(buffer_);
+  mapped_.reset();
   info_ = nullptr;
-  dnum_.clear();
-  didx_.clear();
-  normal_err_.clear();
-  distance_err_.clear();
-
-  if (depth == 0) return;
-  keys_.resize(depth + 1);
-  children_.resize(depth + 1);
-  displacement_.resize(depth + 1);
-  split_labels_.resize(depth + 1);
-  avg_normals_.resize(depth + 1);
-  avg_features_.resize(depth + 1);
-  avg_fpfh_.resize(depth+1);
-  avg_roughness_.resize(depth+1);
-  avg_pts_.resize(depth + 1);
-  avg_labels_.resize(depth + 1);
-  dnum_.resize(depth + 1);
-  didx_.resize(depth + 1);
-  normal_err_.resize(depth + 1);
-  distance_err_.resize(depth + 1);
+  release_vector(dnum_);
+  release_vector(didx_);
+  release_vector(normal_err_);
+  release_vector(distance_err_);
+
+  release_vector(scratch_.pts_scaled);
+  release_vector(scratch_.normals);
+  release_vector(scratch_.node_keys);
+  release_vector(scratch_.sorted_idx);
+  release_vector(scratch_.unique_idx);
+  release_vector(scratch_.key_buffer);
+  release_vector(scratch_.codes);
+  release_vector(scratch_.codes_buffer);
+  for (int i = 0; i < 2; ++i) {
+    release_vector(scratch_.sums[i]);
+    release_vector(scratch_.votes[i]);
+  }
+}
+
+// compute the keys of the scaled points block by block with the batched
+// Morton encoding, which gives the same keys as compute_key()
+void compute_keys(OctreeParser::uint64* keys, const float* pts_scaled,
+    const int npt, const int depth) {
+  const int kBlockSize = 256;
+  #pragma omp parallel for
+  for (int b = 0; b < npt; b += kBlockSize) {
+    const int num = std::min(kBlockSize, npt - b);
+    uint32_t pt[3 * kBlockSize];
+    for (int i = 0; i < 3 * num; ++i) {
+      pt[i] = static_cast<uint32_t>(pts_scaled[3 * b + i]);
+    }
+    morton_encode64(keys + b, pt, num, depth);
+  }
 }
 
-void Octree::normalize_pts(vector<float>& pts_scaled, const Points& point_cloud) {
+void Octree::normalize_pts(vector<float>& pts_scaled, const Points& point_cloud,
+    const float* rotation) {
   const float* bbmin = oct_info_.bbmin();
   const float* pts = point_cloud.ptr(PtsInfo::kPoint);
   const int npt = point_cloud.info().pt_num();
   const float mul = float(1 << oct_info_.depth()) / oct_info_.bbox_max_width();
   pts_scaled.resize(3 * npt);
 
+  // rotate the points, and then normalize them in place
+  if (rotation != nullptr) {
+    matrix_prod(pts_scaled.data(), rotation, pts, 3, npt, 3);
+    pts = pts_scaled.data();
+  }
+
   // normalize the points into the range [0, 1 << depth_) using bbox_width
   #pragma omp parallel for
   for (int i = 0; i < npt; i++) {
@@ -105,43 +227,67 @@ void Octree::normalize_pts(vector<float>& pts_scaled, const Points& point_cloud)
   }
 }
 
-void Octree::sort_keys(vector<uint32>& sorted_keys, vector<uint32>& sorted_idx,
+void Octree::sort_keys(vector<uint64>& sorted_keys, vector<uint32>& sorted_idx,
     const vector<float>& pts_scaled) {
-
-  // compute the code
+  // the code packs the key into the bits [shift, shift + 3 * depth_) and the
+  // point index into the lower bits, the 32-bit keys take the upper half
   int depth_ = oct_info_.depth();
   int npt = pts_scaled.size() / 3;
-  vector<uint64> code(npt);
+  const int shift = depth_ <= kMortonDepth32 ? 32 : 64 - 3 * depth_;
+  const uint64 idx_mask = (1ull << shift) - 1;
+  if (static_cast<uint64>(npt) > idx_mask + 1) {
+    // too many points to be packed with the deep keys
+    sort_keys_unpacked(sorted_keys, sorted_idx, pts_scaled);
+    return;
+  }
+
+  // compute the key, and then generate the code in place
+  vector<uint64>& code = scratch_.codes;
+  code.resize(npt);
+  compute_keys(code.data(), pts_scaled.data(), npt, depth_);
   #pragma omp parallel for
   for (int i = 0; i < npt; i++) {
-    // compute key
-    uint32 pt[3], key;
-    for (int j = 0; j < 3; ++j) {
-      pt[j] = static_cast<uint32>(pts_scaled[3 * i + j]);
-    }
-    compute_key(key, pt, depth_);
-
-    // generate code
-    uint32* ptr = reinterpret_cast<uint32*>(&code[i]);
-    ptr[0] = i;
-    ptr[1] = key;
+    code[i] = (code[i] << shift) | static_cast<uint64>(i);
   }
 
-  // sort all the code
-  std::sort(code.begin(), code.end());
+  // sort all the code: the codes are generated in the order of the point index,
+  // so a stable sort of the key bits is equivalent to sorting the whole code
+  radix_sort(code, scratch_.codes_buffer, shift, shift + 3 * depth_);
 
   // unpack the code
   sorted_keys.resize(npt);
   sorted_idx.resize(npt);
   #pragma omp parallel for
   for (int i = 0; i < npt; i++) {
-    uint32* ptr = reinterpret_cast<uint32*>(&code[i]);
-    sorted_idx[i] = ptr[0];
-    sorted_keys[i] = ptr[1];
+    sorted_idx[i] = static_cast<uint32>(code[i] & idx_mask);
+    sorted_keys[i] = code[i] >> shift;
   }
 }
 
-void Octree::build_structure(vector<uint32>& node_keys) {
+void Octree::sort_keys_unpacked(vector<uint64>& sorted_keys,
+    vector<uint32>& sorted_idx, const vector<float>& pts_scaled) {
+  int depth_ = oct_info_.depth();
+  int npt = pts_scaled.size() / 3;
+  vector<uint64>& keys = scratch_.codes;
+  keys.resize(npt);
+  compute_keys(keys.data(), pts_scaled.data(), npt, depth_);
+  sorted_idx.resize(npt);
+  #pragma omp parallel for
+  for (int i = 0; i < npt; i++) {
+    sorted_idx[i] = i;
+  }
+
+  std::stable_sort(sorted_idx.begin(), sorted_idx.end(),
+      [&keys](uint32 a, uint32 b) { return keys[a] < keys[b]; });
+
+  sorted_keys.resize(npt);
+  #pragma omp parallel for
+  for (int i = 0; i < npt; i++) {
+    sorted_keys[i] = keys[sorted_idx[i]];
+  }
+}
+
+void Octree::build_structure(vector<uint64>& node_keys) {
   const int depth_ = oct_info_.depth();
   const int full_layer_ = oct_info_.full_layer();
   children_.resize(depth_ + 1);
@@ -150,10 +296,11 @@ void Octree::build_structure(vector<uint32>& node_keys) {
   // layer 0 to full_layer_: the octree is full in these layers
   for (int curr_depth = 0; curr_depth <= full_layer_; curr_depth++) {
     vector<int>& children = children_[curr_depth];
-    vector<uint32>& keys = keys_[curr_depth];
+    vector<uint64>& keys = keys_[curr_depth];
 
     int n = 1 << 3 * curr_depth;
-    keys.resize(n, -1); children.resize(n, -1);
+    keys.resize(n); children.assign(n, -1);
+    #pragma omp parallel for
     for (int i = 0; i < n; i++) {
       keys[i] = i;
       if (curr_depth != full_layer_) {
@@ -163,48 +310,51 @@ void Octree::build_structure(vector<uint32>& node_keys) {
   }
 
   // layer depth_ to full_layer_
+  const int kBlockSize = 1 << 16;
+  vector<int> offset;
   for (int curr_depth = depth_; curr_depth > full_layer_; --curr_depth) {
-    // compute parent key, i.e. keys of layer (curr_depth -1)
+    // count the parent runs, i.e. the unique keys of layer (curr_depth - 1),
+    // starting in each block of node_keys, and compute their offsets
     int n = node_keys.size();
-    vector<uint32> parent_keys(n);
+    int nblock = (n + kBlockSize - 1) / kBlockSize;
+    offset.assign(nblock + 1, 0);
     #pragma omp parallel for
-    for (int i = 0; i < n; i++) {
-      parent_keys[i] = node_keys[i] >> 3;
+    for (int b = 0; b < nblock; ++b) {
+      int end = std::min(n, (b + 1) * kBlockSize), num = 0;
+      for (int i = b * kBlockSize; i < end; ++i) {
+        if (i == 0 || (node_keys[i] >> 3) != (node_keys[i - 1] >> 3)) num++;
+      }
+      offset[b + 1] = num;
+    }
+    for (int b = 0; b < nblock; ++b) {
+      offset[b + 1] += offset[b];
     }
 
-    // compute unique parent key
-    vector<uint32> parent_pidx;
-    unique_key(parent_keys, parent_pidx);
-
-    // augment children keys and create nodes
-    int np = parent_keys.size();
+    // allocate the nodes of this layer and the parent keys once
+    int np = offset[nblock];
     int nch = np << 3;
     vector<int>& children = children_[curr_depth];
-    vector<uint32>& keys = keys_[curr_depth];
-    children.resize(nch, -1);
-    keys.resize(nch, 0);
-
-    for (int i = 0; i < nch; i++) {
-      int j = i >> 3;
-      keys[i] = (parent_keys[j] << 3) | (i % 8);
-    }
-
-    // compute base address for each node
-    vector<uint32> addr(nch);
-    for (int i = 0; i < np; i++) {
-      for (uint32 j = parent_pidx[i]; j < parent_pidx[i + 1]; j++) {
-        addr[j] = i << 3;
-      }
-    }
-
-    // set children pointer and parent pointer
+    vector<uint64>& keys = keys_[curr_depth];
+    children.assign(nch, -1);
+    keys.resize(nch);
+    vector<uint64>& parent_keys = scratch_.key_buffer;
+    parent_keys.resize(np);
+
+    // augment children keys, create nodes and set children pointer:
+    // the j^th parent run owns the nodes [8 * j, 8 * j + 8)
     #pragma omp parallel for
-    for (int i = 0; i < n; i++) {
-      // address
-      uint32 k = (node_keys[i] & 7u) | addr[i];
-
-      // set children pointer for layer curr_depth
-      children[k] = i;
+    for (int b = 0; b < nblock; ++b) {
+      int end = std::min(n, (b + 1) * kBlockSize), j = offset[b] - 1;
+      for (int i = b * kBlockSize; i < end; ++i) {
+        uint64 parent_key = node_keys[i] >> 3;
+        if (i == 0 || parent_key != (node_keys[i - 1] >> 3)) {
+          parent_keys[++j] = parent_key;
+          for (int c = 0; c < 8; ++c) {
+            keys[(j << 3) | c] = (parent_key << 3) | c;
+          }
+        }
+        children[(j << 3) | (node_keys[i] & 7u)] = i;
+      }
     }
 
     // save data and prepare for the following iteration
@@ -214,9 +364,11 @@ void Octree::build_structure(vector<uint32>& node_keys) {
   // set the children for the layer full_layer_
   // Now the node_keys are the key for full_layer
   if (depth_ > full_layer_) {
-    for (int i = 0; i < node_keys.size(); i++) {
-      uint32 j = node_keys[i];
-      children_[full_layer_][j] = i;
+    vector<int>& children = children_[full_layer_];
+    int n = node_keys.size();
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++) {
+      children[node_keys[i]] = i;
     }
   }
 }
@@ -247,171 +399,189 @@ void Octree::calc_node_num() {
   oct_info_.set_ptr_dis(); // !!! note: call this function to update the ptr
 }
 
-// compute the average signal for the last octree layer
-void Octree::calc_signal(const Points& point_cloud, const vector<float>& pts_scaled,
-    const vector<uint32>& sorted_idx, const vector<uint32>& unique_idx) {
-  int depth = oct_info_.depth();
-  const float* normals = point_cloud.ptr(PtsInfo::kNormal);
-  const float* features = point_cloud.ptr(PtsInfo::kFeature);
-  const float* fpfh = point_cloud.ptr(PtsInfo::KFPFH);
-  const float* roughness = point_cloud.ptr(PtsInfo::KRoughness);
-  const float* labels = point_cloud.ptr(PtsInfo::kLabel);
-  const int nnum = oct_info_.nnum(depth);
-
-  const vector<int>& children = children_[depth];
-  if (normals != nullptr) {
-    const int channel = point_cloud.info().channel(PtsInfo::kNormal);
-    avg_normals_[depth].assign(channel * nnum, 0.0f);
-
-    #pragma omp parallel for
-    for (int i = 0; i < nnum; i++) {
-      int t = children[i];
-      if (node_type(t) == kLeaf) continue;
-
-      vector<float> avg_normal(channel, 0.0f);
-      for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
-        int h = sorted_idx[j];
-        for (int c = 0; c < channel; ++c) {
-          avg_normal[c] += normals[channel * h + c];
-        }
-      }
+void Octree::calc_feature_channel(const Points& point_cloud, const float* normals) {
+  const PtsInfo& pts_info = point_cloud.info();
+  auto channel = [&](PtsInfo::PropType ptype) {
+    return point_cloud.ptr(ptype) != nullptr ? pts_info.channel(ptype) : 0;
+  };
+  feature_channel_[0] = normals != nullptr ? pts_info.channel(PtsInfo::kNormal) : 0;
+  feature_channel_[1] = oct_info_.has_displace() && normals != nullptr ? 1 : 0;
+  feature_channel_[2] = channel(PtsInfo::kFeature);
+  feature_channel_[3] = channel(PtsInfo::KFPFH);
+  feature_channel_[4] = channel(PtsInfo::KRoughness);
+}
 
-      float factor = ESP;
-      for (int c = 0; c < channel; ++c) {
-        factor += avg_normal[c] * avg_normal[c];
-      }
-      factor = sqrtf(factor);
-      for (int c = 0; c < channel; ++c) {
-        avg_normals_[depth][c * nnum + i] = avg_normal[c] / factor;
-      }
+bool Octree::alloc_buffer() {
+  if (oct_info_.is_adaptive()) return false;
+  const OctreeInfo::PropType ptypes[] = { OctreeInfo::kFeature,
+    OctreeInfo::kLabel, OctreeInfo::kSplit };
+  for (auto ptype : ptypes) {
+    if (oct_info_.has_property(ptype) && oct_info_.dtype(ptype) != kFloat32) {
+      return false;
     }
   }
-
-  if (features != nullptr) {
-    const int channel = point_cloud.info().channel(PtsInfo::kFeature);
-    avg_features_[depth].assign(channel * nnum, 0.0f);
-
-    #pragma omp parallel for
-    for (int i = 0; i < nnum; i++) {
-      int t = children[i];
-      if (node_type(t) == kLeaf) continue;
-
-      vector<float> avg_feature(channel, 0.0f);
-      for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
-        int h = sorted_idx[j];
-        for (int c = 0; c < channel; ++c) {
-          avg_feature[c] += features[channel * h + c];
-        }
-      }
-
-      float factor = unique_idx[t + 1] - unique_idx[t] + ESP;
-      for (int c = 0; c < channel; ++c) {
-        avg_features_[depth][c * nnum + i] = avg_feature[c] / factor;
-      }
-    }
+  // the signals must fill up the feature slot
+  int channel = 0;
+  for (int c : feature_channel_) channel += c;
+  if (oct_info_.has_property(OctreeInfo::kFeature) &&
+      channel != oct_info_.channel(OctreeInfo::kFeature)) {
+    return false;
   }
 
-  if (fpfh != nullptr) {
-	  const int channel = point_cloud.info().channel(PtsInfo::KFPFH);
-	  avg_fpfh_[depth].assign(channel * nnum, 0.0f);
-
-#pragma omp parallel for
-	  for (int i = 0; i < nnum; i++) {
-		  int t = children[i];
-		  if (node_type(t) == kLeaf) continue;
+  // buffer_ is empty after clear(), so it is filled with 0
+  buffer_.resize(oct_info_.sizeof_octree(), 0);
+  info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
+  *info_ = oct_info_;
+  return true;
+}
 
-		  vector<float> avg_fpfh(channel, 0.0f);
-		  for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
-			  int h = sorted_idx[j];
-			  for (int c = 0; c < channel; ++c) {
-				  avg_fpfh[c] += fpfh[channel * h + c];
-			  }
-		  }
+bool Octree::in_buffer(OctreeInfo::PropType ptype, const int d) const {
+  const int location = oct_info_.locations(ptype);
+  return direct_ && oct_info_.has_property(ptype) && (location == -1 || location == d);
+}
 
-		  float factor = unique_idx[t + 1] - unique_idx[t] + ESP;
-		  for (int c = 0; c < channel; ++c) {
-			  avg_fpfh_[depth][c * nnum + i] = avg_fpfh[c] / factor;
-		  }
-	  }
+float* Octree::signal_ptr(vector<vector<float> >& signal,
+    OctreeInfo::PropType ptype, const int d, const int offset) {
+  if (in_buffer(ptype, d)) {
+    return reinterpret_cast<float*>(mutable_ptr(ptype, d)) + offset * oct_info_.nnum(d);
+  } else {
+    return signal[d].data();
   }
+}
 
-  if (roughness != nullptr) {
-	  const int channel = point_cloud.info().channel(PtsInfo::KRoughness);
-	  avg_roughness_[depth].assign(channel * nnum, 0.0f);
-
-#pragma omp parallel for
-	  for (int i = 0; i < nnum; i++) {
-		  int t = children[i];
-		  if (node_type(t) == kLeaf) continue;
-
-		  vector<float> avg_roughness(channel, 0.0f);
-		  for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
-			  int h = sorted_idx[j];
-			  for (int c = 0; c < channel; ++c) {
-				  avg_roughness[c] += roughness[channel * h + c];
-			  }
-		  }
-
-		  float factor = unique_idx[t + 1] - unique_idx[t] + ESP;
-		  for (int c = 0; c < channel; ++c) {
-			  avg_roughness_[depth][c * nnum + i] = avg_roughness[c] / factor;
-		  }
-	  }
+float* Octree::alloc_signal(vector<vector<float> >& signal,
+    OctreeInfo::PropType ptype, const int d, const int offset, const int channel,
+    const float value) {
+  const int num = channel * oct_info_.nnum(d);
+  if (in_buffer(ptype, d)) {
+    float* ptr = signal_ptr(signal, ptype, d, offset);
+    std::fill(ptr, ptr + num, value);
+    return ptr;
+  } else {
+    signal[d].assign(num, value);
+    return signal[d].data();
   }
+}
 
+// compute the average signal for the last octree layer
+void Octree::calc_signal(const Points& point_cloud, const float* normals,
+    const vector<float>& pts_scaled, const vector<uint32>& sorted_idx,
+    const vector<uint32>& unique_idx) {
+  int depth = oct_info_.depth();
+  const float* features = point_cloud.ptr(PtsInfo::kFeature);
+  const float* fpfh = point_cloud.ptr(PtsInfo::KFPFH);
+  const float* roughness = point_cloud.ptr(PtsInfo::KRoughness);
+  const float* labels = point_cloud.ptr(PtsInfo::kLabel);
+  const int nnum = oct_info_.nnum(depth);
+  const PtsInfo& pts_info = point_cloud.info();
+  const bool has_dis = feature_channel_[1] != 0;
+
+  // the channels of the properties, which are accumulated into the
+  // scratch in the order of normal, feature, fpfh, roughness and point
+  const int* ch = feature_channel_;
+  const int ch_pt = has_dis ? 3 : 0;
+  const int ch_sum = ch[0] + ch[2] + ch[3] + ch[4] + ch_pt;
+  const int ch_property[] = { ch[0], ch[2], ch[3], ch[4], ch_pt };
+  const float* src_property[] = { normals, features, fpfh, roughness, pts_scaled.data() };
+  float* des_property[5] = { nullptr };
+
+  // the offsets of the signals in the feature slot
+  const int offset[] = { 0, ch[0] + ch[1], ch[0] + ch[1] + ch[2],
+    ch[0] + ch[1] + ch[2] + ch[3] };
+  vector<vector<vector<float> >*> avg_property{ &avg_normals_, &avg_features_,
+    &avg_fpfh_, &avg_roughness_ };
+  for (int k = 0; k < 4; ++k) {
+    if (ch_property[k] == 0) continue;
+    des_property[k] = alloc_signal(*avg_property[k], OctreeInfo::kFeature,
+        depth, offset[k], ch_property[k], 0.0f);
+  }
+  if (has_dis) {
+    avg_pts_[depth].assign(ch_pt * nnum, 0.0f);
+    des_property[4] = avg_pts_[depth].data();
+  }
+  float* displacement = nullptr, *avg_labels = nullptr;
+  if (has_dis) {
+    displacement = alloc_signal(displacement_, OctreeInfo::kFeature, depth,
+        ch[0], 1, 0.0f);
+  }
   if (labels != nullptr) {
-    // the channel of label is fixed as 1
-    avg_labels_[depth].assign(nnum, -1.0f);   // initialize as -1
-    const int npt = point_cloud.info().pt_num();
+    // the channel of label is fixed as 1, initialize as -1
+    avg_labels = alloc_signal(avg_labels_, OctreeInfo::kLabel, depth, 0, 1, -1.0f);
+    const int npt = pts_info.pt_num();
     max_label_ = static_cast<int>(*std::max_element(labels, labels + npt)) + 1;
+  }
 
-    #pragma omp parallel for
-    for (int i = 0; i < nnum; i++) {
+  // visit each point once and accumulate all the properties of it, the
+  // scratch is allocated once per block of nodes instead of once per node
+  const vector<int>& children = children_[depth];
+  const int kBlockSize = 4096;
+  const int nblock = (nnum + kBlockSize - 1) / kBlockSize;
+  #pragma omp parallel for
+  for (int b = 0; b < nblock; ++b) {
+    vector<float> avg(ch_sum);
+    vector<int> avg_label(labels != nullptr ? max_label_ : 0);
+    int end = std::min(nnum, (b + 1) * kBlockSize);
+    for (int i = b * kBlockSize; i < end; i++) {
       int t = children[i];
       if (node_type(t) == kLeaf) continue;
 
-      vector<int> avg_label(max_label_, 0);
+      std::fill(avg.begin(), avg.end(), 0.0f);
+      std::fill(avg_label.begin(), avg_label.end(), 0);
       for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
         int h = sorted_idx[j];
-        avg_label[static_cast<int>(labels[h])] += 1;
+        float* avg_k = avg.data();
+        for (int k = 0; k < 5; ++k) {
+          const int channel = ch_property[k];
+          const float* src = src_property[k] + channel * h;
+          for (int c = 0; c < channel; ++c) {
+            avg_k[c] += src[c];
+          }
+          avg_k += channel;
+        }
+        if (labels != nullptr) {
+          avg_label[static_cast<int>(labels[h])] += 1;
+        }
       }
 
-      avg_labels_[depth][i] = static_cast<float>(std::distance(avg_label.begin(),
-                  std::max_element(avg_label.begin(), avg_label.end())));
-    }
-  }
-
-  if (oct_info_.has_displace() && normals != nullptr) {
-    const int channel = 3;
-    const float mul = 1.1547f; // = 2.0f / sqrt(3.0f)
-    avg_pts_[depth].assign(nnum * channel, 0.0f);
-    displacement_[depth].assign(nnum, 0.0f);
-
-    #pragma omp parallel for
-    for (int i = 0; i < nnum; i++) {
-      int t = children[i];
-      if (node_type(t) == kLeaf) continue;
-
-      float avg_pt[3] = { 0.0f, 0.0f, 0.0f };
-      for (uint32 j = unique_idx[t]; j < unique_idx[t + 1]; j++) {
-        int h = sorted_idx[j];
-        for (int c = 0; c < 3; ++c) {
-          avg_pt[c] += pts_scaled[3 * h + c];
+      // normal: normalize
+      const float* avg_k = avg.data();
+      if (ch[0] != 0) {
+        float factor = ESP;
+        for (int c = 0; c < ch[0]; ++c) {
+          factor += avg_k[c] * avg_k[c];
+        }
+        factor = sqrtf(factor);
+        for (int c = 0; c < ch[0]; ++c) {
+          des_property[0][c * nnum + i] = avg_k[c] / factor;
         }
       }
+      avg_k += ch[0];
 
-      float dis = 0.0f;
+      // feature, fpfh, roughness and point: average
       float factor = unique_idx[t + 1] - unique_idx[t] + ESP;
-      for (int c = 0; c < 3; ++c) {
-        avg_pt[c] /= factor;
+      for (int k = 1; k < 5; ++k) {
+        const int channel = ch_property[k];
+        for (int c = 0; c < channel; ++c) {
+          des_property[k][c * nnum + i] = avg_k[c] / factor;
+        }
+        avg_k += channel;
+      }
 
-        float fract_part = 0.0f, int_part = 0.0f;
-        fract_part = std::modf(avg_pt[c], &int_part);
-        dis += (fract_part - 0.5f) * avg_normals_[depth][c * nnum + i];
+      if (labels != nullptr) {
+        avg_labels[i] = static_cast<float>(std::distance(avg_label.begin(),
+                    std::max_element(avg_label.begin(), avg_label.end())));
+      }
 
-        avg_pts_[depth][c * nnum + i] = avg_pt[c];
+      if (has_dis) {
+        const float mul = 1.1547f; // = 2.0f / sqrt(3.0f)
+        float dis = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+          float fract_part = 0.0f, int_part = 0.0f;
+          fract_part = std::modf(des_property[4][c * nnum + i], &int_part);
+          dis += (fract_part - 0.5f) * des_property[0][c * nnum + i];
+        }
+        displacement[i] = dis * mul; // !!! note the *mul* !!!
       }
-      displacement_[depth][i] = dis * mul; // !!! note the *mul* !!!
     }
   }
 }
@@ -451,7 +621,7 @@ void Octree::calc_signal(const bool calc_normal_err, const bool calc_dist_err) {
     const vector<int>& dnum_d = dnum_[d];
     const vector<int>& didx_d = didx_[d];
     const vector<int>& children_d = children_[d];
-    const vector<uint32>& key_d = keys_[d];
+    const vector<uint64>& key_d = keys_[d];
     const float scale = static_cast<float>(1 << (depth - d));
 
     vector<float>& normal_d = avg_normals_[d];
@@ -610,7 +780,7 @@ void Octree::calc_signal(const bool calc_normal_err, const bool calc_dist_err) {
           for (int c = 0; c < 3; ++c) {
             dis += (pt_depth[c * nnum_depth + j] - pt_avg1[c]) * n_avg[c];
           }
-          dis = abs(dis);
+          dis = std::abs(dis);
           if (dis > distance_max1) distance_max1 = dis;
         }
 
@@ -644,6 +814,154 @@ void Octree::calc_signal(const bool calc_normal_err, const bool calc_dist_err) {
   }
 }
 
+void Octree::calc_signal_bottom_up() {
+  const int depth = oct_info_.depth();
+  const int nnum_depth = oct_info_.nnum(depth);
+  const float imul = 2.0f / sqrtf(3.0f);
+
+  // The sums over the covered non-empty nodes of the finest layer are carried
+  // upward: the sums of a node are the sums of its 8 children. Per node, the
+  // sums are stored contiguously in the order of normal, point, feature, fpfh,
+  // roughness and count, and the label votes are stored in another array.
+  const int kPropNum = 5, kNormal = 0, kPt = 1;
+  const int* fch = feature_channel_;
+  const bool has_dis = fch[1] != 0;
+  const int ch[kPropNum] = { fch[0], has_dis ? 3 : 0, fch[2], fch[3], fch[4] };
+  int ch_sum = 1; // the last one is the count
+  for (int k = 0; k < kPropNum; ++k) ch_sum += ch[k];
+  // the point is not serialized, and the others are in the feature slot
+  vector<vector<vector<float> >*> signal{ &avg_normals_, &avg_pts_, &avg_features_,
+    &avg_fpfh_, &avg_roughness_ };
+  const int offset[kPropNum] = { 0, 0, fch[0] + fch[1], fch[0] + fch[1] + fch[2],
+    fch[0] + fch[1] + fch[2] + fch[3] };
+  const float* signal_depth[kPropNum] = { nullptr };
+  for (int k = 0; k < kPropNum; ++k) {
+    if (ch[k] == 0) continue;
+    signal_depth[k] = k == kPt ? avg_pts_[depth].data() :
+        signal_ptr(*signal[k], OctreeInfo::kFeature, depth, offset[k]);
+  }
+  // max_label_ is set by calc_signal() of the finest layer if there are labels
+  const bool has_label = max_label_ > 0;
+  const int ch_label = has_label ? max_label_ : 0;
+  const float* label_depth = has_label ?
+      signal_ptr(avg_labels_, OctreeInfo::kLabel, depth, 0) : nullptr;
+
+  // init the sums with the finest layer
+  vector<float>& sum_child = scratch_.sums[0], &sum_d = scratch_.sums[1];
+  vector<int>& vote_child = scratch_.votes[0], &vote_d = scratch_.votes[1];
+  sum_child.assign(nnum_depth * ch_sum, 0.0f);
+  vote_child.assign(nnum_depth * ch_label, 0);
+  const vector<int>& children_depth = children_[depth];
+  #pragma omp parallel for
+  for (int i = 0; i < nnum_depth; ++i) {
+    if (node_type(children_depth[i]) == kLeaf) continue;
+    float* sum_i = sum_child.data() + i * ch_sum;
+    for (int k = 0; k < kPropNum; ++k) {
+      const float* src = signal_depth[k];
+      for (int c = 0; c < ch[k]; ++c) {
+        *sum_i++ = src[c * nnum_depth + i];
+      }
+    }
+    *sum_i = 1.0f;
+    if (has_label) {
+      vote_child[i * ch_label + static_cast<int>(label_depth[i])] = 1;
+    }
+  }
+
+  for (int d = depth - 1; d >= 0; --d) {
+    const vector<int>& children_d = children_[d];
+    const vector<uint64>& key_d = keys_[d];
+    const float scale = static_cast<float>(1 << (depth - d));
+    const int nnum_d = oct_info_.nnum(d);
+
+    float* signal_d[kPropNum] = { nullptr };
+    for (int k = 0; k < kPropNum; ++k) {
+      if (ch[k] == 0) continue;
+      if (k == kPt) {
+        avg_pts_[d].assign(nnum_d * ch[k], 0.0f);
+        signal_d[k] = avg_pts_[d].data();
+      } else {
+        signal_d[k] = alloc_signal(*signal[k], OctreeInfo::kFeature, d,
+            offset[k], ch[k], 0.0f);
+      }
+    }
+    float* label_d = nullptr, *displacement_d = nullptr;
+    if (has_label) {  // !!! init as -1
+      label_d = alloc_signal(avg_labels_, OctreeInfo::kLabel, d, 0, 1, -1.0f);
+    }
+    if (has_dis) {
+      displacement_d = alloc_signal(displacement_, OctreeInfo::kFeature, d,
+          fch[0], 1, 0.0f);
+    }
+    sum_d.assign(nnum_d * ch_sum, 0.0f);
+    vote_d.assign(nnum_d * ch_label, 0);
+
+    #pragma omp parallel for
+    for (int i = 0; i < nnum_d; ++i) {
+      int t = children_d[i];
+      if (node_type(t) == kLeaf) continue;
+
+      // sum up the 8 children
+      float* sum_i = sum_d.data() + i * ch_sum;
+      for (int j = 0; j < 8; ++j) {
+        const float* sum_j = sum_child.data() + (t * 8 + j) * ch_sum;
+        for (int c = 0; c < ch_sum; ++c) sum_i[c] += sum_j[c];
+      }
+      int* vote_i = vote_d.data() + i * ch_label;
+      for (int j = 0; j < 8; ++j) {
+        const int* vote_j = vote_child.data() + (t * 8 + j) * ch_label;
+        for (int c = 0; c < ch_label; ++c) vote_i[c] += vote_j[c];
+      }
+
+      // output
+      float n_avg[3] = { 0.0f, 0.0f, 0.0f }, pt_avg[3] = { 0.0f, 0.0f, 0.0f };
+      const float count = ESP + sum_i[ch_sum - 1];
+      const float* sum_k = sum_i;
+      for (int k = 0; k < kPropNum; ++k) {
+        float* signal = signal_d[k];
+        if (k == kNormal) {
+          float len = ESP;
+          for (int c = 0; c < ch[k]; ++c) len += sum_k[c] * sum_k[c];
+          len = sqrtf(len);
+          for (int c = 0; c < ch[k]; ++c) {
+            signal[c * nnum_d + i] = sum_k[c] / len;
+            if (c < 3) n_avg[c] = signal[c * nnum_d + i];
+          }
+        } else if (k == kPt) {
+          for (int c = 0; c < ch[k]; ++c) {
+            signal[c * nnum_d + i] = sum_k[c] / (count * scale); // !!! note the scale
+            if (c < 3) pt_avg[c] = signal[c * nnum_d + i];
+          }
+        } else {
+          for (int c = 0; c < ch[k]; ++c) {
+            signal[c * nnum_d + i] = sum_k[c] / count;
+          }
+        }
+        sum_k += ch[k];
+      }
+
+      if (has_label) {
+        label_d[i] = static_cast<float>(
+            std::max_element(vote_i, vote_i + ch_label) - vote_i);
+      }
+
+      if (has_dis) {
+        uint32 pt_base[3];
+        compute_pt(pt_base, key_d[i], d);
+        float dis_avg = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+          float fract_part = pt_avg[c] - static_cast<float>(pt_base[c]);
+          dis_avg += (fract_part - 0.5f) * n_avg[c];
+        }
+        displacement_d[i] = dis_avg * imul; // IMPORTANT: RESCALE
+      }
+    }
+
+    sum_child.swap(sum_d);
+    vote_child.swap(vote_d);
+  }
+}
+
 bool Octree::save(const std::string& filename)
 {
     std::ofstream outfile(filename, std::ios::binary);
@@ -675,10 +993,11 @@ void Octree::save(std::ostream& stream) {
   std::vector<int> key(total_node_num), children(total_node_num);
   int idx = 0;
   for (int d = 0; d <= depth_; ++d) {
-    vector<uint32>& keys = keys_[d];
+    vector<uint64>& keys = keys_[d];
     for (int i = 0; i < keys.size(); ++i) {
       // calc point
-      uint32 k = keys[i], pt[3];
+      uint32 pt[3];
+      uint64 k = keys[i];
       compute_pt(pt, k, d);
 
       // compress
@@ -733,39 +1052,69 @@ void Octree::save(std::ostream& stream) {
 //  }
 //}
 
-void Octree::unique_key(vector<uint32>& keys, vector<uint32>& idx) {
-  idx.clear();
-  idx.push_back(0);
+void Octree::unique_key(vector<uint64>& keys, vector<uint32>& idx) {
+  // flag - prefix sum - scatter: each block counts the first occurrences of
+  // the keys in its range, then writes them to the precomputed offsets
+  const int kBlockSize = 1 << 16;
+  const int n = keys.size();
+  if (n == 0) {
+    // keep the result of the serial scan: one zero key spanning [0, 0)
+    keys.assign(1, 0);
+    idx.assign(2, 0);
+    return;
+  }
+  const int nblock = (n + kBlockSize - 1) / kBlockSize;
+  vector<int> offset(nblock + 1, 0);
 
-  int n = keys.size(), j = 1;
-  for (int i = 1; i < n; i++) {
-    if (keys[i] != keys[i - 1]) {
-      idx.push_back(i);
-      keys[j++] = keys[i];
+  #pragma omp parallel for
+  for (int b = 0; b < nblock; ++b) {
+    int end = std::min(n, (b + 1) * kBlockSize), num = 0;
+    for (int i = b * kBlockSize; i < end; ++i) {
+      if (i == 0 || keys[i] != keys[i - 1]) num++;
     }
+    offset[b + 1] = num;
+  }
+  for (int b = 0; b < nblock; ++b) {
+    offset[b + 1] += offset[b];
   }
 
-  keys.resize(j);
-  idx.push_back(n);
+  const int m = offset[nblock];
+  vector<uint64>& unique_keys = scratch_.key_buffer;
+  unique_keys.resize(m);
+  idx.resize(m + 1);
+  #pragma omp parallel for
+  for (int b = 0; b < nblock; ++b) {
+    int end = std::min(n, (b + 1) * kBlockSize), j = offset[b];
+    for (int i = b * kBlockSize; i < end; ++i) {
+      if (i == 0 || keys[i] != keys[i - 1]) {
+        idx[j] = i;
+        unique_keys[j++] = keys[i];
+      }
+    }
+  }
+  idx[m] = n;
+  keys.swap(unique_keys);
 }
 
 
 void Octree::serialize() {
+  // the feature is the concatenation of avg_normals_, displacement_,
+  // avg_features_, avg_fpfh_ and avg_roughness_
+  const vector<const vector<vector<float> >*> labels{ &avg_labels_ };
+  const vector<const vector<vector<float> >*> splits{ &split_labels_ };
+  const vector<const vector<vector<float> >*> features{ &avg_normals_,
+      &displacement_, &avg_features_, &avg_fpfh_, &avg_roughness_ };
+  // the dtype may change, so it is decided before the layout is computed
+  bool changed = calc_data_scale(OctreeInfo::kLabel, labels);
+  changed = calc_data_scale(OctreeInfo::kSplit, splits) || changed;
+  changed = calc_data_scale(OctreeInfo::kFeature, features) || changed;
+  if (changed) oct_info_.set_ptr_dis();
+
   const int sz = oct_info_.sizeof_octree();
   buffer_.resize(sz, 0);
   info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
   *info_ = oct_info_;
 
-  // concatenate the avg_normals_, avg_features_,avg_fpfh_,avg_roughness_ and displacement_ into features
-  const int depth = oct_info_.depth();
-  vector<vector<float> > features = avg_normals_;
-  for (int d = 0; d <= depth; ++d) {
-    features[d].insert(features[d].end(), displacement_[d].begin(), displacement_[d].end());
-    features[d].insert(features[d].end(), avg_features_[d].begin(), avg_features_[d].end());
-	features[d].insert(features[d].end(), avg_fpfh_[d].begin(), avg_fpfh_[d].end());
-	features[d].insert(features[d].end(), avg_roughness_[d].begin(), avg_roughness_[d].end());
-  }
-
 #define SERIALIZE_PROPERTY(Dtype, Ptype, Var)                                 \
   if (oct_info_.has_property(Ptype)) {                                        \
     Dtype* ptr = reinterpret_cast<Dtype*>(mutable_ptr(Ptype, 0));             \
@@ -773,20 +1122,111 @@ void Octree::serialize() {
   }                                                                           \
 
   if (oct_info_.key2xyz()) {
-    vector<vector<uint32> > xyz;
-    key_to_xyz(xyz);
-    SERIALIZE_PROPERTY(uint32, OctreeInfo::kKey, xyz);
-  } else {
+    if (oct_info_.has_property(OctreeInfo::kKey)) key_to_xyz(mutable_key(0));
+  } else if (oct_info_.channel(OctreeInfo::kKey) == 1) {
     SERIALIZE_PROPERTY(uint32, OctreeInfo::kKey, keys_);
+  } else {
+    SERIALIZE_PROPERTY(uint64, OctreeInfo::kKey, keys_);
   }
   SERIALIZE_PROPERTY(int, OctreeInfo::kChild, children_);
-  SERIALIZE_PROPERTY(float, OctreeInfo::kFeature, features);
-  SERIALIZE_PROPERTY(float, OctreeInfo::kLabel, avg_labels_);
-  SERIALIZE_PROPERTY(float, OctreeInfo::kSplit, split_labels_);
+  if (!direct_) {
+    serialize_data(OctreeInfo::kLabel, labels);
+    serialize_data(OctreeInfo::kSplit, splits);
+    serialize_data(OctreeInfo::kFeature, features);
+  }
+}
+
+bool Octree::calc_data_scale(OctreeInfo::PropType ptype,
+    const vector<const vector<vector<float> >*>& signals) {
+  if (!oct_info_.has_property(ptype)) return false;
+  const int location = oct_info_.locations(ptype);
+  const int depth_start = location == -1 ? 0 : location;
+  const int depth_end = location == -1 ? oct_info_.depth() : location;
+  const float offset = oct_info_.offset(ptype);
+
+  // compute the scale of the integer types if it is not given, the values
+  // are kept exact if they are small integers, e.g. the labels
+  const DataType dtype = oct_info_.dtype(ptype);
+  if ((dtype == kInt8 || dtype == kInt16) && oct_info_.scale(ptype) == 0) {
+    const float qmax = static_cast<float>(dtype_max(dtype));
+    vector<float> max_abs(oct_info_.channel(ptype), 0);
+    bool integral = true;
+    for (int d = depth_start; d <= depth_end; ++d) {
+      const int nnum = oct_info_.nnum(d);
+      int c0 = 0;
+      for (auto signal : signals) {
+        const vector<float>& data = (*signal)[d];
+        for (int j = 0; j < data.size(); ++j) {
+          float v = data[j] - offset;
+          float& m = max_abs[c0 + j / nnum];
+          m = std::max(m, std::abs(v));
+          integral = integral && v == std::floor(v);
+        }
+        if (nnum != 0) c0 += data.size() / nnum;
+      }
+    }
+
+    // one scale is shared by all the channels, so the channels with a much
+    // smaller range would keep only a few levels; fp16 is used instead
+    const float kMaxChannelRatio = 4.0f;
+    float max_all = 0, min_all = std::numeric_limits<float>::max();
+    for (float m : max_abs) {
+      if (m == 0) continue;   // the channels that are all zero
+      max_all = std::max(max_all, m);
+      min_all = std::min(min_all, m);
+    }
+    if (!(integral && max_all <= qmax) && max_all > kMaxChannelRatio * min_all) {
+      oct_info_.set_dtype(ptype, kFloat16);
+      return sizeof_dtype(dtype) != sizeof_dtype(kFloat16);
+    }
+    float scale = integral && max_all <= qmax ? 1.0f : max_all / qmax;
+    if (scale == 0) scale = 1.0f;
+    oct_info_.set_dtype(ptype, dtype, scale, offset);
+  }
+  return false;
+}
+
+void Octree::serialize_data(OctreeInfo::PropType ptype,
+    const vector<const vector<vector<float> >*>& signals) {
+  if (!oct_info_.has_property(ptype)) return;
+  const int location = oct_info_.locations(ptype);
+  const int depth_start = location == -1 ? 0 : location;
+  const int depth_end = location == -1 ? oct_info_.depth() : location;
+  const DataType dtype = oct_info_.dtype(ptype);
+  const float offset = oct_info_.offset(ptype);
+
+  // the levels are written in parallel, so the signals of a level must fill
+  // up its slot exactly, or they would overrun the slot of the next level
+  const int channel = oct_info_.channel(ptype);
+  for (int d = depth_start; d <= depth_end; ++d) {
+    size_t size = 0;
+    for (auto signal : signals) size += (*signal)[d].size();
+    assert(size == static_cast<size_t>(oct_info_.nnum(d)) * channel &&
+        "the signal sizes do not match the slot of the property");
+  }
+
+  // each signal is written into its slot directly if the dtype is float,
+  // instead of being concatenated first
+  const float scale = oct_info_.scale(ptype);
+  #pragma omp parallel for
+  for (int d = depth_start; d <= depth_end; ++d) {
+    if (dtype == kFloat32) {
+      float* des = reinterpret_cast<float*>(mutable_ptr(ptype, d));
+      for (auto signal : signals) {
+        des = std::copy((*signal)[d].begin(), (*signal)[d].end(), des);
+      }
+    } else {
+      vector<float> buf;
+      for (auto signal : signals) {
+        buf.insert(buf.end(), (*signal)[d].begin(), (*signal)[d].end());
+      }
+      quantize(mutable_ptr(ptype, d), buf.data(), buf.size(), dtype, scale, offset);
+    }
+  }
 }
 
-template<typename Dtype>
-void Octree::serialize(Dtype* des, const vector<vector<Dtype> >& src, const int location) {
+template<typename Dtype, typename Stype>
+void Octree::serialize(Dtype* des, const vector<vector<Stype> >& src, const int location) {
   if (location == -1) {
     for (int d = 0; d <= oct_info_.depth(); ++d) {
       des = std::copy(src[d].begin(), src[d].end(), des);
@@ -921,40 +1361,35 @@ void Octree::trim_octree() {
     int nnum_d = oct_info_.nnum(d);
     const vector<TrimType>& drop_d = drop[d];
 
-    vector<uint32> key;
+    // the indices of the retained nodes
+    vector<int> kept;
+    kept.reserve(nnum_d);
     for (int i = 0; i < nnum_d; ++i) {
-      if (drop_d[i] == kDrop) continue;
-      key.push_back(keys_[d][i]);
+      if (drop_d[i] != kDrop) kept.push_back(i);
     }
-    keys_[d].swap(key);
-
-    vector<int> children;
-    for (int i = 0, id = 0; i < nnum_d; ++i) {
-      if (drop_d[i] == kDrop) continue;
-      int ch = (drop_d[i] == kKeep && node_type(children_[d][i]) != kLeaf) ? id++ : -1;
-      children.push_back(ch);
+    const int num = kept.size();
+
+    // Compact the properties in place: the k^th retained node is moved from
+    // c * nnum_d + kept[k] to c * num + k, and since k <= kept[k] and
+    // num <= nnum_d, a source is never overwritten before it is read.
+    vector<int>& children = children_[d];
+    for (int k = 0, id = 0; k < num; ++k) {
+      int i = kept[k];
+      keys_[d][k] = keys_[d][i];
+      children[k] = (drop_d[i] == kKeep && node_type(children[i]) != kLeaf) ? id++ : -1;
     }
-    children_[d].swap(children);
+    keys_[d].resize(num);
+    children.resize(num);
 
     auto trim_data = [&](vector<float>& signal) {
-      vector<float> data;
       int channel = signal.size() / nnum_d;
       if (channel == 0) return;
-      for (int i = 0; i < nnum_d; ++i) {
-        if (drop_d[i] == kDrop) continue;
-        for (int c = 0; c < channel; ++c) {
-          data.push_back(signal[c * nnum_d + i]);
-        }
-      }
-      //signal.swap(data);
-      // transpose
-      int num = data.size() / channel;
-      signal.resize(data.size());
-      for (int i = 0; i < num; ++i) {
-        for (int c = 0; c < channel; ++c) {
-          signal[c * num + i] = data[i * channel + c];
+      for (int c = 0; c < channel; ++c) {
+        for (int k = 0; k < num; ++k) {
+          signal[c * num + k] = signal[c * nnum_d + kept[k]];
         }
       }
+      signal.resize(channel * num);
     };
 
     trim_data(displacement_[d]);
@@ -977,27 +1412,33 @@ void Octree::trim_octree() {
   serialize();
 }
 
-void Octree::key_to_xyz(vector<vector<uint32> >& xyz) {
+void Octree::key_to_xyz(uint32* xyz) {
   const int depth = oct_info_.depth();
   const int channel = oct_info_.channel(OctreeInfo::kKey);
-  xyz.resize(depth + 1);
   for (int d = 0; d <= depth; ++d) {
-    int nnum = oct_info_.nnum(d);
-    xyz[d].resize(nnum * channel, 0);
-    uint32* xyz_d = xyz[d].data();
-    for (int i = 0; i < nnum; ++i) {
-      uint32 pt[3] = { 0, 0, 0 };
-      compute_pt(pt, keys_[d][i], d);
-
-      if (channel == 1) {
-        unsigned char* ptr = reinterpret_cast<unsigned char*>(xyz_d + i);
-        for (int c = 0; c < 3; ++c) {
-          ptr[c] = static_cast<unsigned char>(pt[c]);
-        }
-      } else {
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(xyz_d + 2 * i);
-        for (int c = 0; c < 3; ++c) {
-          ptr[c] = static_cast<unsigned short>(pt[c]);
+    const int nnum = oct_info_.nnum(d);
+    uint32* xyz_d = xyz + oct_info_.nnum_cum(d) * channel;
+    const uint64* key_d = keys_[d].data();
+    // decode the keys block by block with the batched Morton decoding
+    const int kBlockSize = 256;
+    #pragma omp parallel for
+    for (int b = 0; b < nnum; b += kBlockSize) {
+      const int num = std::min(kBlockSize, nnum - b);
+      uint32_t pt[3 * kBlockSize];
+      morton_decode64(pt, key_d + b, num, d);
+
+      for (int i = b; i < b + num; ++i) {
+        const uint32_t* pt_i = pt + 3 * (i - b);
+        if (channel == 1) {
+          unsigned char* ptr = reinterpret_cast<unsigned char*>(xyz_d + i);
+          for (int c = 0; c < 3; ++c) {
+            ptr[c] = static_cast<unsigned char>(pt_i[c]);
+          }
+        } else {
+          unsigned short* ptr = reinterpret_cast<unsigned short*>(xyz_d + 2 * i);
+          for (int c = 0; c < 3; ++c) {
+            ptr[c] = static_cast<unsigned short>(pt_i[c]);
+          }
         }
       }
     }
@@ -1011,14 +1452,15 @@ void Octree::calc_split_label() {
 
   for (int d = 0; d <= depth; ++d) {
     int nnum_d = oct_info_.nnum(d);
-    split_labels_[d].assign(nnum_d, 1);       // initialize as 1 (non-empty, split)
+    // initialize as 1 (non-empty, split)
+    float* split_d = alloc_signal(split_labels_, OctreeInfo::kSplit, d, 0, 1, 1.0f);
     for (int i = 0; i < nnum_d; ++i) {
       if (node_type(children_[d][i]) == kLeaf) {
-        split_labels_[d][i] = 0;              // empty node
+        split_d[i] = 0;                       // empty node
         if (adaptive) {
-          float t = abs(avg_normals_[d][i]) + abs(avg_normals_[d][nnum_d + i]) +
-              abs(avg_normals_[d][2 * nnum_d + i]);
-          if (t != 0) split_labels_[d][i] = 2; // surface-well-approximated
+          float t = std::abs(avg_normals_[d][i]) + std::abs(avg_normals_[d][nnum_d + i]) +
+              std::abs(avg_normals_[d][2 * nnum_d + i]);
+          if (t != 0) split_d[i] = 2;         // surface-well-approximated
         }
       }
     }
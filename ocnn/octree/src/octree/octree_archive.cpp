@@ -0,0 +1,164 @@
+#include "octree_archive.h"
+
+#include <cstring>
+
+const char kArchiveMagicStr[16] = "_OCTREE_PK_1.0_";
+
+namespace {
+
+uint64_t align8(const uint64_t sz) { return (sz + 7) & ~uint64_t(7); }
+
+// check the header of the archive of sz bytes
+bool check_header(const ArchiveHeader& header, const uint64_t sz) {
+  if (sz < sizeof(ArchiveHeader)) return false;
+  if (memcmp(header.magic, kArchiveMagicStr, sizeof(kArchiveMagicStr)) != 0) return false;
+  uint64_t index_sz = uint64_t(header.num) * sizeof(ArchiveEntry);
+  return header.num >= 0 && header.index_offset >= sizeof(ArchiveHeader) &&
+      header.index_offset + index_sz <= sz;
+}
+
+// check that the entries lie before the index and their names in the table
+bool check_entries(const ArchiveHeader& header, const vector<ArchiveEntry>& entries,
+    const uint64_t names_sz) {
+  for (const ArchiveEntry& e : entries) {
+    if (e.offset + e.size > header.index_offset || e.name_pos < 0 ||
+        e.name_len < 0 || uint64_t(e.name_pos) + e.name_len > names_sz) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// read the header and the index of the archive, data holds at least sz bytes
+bool parse_index(ArchiveHeader& header, vector<ArchiveEntry>& entries,
+    const char* data, const uint64_t sz) {
+  if (sz < sizeof(ArchiveHeader)) return false;
+  memcpy(&header, data, sizeof(ArchiveHeader));
+  if (!check_header(header, sz)) return false;
+  uint64_t index_sz = uint64_t(header.num) * sizeof(ArchiveEntry);
+  entries.resize(header.num);
+  if (header.num > 0) memcpy(entries.data(), data + header.index_offset, index_sz);
+  return check_entries(header, entries, sz - header.index_offset - index_sz);
+}
+
+}  // namespace
+
+bool OctreeArchiveWriter::open(const string& filename, const bool append) {
+  close();
+  entries_.clear();
+  names_.clear();
+  offset_ = sizeof(ArchiveHeader);
+
+  if (append) {
+    // load the index of the existing archive, the new octrees are written
+    // after the end of the file, so that the old index stays valid until the
+    // new index and header are written; only the header, the index and the
+    // names are read
+    std::ifstream infile(filename, std::ios::binary);
+    if (infile) {
+      infile.seekg(0, infile.end);
+      uint64_t len = infile.tellg();
+      if (len > 0) {
+        // refuse to overwrite a file which is not an archive
+        ArchiveHeader header;
+        infile.seekg(0, infile.beg);
+        infile.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!infile || !check_header(header, len)) return false;
+        uint64_t index_sz = uint64_t(header.num) * sizeof(ArchiveEntry);
+        entries_.resize(header.num);
+        names_.resize(len - header.index_offset - index_sz);
+        infile.seekg(header.index_offset);
+        infile.read(reinterpret_cast<char*>(entries_.data()), index_sz);
+        infile.read(&names_[0], names_.size());
+        if (!infile || !check_entries(header, entries_, names_.size())) {
+          entries_.clear();
+          names_.clear();
+          return false;
+        }
+        offset_ = align8(len);
+        infile.close();
+        outfile_.open(filename, std::ios::binary | std::ios::in | std::ios::out);
+        return outfile_.is_open();
+      }
+    }
+  }
+
+  outfile_.open(filename, std::ios::binary | std::ios::trunc);
+  if (!outfile_) return false;
+  // a placeholder of the header
+  ArchiveHeader header;
+  memset(&header, 0, sizeof(header));
+  outfile_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return !outfile_.fail();
+}
+
+bool OctreeArchiveWriter::add(const char* data, const size_t sz,
+    const string& name, const int label, const int pose) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!outfile_.is_open()) return false;
+
+  ArchiveEntry entry;
+  entry.offset = offset_;
+  entry.size = sz;
+  entry.label = label;
+  entry.pose = pose;
+  entry.name_pos = static_cast<int>(names_.size());
+  entry.name_len = static_cast<int>(name.size());
+
+  const char zeros[8] = { 0 };
+  outfile_.seekp(offset_);
+  outfile_.write(data, sz);
+  outfile_.write(zeros, align8(sz) - sz);
+  if (outfile_.fail()) return false;
+
+  offset_ += align8(sz);
+  entries_.push_back(entry);
+  names_ += name;
+  return true;
+}
+
+bool OctreeArchiveWriter::close() {
+  if (!outfile_.is_open()) return true;
+
+  ArchiveHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kArchiveMagicStr, sizeof(kArchiveMagicStr));
+  header.index_offset = offset_;
+  header.num = static_cast<int>(entries_.size());
+
+  outfile_.seekp(offset_);
+  outfile_.write(reinterpret_cast<const char*>(entries_.data()),
+      entries_.size() * sizeof(ArchiveEntry));
+  outfile_.write(names_.data(), names_.size());
+  outfile_.seekp(0);
+  outfile_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  bool succ = !outfile_.fail();
+  outfile_.close();
+  return succ;
+}
+
+bool OctreeArchive::open(const string& filename) {
+  close();
+  std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+  if (!mapped->open(filename)) return false;
+
+  ArchiveHeader header;
+  if (!parse_index(header, entries_, mapped->data(), mapped->size())) {
+    entries_.clear();
+    return false;
+  }
+  mapped_ = mapped;
+  names_ = mapped_->data() + header.index_offset +
+      uint64_t(header.num) * sizeof(ArchiveEntry);
+  return true;
+}
+
+void OctreeArchive::close() {
+  mapped_.reset();
+  entries_.clear();
+  names_ = nullptr;
+}
+
+string OctreeArchive::name(const int i) const {
+  return string(names_ + entries_[i].name_pos, entries_[i].name_len);
+}
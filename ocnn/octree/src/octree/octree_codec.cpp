@@ -0,0 +1,485 @@
+#include "octree_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "morton.h"
+
+const char kCompactMagicStr[16] = "_OCTREE_CZ_1.0_";
+
+typedef OctreeParser::uint64 uint64;
+
+namespace {
+
+// An adaptive binary range coder in the style of LZMA: each probability is
+// the 11-bit estimate of the bit being 0, and it is updated after each bit.
+const int kProbBits = 11;
+const int kProbMove = 5;
+const uint32_t kProbInit = 1u << (kProbBits - 1);
+const uint32_t kRangeTop = 1u << 24;
+
+// the model of a byte, which is coded as 8 bits in a binary tree
+struct ByteModel {
+  uint16_t probs[256];
+  ByteModel() {
+    for (int i = 0; i < 256; ++i) probs[i] = kProbInit;
+  }
+};
+
+class RangeEncoder {
+ public:
+  RangeEncoder(vector<char>& out)
+    : out_(out), low_(0), range_(0xFFFFFFFFu), cache_(0), cache_size_(1) {}
+
+  void encode_bit(uint16_t& prob, const int bit) {
+    uint32_t bound = (range_ >> kProbBits) * prob;
+    if (bit == 0) {
+      range_ = bound;
+      prob += ((1u << kProbBits) - prob) >> kProbMove;
+    } else {
+      low_ += bound;
+      range_ -= bound;
+      prob -= prob >> kProbMove;
+    }
+    while (range_ < kRangeTop) {
+      range_ <<= 8;
+      shift_low();
+    }
+  }
+
+  // the bits with the fixed probability 1/2, from the highest one
+  void encode_direct(const uint32_t val, const int nbits) {
+    for (int i = nbits - 1; i >= 0; --i) {
+      range_ >>= 1;
+      if ((val >> i) & 1u) low_ += range_;
+      while (range_ < kRangeTop) {
+        range_ <<= 8;
+        shift_low();
+      }
+    }
+  }
+
+  void encode_byte(ByteModel& model, const uint32_t byte) {
+    uint32_t m = 1;
+    for (int i = 7; i >= 0; --i) {
+      int bit = (byte >> i) & 1u;
+      encode_bit(model.probs[m], bit);
+      m = (m << 1) | bit;
+    }
+  }
+
+  void flush() {
+    for (int i = 0; i < 5; ++i) shift_low();
+  }
+
+ protected:
+  void shift_low() {
+    if (static_cast<uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0) {
+      uint8_t carry = static_cast<uint8_t>(low_ >> 32);
+      uint8_t temp = cache_;
+      do {
+        out_.push_back(static_cast<char>(temp + carry));
+        temp = 0xFF;
+      } while (--cache_size_ != 0);
+      cache_ = static_cast<uint8_t>(low_ >> 24);
+    }
+    cache_size_++;
+    low_ = (low_ & 0x00FFFFFFu) << 8;
+  }
+
+ protected:
+  vector<char>& out_;
+  uint64_t low_;
+  uint32_t range_;
+  uint8_t cache_;
+  uint64_t cache_size_;
+};
+
+class RangeDecoder {
+ public:
+  RangeDecoder(const char* data, const char* end)
+    : ptr_(reinterpret_cast<const uint8_t*>(data)),
+      end_(reinterpret_cast<const uint8_t*>(end)),
+      range_(0xFFFFFFFFu), code_(0), overrun_(false) {
+    for (int i = 0; i < 5; ++i) code_ = (code_ << 8) | next_byte();
+  }
+
+  // the input is corrupted if more bytes than available are consumed
+  bool overrun() const { return overrun_; }
+
+  int decode_bit(uint16_t& prob) {
+    uint32_t bound = (range_ >> kProbBits) * prob;
+    int bit = 0;
+    if (code_ < bound) {
+      range_ = bound;
+      prob += ((1u << kProbBits) - prob) >> kProbMove;
+    } else {
+      code_ -= bound;
+      range_ -= bound;
+      prob -= prob >> kProbMove;
+      bit = 1;
+    }
+    while (range_ < kRangeTop) {
+      range_ <<= 8;
+      code_ = (code_ << 8) | next_byte();
+    }
+    return bit;
+  }
+
+  uint32_t decode_direct(const int nbits) {
+    uint32_t val = 0;
+    for (int i = 0; i < nbits; ++i) {
+      range_ >>= 1;
+      uint32_t bit = code_ >= range_ ? 1u : 0u;
+      if (bit) code_ -= range_;
+      val = (val << 1) | bit;
+      while (range_ < kRangeTop) {
+        range_ <<= 8;
+        code_ = (code_ << 8) | next_byte();
+      }
+    }
+    return val;
+  }
+
+  uint32_t decode_byte(ByteModel& model) {
+    uint32_t m = 1;
+    for (int i = 0; i < 8; ++i) {
+      m = (m << 1) | decode_bit(model.probs[m]);
+    }
+    return m - 256;
+  }
+
+ protected:
+  uint32_t next_byte() {
+    if (ptr_ == end_) {
+      overrun_ = true;
+      return 0;
+    }
+    return *ptr_++;
+  }
+
+ protected:
+  const uint8_t* ptr_;
+  const uint8_t* end_;
+  uint32_t range_;
+  uint32_t code_;
+  bool overrun_;
+};
+
+// the size of the header before the coded stream
+const size_t kHeaderSize = sizeof(kCompactMagicStr) + sizeof(int) + sizeof(OctreeInfo);
+
+// whether the property is stored at the depth
+bool has_property_at(const OctreeInfo& info, OctreeInfo::PropType ptype, int d) {
+  if (!info.has_property(ptype)) return false;
+  int location = info.locations(ptype);
+  return location == -1 || location == d;
+}
+
+// write the key in the serialized layout, refer to Octree::serialize()
+void write_key(char* des, const uint64 key, const int depth, const bool key2xyz,
+    const int channel) {
+  if (!key2xyz) {
+    if (channel == 1) {
+      uint32_t k = static_cast<uint32_t>(key);
+      memcpy(des, &k, sizeof(k));
+    } else {
+      memcpy(des, &key, sizeof(key));
+    }
+    return;
+  }
+
+  uint32_t pt[3];
+  if (depth <= kMortonDepth32) {
+    morton_decode(pt, static_cast<uint32_t>(key), depth);
+  } else {
+    morton_decode64(pt, key, depth);
+  }
+  if (channel == 1) {
+    unsigned char xyz[4] = { 0 };
+    for (int c = 0; c < 3; ++c) xyz[c] = static_cast<unsigned char>(pt[c]);
+    memcpy(des, xyz, sizeof(xyz));
+  } else {
+    unsigned short xyz[4] = { 0 };
+    for (int c = 0; c < 3; ++c) xyz[c] = static_cast<unsigned short>(pt[c]);
+    memcpy(des, xyz, sizeof(xyz));
+  }
+}
+
+// the labels and split labels are coded as bytes if they are all small integers
+bool is_byte_label(const float* data, const int num) {
+  for (int i = 0; i < num; ++i) {
+    if (!(data[i] >= -1.0f && data[i] <= 254.0f) || data[i] != floorf(data[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// code num elements of esz bytes, with one model per byte of the element
+void encode_words(RangeEncoder& rc, ByteModel* models, const char* data,
+    const int num, const int esz) {
+  for (int i = 0; i < num; ++i) {
+    for (int k = 0; k < esz; ++k) {
+      rc.encode_byte(models[k], static_cast<uint8_t>(data[esz * i + k]));
+    }
+  }
+}
+
+void decode_words(RangeDecoder& rc, ByteModel* models, char* data,
+    const int num, const int esz) {
+  for (int i = 0; i < num; ++i) {
+    for (int k = 0; k < esz; ++k) {
+      data[esz * i + k] = static_cast<char>(rc.decode_byte(models[k]));
+    }
+  }
+}
+
+uint32_t float_bits(const float val) {
+  uint32_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  return bits;
+}
+
+float bits_float(const uint32_t bits) {
+  float val;
+  memcpy(&val, &bits, sizeof(val));
+  return val;
+}
+
+}  // namespace
+
+bool is_compact_octree(const char* data, const size_t sz) {
+  return sz >= sizeof(kCompactMagicStr) &&
+      memcmp(data, kCompactMagicStr, sizeof(kCompactMagicStr)) == 0;
+}
+
+bool compress_octree(vector<char>& out, const OctreeParser& octree,
+    const int quant_bits) {
+  out.clear();
+  if (octree.is_empty()) return false;
+  if (quant_bits != 0 && quant_bits != 8 && quant_bits != 16) return false;
+  const OctreeInfo& info = octree.info();
+  if (info.locations(OctreeInfo::kChild) != -1) return false;
+  const int depth = info.depth();
+  const bool key2xyz = info.key2xyz();
+  const int key_channel = info.channel(OctreeInfo::kKey);
+
+  // header
+  out.insert(out.end(), kCompactMagicStr, kCompactMagicStr + sizeof(kCompactMagicStr));
+  const char* qb = reinterpret_cast<const char*>(&quant_bits);
+  out.insert(out.end(), qb, qb + sizeof(int));
+  const char* pi = reinterpret_cast<const char*>(&info);
+  out.insert(out.end(), pi, pi + sizeof(OctreeInfo));
+  RangeEncoder rc(out);
+
+  // the structure: the j^th non-empty node of layer d owns the nodes
+  // [8j, 8j + 8) of layer d + 1, whose keys are (key_j << 3) | [0, 8)
+  vector<uint64> keys, parent_keys;
+  vector<ByteModel> occupancy(depth + 1);
+  for (int d = 0; d <= depth; ++d) {
+    const int nnum = info.nnum(d);
+    if (d > 0 && nnum != 8 * static_cast<int>(parent_keys.size())) return false;
+    keys.resize(nnum);
+    for (int i = 0; i < nnum; ++i) {
+      keys[i] = d == 0 ? i : (parent_keys[i >> 3] << 3) | (i & 7);
+    }
+
+    // the keys must be consistent with the structure
+    if (has_property_at(info, OctreeInfo::kKey, d)) {
+      const char* key = octree.ptr(OctreeInfo::kKey, d);
+      const int stride = key_channel * sizeof(uint32_t);
+      char buf[8];
+      for (int i = 0; i < nnum; ++i) {
+        write_key(buf, keys[i], d, key2xyz, key_channel);
+        if (memcmp(buf, key + i * stride, stride) != 0) return false;
+      }
+    }
+
+    const int* child = octree.child(d);
+    parent_keys.clear();
+    for (int i = 0; i < nnum; i += 8) {
+      uint32_t mask = 0;
+      for (int j = 0; j < 8 && i + j < nnum; ++j) {
+        int t = child[i + j];
+        if (t == -1) continue;
+        if (t != static_cast<int>(parent_keys.size())) return false;
+        mask |= 1u << j;
+        parent_keys.push_back(keys[i + j]);
+      }
+      rc.encode_byte(occupancy[d], mask);
+    }
+    if (static_cast<int>(parent_keys.size()) != info.nnum_nempty(d)) return false;
+  }
+
+  // the other properties, the data of each depth is channel-major
+  const OctreeInfo::PropType ptypes[] = {
+    OctreeInfo::kNeigh, OctreeInfo::kLabel, OctreeInfo::kSplit, OctreeInfo::kFeature };
+  for (auto ptype : ptypes) {
+    if (!info.has_property(ptype)) continue;
+    const int channel = info.channel(ptype);
+    // the fp16 and integer elements are already compact and coded as they are
+    const int esz = info.sizeof_element(ptype);
+    const bool is_float = info.dtype(ptype) == kFloat32;
+    ByteModel models[4];
+    vector<ByteModel> quant_models(2 * channel);
+    for (int d = 0; d <= depth; ++d) {
+      if (!has_property_at(info, ptype, d)) continue;
+      const int nnum = info.nnum(d);
+      const char* data = octree.ptr(ptype, d);
+      const float* fdata = reinterpret_cast<const float*>(data);
+
+      if (is_float && (ptype == OctreeInfo::kLabel || ptype == OctreeInfo::kSplit)) {
+        int num = nnum * channel;
+        bool as_byte = is_byte_label(fdata, num);
+        rc.encode_direct(as_byte ? 1 : 0, 1);
+        if (as_byte) {
+          for (int i = 0; i < num; ++i) {
+            rc.encode_byte(models[0], static_cast<uint32_t>(fdata[i] + 1.0f));
+          }
+        } else {
+          encode_words(rc, models, data, num, esz);
+        }
+      } else if (is_float && ptype == OctreeInfo::kFeature && quant_bits != 0) {
+        // symmetric quantization, so that 0 is reconstructed exactly
+        const int qmax = (1 << (quant_bits - 1)) - 1;
+        for (int c = 0; c < channel; ++c) {
+          const float* fc = fdata + c * nnum;
+          float max_abs = 0;
+          for (int i = 0; i < nnum; ++i) {
+            if (!std::isfinite(fc[i])) return false;
+            max_abs = std::max(max_abs, std::abs(fc[i]));
+          }
+          float scale = max_abs / qmax;
+          rc.encode_direct(float_bits(scale), 32);
+          if (scale == 0) continue;
+
+          for (int i = 0; i < nnum; ++i) {
+            int q = static_cast<int>(lrintf(fc[i] / scale));
+            q = std::max(-qmax, std::min(qmax, q));
+            uint32_t z = q >= 0 ? 2 * q : -2 * q - 1;  // zigzag
+            if (quant_bits == 16) rc.encode_byte(quant_models[2 * c + 1], z >> 8);
+            rc.encode_byte(quant_models[2 * c], z & 0xFF);
+          }
+        }
+      } else {
+        encode_words(rc, models, data, nnum * channel, esz);
+      }
+    }
+  }
+
+  rc.flush();
+  return true;
+}
+
+bool decompress_octree(vector<char>& buffer, const char* data, const size_t sz) {
+  if (sz < kHeaderSize || !is_compact_octree(data, sz)) return false;
+  int quant_bits = 0;
+  memcpy(&quant_bits, data + sizeof(kCompactMagicStr), sizeof(int));
+  if (quant_bits != 0 && quant_bits != 8 && quant_bits != 16) return false;
+  OctreeInfo info;
+  memcpy(&info, data + sizeof(kCompactMagicStr) + sizeof(int), sizeof(OctreeInfo));
+
+  // validate the header before allocating the buffer
+  string msg;
+  if (!info.check_format(msg)) return false;
+  if (info.locations(OctreeInfo::kChild) != -1) return false;
+  const int depth = info.depth();
+  if (info.nnum_cum(0) != 0) return false;
+  for (int d = 0; d <= depth; ++d) {
+    if (info.nnum(d) < 0 || info.nnum_cum(d + 1) != info.nnum_cum(d) + info.nnum(d)) {
+      return false;
+    }
+  }
+  if (info.total_nnum_capacity() < info.total_nnum()) return false;
+  info.set_ptr_dis();
+
+  buffer.assign(info.sizeof_octree(), 0);
+  memcpy(buffer.data(), &info, sizeof(OctreeInfo));
+  char* base = buffer.data();
+  RangeDecoder rc(data + kHeaderSize, data + sz);
+
+  // the structure
+  const bool key2xyz = info.key2xyz();
+  const int key_channel = info.channel(OctreeInfo::kKey);
+  const int key_stride = key_channel * sizeof(uint32_t);
+  vector<uint64> parent_keys, keys;
+  vector<ByteModel> occupancy(depth + 1);
+  for (int d = 0; d <= depth; ++d) {
+    const int nnum = info.nnum(d);
+    if (d > 0 && nnum != 8 * static_cast<int>(parent_keys.size())) return false;
+    int* child = reinterpret_cast<int*>(base + info.ptr_dis(OctreeInfo::kChild, d));
+    char* key = has_property_at(info, OctreeInfo::kKey, d) ?
+        base + info.ptr_dis(OctreeInfo::kKey, d) : nullptr;
+
+    keys.clear();
+    for (int i = 0; i < nnum; i += 8) {
+      uint32_t mask = rc.decode_byte(occupancy[d]);
+      for (int j = 0; j < 8 && i + j < nnum; ++j) {
+        uint64 k = d == 0 ? i + j : (parent_keys[i >> 3] << 3) | j;
+        if (key != nullptr) {
+          write_key(key + (i + j) * key_stride, k, d, key2xyz, key_channel);
+        }
+        if ((mask >> j) & 1u) {
+          child[i + j] = keys.size();
+          keys.push_back(k);
+        } else {
+          child[i + j] = -1;
+        }
+      }
+    }
+    if (rc.overrun() || static_cast<int>(keys.size()) != info.nnum_nempty(d)) return false;
+    parent_keys.swap(keys);
+  }
+
+  // the other properties
+  const OctreeInfo::PropType ptypes[] = {
+    OctreeInfo::kNeigh, OctreeInfo::kLabel, OctreeInfo::kSplit, OctreeInfo::kFeature };
+  for (auto ptype : ptypes) {
+    if (!info.has_property(ptype)) continue;
+    const int channel = info.channel(ptype);
+    const int esz = info.sizeof_element(ptype);
+    const bool is_float = info.dtype(ptype) == kFloat32;
+    ByteModel models[4];
+    vector<ByteModel> quant_models(2 * channel);
+    for (int d = 0; d <= depth; ++d) {
+      if (!has_property_at(info, ptype, d)) continue;
+      const int nnum = info.nnum(d);
+      char* des = base + info.ptr_dis(ptype, d);
+      float* fdes = reinterpret_cast<float*>(des);
+
+      if (is_float && (ptype == OctreeInfo::kLabel || ptype == OctreeInfo::kSplit)) {
+        int num = nnum * channel;
+        if (rc.decode_direct(1) != 0) {
+          for (int i = 0; i < num; ++i) {
+            fdes[i] = static_cast<float>(rc.decode_byte(models[0])) - 1.0f;
+          }
+        } else {
+          decode_words(rc, models, des, num, esz);
+        }
+      } else if (is_float && ptype == OctreeInfo::kFeature && quant_bits != 0) {
+        for (int c = 0; c < channel; ++c) {
+          float* fc = fdes + c * nnum;
+          float scale = bits_float(rc.decode_direct(32));
+          if (scale == 0) continue;
+
+          for (int i = 0; i < nnum; ++i) {
+            uint32_t z = 0;
+            if (quant_bits == 16) z = rc.decode_byte(quant_models[2 * c + 1]) << 8;
+            z |= rc.decode_byte(quant_models[2 * c]);
+            int q = static_cast<int>(z >> 1);
+            if (z & 1u) q = -q - 1;  // zigzag
+            fc[i] = q * scale;
+          }
+        }
+      } else {
+        decode_words(rc, models, des, nnum * channel, esz);
+      }
+      if (rc.overrun()) return false;
+    }
+  }
+
+  return true;
+}
@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "morton.h"
+
 const char OctreeInfo::kMagicStr[16] = "_OCTREE_1.0_";
 
 void OctreeInfo::initialize(int depth, int full_depth, bool node_displacement,
@@ -18,8 +20,9 @@ void OctreeInfo::initialize(int depth, int full_depth, bool node_displacement,
   set_threshold_normal(threshold_normal);
   set_threshold_dist(threshold_distance);
 
-  // by default, the octree contains Key and Child
-  int channel = (key2xyz && depth > 8) ? 2 : 1;
+  // by default, the octree contains Key and Child, the key takes 2 channels
+  // (i.e. 64 bits) when its 32-bit layout can not hold the depth
+  int channel = depth > (key2xyz ? 8 : kMortonDepth32) ? 2 : 1;
   set_channel(OctreeInfo::kKey, channel);
   set_location(OctreeInfo::kKey, -1);
   set_channel(OctreeInfo::kChild, 1);
@@ -65,8 +68,8 @@ bool OctreeInfo::check_format(string& msg) const {
   if (batch_size_ < 0) {
     msg += "The batch_size_ should be larger than 0.\n";
   }
-  if (depth_ < 1 || depth_ > 8) {
-    msg += "The depth_ should be in range [1, 8].\n";
+  if (depth_ < 1 || depth_ > kMaxDepth) {
+    msg += "The depth_ should be in range [1, " + std::to_string(kMaxDepth) + "].\n";
   }
   if (full_layer_ < 0 || full_layer_ > depth_) {
     msg += "The full_layer_ should be in range [1, depth_].\n";
@@ -87,6 +90,11 @@ bool OctreeInfo::check_format(string& msg) const {
     if (channels_[i] != 0 && locations_[i] != -1 && locations_[i] != depth_) {
       msg += "The locations_[" + str + "] should be -1 or " + std::to_string(depth_) + ".\n";
     }
+    const int data_props = kFeature | kLabel | kSplit;
+    if (dtypes_[i] < 0 || dtypes_[i] >= kDataTypeNum ||
+        (dtypes_[i] != kFloat32 && ((1 << i) & data_props) == 0)) {
+      msg += "The dtypes_[" + str + "] is not supported.\n";
+    }
   }
 
   // the OctreeInfo is valid when no error message is produced
@@ -110,14 +118,26 @@ int OctreeInfo::ptr_dis(PropType ptype, const int depth) const {
   int i = property_index(ptype);
   int dis = ptr_dis_[i];
   if (locations(ptype) == -1) {
-    // !!! Note: sizeof(int)
-    dis += nnum_cum_[depth] * channel(ptype) * sizeof(int);
+    // !!! Note: the element is 4 bytes except for fp16 and int8/int16
+    dis += nnum_cum_[depth] * channel(ptype) * sizeof_element(ptype);
   } else {
     // ignore the input parameter depth
   }
   return dis;
 }
 
+DataType OctreeInfo::dtype(PropType ptype) const {
+  return static_cast<DataType>(dtypes_[property_index(ptype)]);
+}
+
+float OctreeInfo::scale(PropType ptype) const {
+  return scales_[property_index(ptype)];
+}
+
+float OctreeInfo::offset(PropType ptype) const {
+  return offsets_[property_index(ptype)];
+}
+
 float OctreeInfo::bbox_max_width() const {
   float max_width = bbmax_[0] - bbmin_[0];
   for (int i = 1; i < 3; ++i) {
@@ -161,8 +181,17 @@ void OctreeInfo::set_nnum_cum(int capacity) {
 void OctreeInfo::set_property(PropType ptype, int ch, int lc) {
   // this is just a convenient interface to make sure that
   // the set_channel and set_location be called together
+  // the element type is reset as float
   set_channel(ptype, ch);
   set_location(ptype, lc);
+  set_dtype(ptype, kFloat32);
+}
+
+void OctreeInfo::set_dtype(PropType ptype, DataType dtype, float scale, float offset) {
+  int i = property_index(ptype);
+  dtypes_[i] = dtype;
+  scales_[i] = scale;
+  offsets_[i] = offset;
 }
 
 void OctreeInfo::set_channel(PropType ptype, int ch) {
@@ -197,8 +226,9 @@ void OctreeInfo::set_ptr_dis() {
     // If the property do not exist, lc is equal to 0, then num = 8, both of them
     // are meaningless. Their values are wiped out by channels_[i - 1] (= 0).
     // So the value of ptr_dis_[i] is still correct.
-    // !!! Note: sizeof(int)
-    ptr_dis_[i] = ptr_dis_[i - 1] + sizeof(int) * num * channels_[i - 1];
+    // !!! Note: the size of each property is padded to a multiple of 4 bytes
+    int sz = sizeof_dtype(static_cast<DataType>(dtypes_[i - 1])) * num * channels_[i - 1];
+    ptr_dis_[i] = ptr_dis_[i - 1] + ((sz + 3) & ~3);
   }
 }
 
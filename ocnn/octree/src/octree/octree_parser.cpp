@@ -1,9 +1,12 @@
 #include "octree_parser.h"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 
 #include "marching_cube.h"
+#include "octree_codec.h"
+#include "morton.h"
 
 OctreeParser::NodeType OctreeParser::node_type(const int t) const {
   NodeType ntype = kInternelNode;
@@ -13,24 +16,45 @@ OctreeParser::NodeType OctreeParser::node_type(const int t) const {
 }
 
 void OctreeParser::compute_key(uint32& key, const uint32* pt, const int depth) {
-  key = 0;
-  for (int i = 0; i < depth; i++) {
-    uint32 mask = 1u << i;
-    for (int j = 0; j < 3; j++) {
-      key |= (pt[j] & mask) << (2 * i + 2 - j);
-    }
-  }
+  key = morton_encode(pt, depth);
 }
 
 void OctreeParser::compute_pt(uint32* pt, const uint32& key, const int depth) {
-  for (int i = 0; i < 3; pt[i++] = 0u);
-
-  for (int i = 0; i < depth; i++) {
-    for (int j = 0; j < 3; j++) {
-      // bit mask
-      uint32 mask = 1u << (3 * i + 2 - j);
-      // put the bit to position i
-      pt[j] |= (key & mask) >> (2 * i + 2 - j);
+  morton_decode(pt, key, depth);
+}
+
+void OctreeParser::compute_key(uint64& key, const uint32* pt, const int depth) {
+  if (depth <= kMortonDepth32) {
+    key = morton_encode(pt, depth);
+  } else {
+    key = morton_encode64(pt, depth);
+  }
+}
+
+void OctreeParser::compute_pt(uint32* pt, const uint64& key, const int depth) {
+  if (depth <= kMortonDepth32) {
+    morton_decode(pt, static_cast<uint32>(key), depth);
+  } else {
+    morton_decode64(pt, key, depth);
+  }
+}
+
+void OctreeParser::node_pt(uint32* pt, const int i, const int depth) const {
+  const uint32* key_d = key(depth);
+  const bool key64 = info_->channel(OctreeInfo::kKey) == 2;
+  if (info_->key2xyz()) {
+    if (key64) {
+      const unsigned short* ptr = reinterpret_cast<const unsigned short*>(key_d + 2 * i);
+      for (int c = 0; c < 3; ++c) { pt[c] = ptr[c]; }
+    } else {
+      const unsigned char* ptr = reinterpret_cast<const unsigned char*>(key_d + i);
+      for (int c = 0; c < 3; ++c) { pt[c] = ptr[c]; }
+    }
+  } else {
+    if (key64) {
+      morton_decode64(pt, reinterpret_cast<const uint64*>(key_d)[i], depth);
+    } else {
+      morton_decode(pt, key_d[i], depth);
     }
   }
 }
@@ -41,7 +65,34 @@ int OctreeParser::clamp(int val, const int val_min, const int val_max) {
   return val;
 }
 
-bool OctreeParser::read_octree(const string& filename) {
+void OctreeParser::reset_octree() {
+  mapped_.reset();
+  mapped_size_ = 0;
+  buffer_.clear();
+  info_ = nullptr;
+}
+
+bool OctreeParser::read_octree(const string& filename, const bool use_mmap) {
+  reset_octree();
+  if (use_mmap) {
+    std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+    if (mapped->open(filename)) {
+      // the compact octree is decoded from the mapping into buffer_
+      if (is_compact_octree(mapped->data(), mapped->size())) {
+        if (!decompress_octree(buffer_, mapped->data(), mapped->size())) {
+          buffer_.clear();
+          return false;
+        }
+        info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
+        return true;
+      }
+      mapped_ = mapped;
+      mapped_size_ = mapped_->size();
+      info_ = reinterpret_cast<OctreeInfo*>(mapped_->data());
+      return true;
+    }
+  }
+
   std::ifstream infile(filename, std::ios::binary);
   if (!infile) return false;
 
@@ -51,21 +102,153 @@ bool OctreeParser::read_octree(const string& filename) {
 
   buffer_.resize(len);
   infile.read(buffer_.data(), len);
+  infile.close();
+  if (!infile) {
+    buffer_.clear();
+    return false;
+  }
+
+  if (is_compact_octree(buffer_.data(), len)) {
+    vector<char> octree;
+    bool succ = decompress_octree(octree, buffer_.data(), len);
+    buffer_.swap(octree);
+    if (!succ) {
+      buffer_.clear();
+      return false;
+    }
+  }
   info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
+  return true;
+}
 
-  infile.close();
+bool OctreeParser::read_octree_partial(const string& filename,
+    const int content_flags, const int depth_start, const int depth_end) {
+  reset_octree();
+  std::ifstream infile(filename, std::ios::binary);
+  if (!infile) return false;
+
+  // the header, the compact octree is decoded as a whole
+  vector<char> octree;
+  OctreeInfo info;
+  char magic[sizeof(kCompactMagicStr)];
+  infile.read(magic, sizeof(magic));
+  if (infile && is_compact_octree(magic, sizeof(magic))) {
+    infile.close();
+    if (!read_octree(filename)) return false;
+    octree.swap(buffer_);
+    info_ = nullptr;
+    memcpy(&info, octree.data(), sizeof(OctreeInfo));
+  } else {
+    infile.clear();
+    infile.seekg(0, infile.beg);
+    infile.read(reinterpret_cast<char*>(&info), sizeof(OctreeInfo));
+    if (!infile) return false;
+  }
+  string msg;
+  if (!info.check_format(msg)) return false;
+
+  // the info of the selected properties
+  OctreeInfo info_out = info;
+  for (int i = 0; i < OctreeInfo::kPTypeNum; ++i) {
+    OctreeInfo::PropType ptype = static_cast<OctreeInfo::PropType>(1 << i);
+    if ((content_flags & ptype) == 0) info_out.set_property(ptype, 0, 0);
+  }
+  info_out.set_ptr_dis();
+  buffer_.assign(info_out.sizeof_octree(), 0);
+  memcpy(buffer_.data(), &info_out, sizeof(OctreeInfo));
+  info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
+
+  // the sections of the depths in the range are contiguous, so each property
+  // is read with one seek
+  const int depth = info.depth();
+  const int d0 = std::max(depth_start, 0);
+  const int d1 = depth_end < 0 || depth_end > depth ? depth : depth_end;
+  bool succ = true;
+  for (int i = 0; i < OctreeInfo::kPTypeNum && succ; ++i) {
+    OctreeInfo::PropType ptype = static_cast<OctreeInfo::PropType>(1 << i);
+    if (!info_out.has_property(ptype)) continue;
+    int src = 0, des = 0, len = 0;
+    const int location = info.locations(ptype);
+    if (location == -1) {
+      if (d0 > d1) continue;
+      src = info.ptr_dis(ptype, d0);
+      des = info_out.ptr_dis(ptype, d0);
+      len = info.ptr_dis(ptype, d1 + 1) - src;
+    } else {
+      if (location < d0 || location > d1) continue;
+      src = info.ptr_dis(ptype, location);
+      des = info_out.ptr_dis(ptype, location);
+      len = info.nnum(location) * info.channel(ptype) * info.sizeof_element(ptype);
+    }
+
+    if (octree.empty()) {
+      infile.seekg(src, infile.beg);
+      infile.read(buffer_.data() + des, len);
+      succ = !infile.fail();
+    } else {
+      succ = src + len <= static_cast<int>(octree.size());
+      if (succ) memcpy(buffer_.data() + des, octree.data() + src, len);
+    }
+  }
+
+  if (!succ) {
+    buffer_.clear();
+    info_ = nullptr;
+  }
+  return succ;
+}
+
+bool OctreeParser::read_octree(const OctreeArchive& archive, const int idx) {
+  reset_octree();
+  if (idx < 0 || idx >= archive.size()) return false;
+
+  const char* data = archive.data(idx);
+  const size_t sz = archive.data_size(idx);
+  if (is_compact_octree(data, sz)) {
+    if (!decompress_octree(buffer_, data, sz)) {
+      buffer_.clear();
+      return false;
+    }
+    info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
+    return true;
+  }
+
+  // the entry is parsed in place, so it must hold the whole octree, otherwise
+  // the properties would be read from the next entry or from the index
+  if (sz < sizeof(OctreeInfo)) return false;
+  const OctreeInfo* info = reinterpret_cast<const OctreeInfo*>(data);
+  string msg;
+  if (!info->check_format(msg)) return false;
+  if (static_cast<size_t>(info->sizeof_octree()) > sz) return false;
+
+  mapped_ = archive.mapped_file();
+  mapped_size_ = sz;
+  info_ = const_cast<OctreeInfo*>(info);
   return true;
 }
 
 bool OctreeParser::write_octree(const string& filename) const {
   std::ofstream outfile(filename, std::ios::binary);
   if (!outfile) return false;
-  outfile.write(buffer_.data(), buffer_.size());
+  size_t sz = mapped_ ? mapped_size_ : buffer_.size();
+  outfile.write(reinterpret_cast<const char*>(info_), sz);
+  outfile.close();
+  return true;
+}
+
+bool OctreeParser::write_octree_compact(const string& filename,
+    const int quant_bits) const {
+  vector<char> data;
+  if (!compress_octree(data, *this, quant_bits)) return false;
+  std::ofstream outfile(filename, std::ios::binary);
+  if (!outfile) return false;
+  outfile.write(data.data(), data.size());
   outfile.close();
   return true;
 }
 
 std::string OctreeParser::get_binary_string() const {
+    if (mapped_) return std::string(reinterpret_cast<const char*>(info_), mapped_size_);
     return std::string(buffer_.cbegin(), buffer_.cend());
 }
 
@@ -73,7 +256,7 @@ const char* OctreeParser::ptr(const OctreeInfo::PropType ptype, const int depth)
   const char* p = nullptr;
   int dis = info_->ptr_dis(ptype, depth);
   if (-1 != dis) {
-    p = buffer_.data() + dis;
+    p = reinterpret_cast<const char*>(info_) + dis;
   }
   return p;
 }
@@ -102,7 +285,21 @@ const float* OctreeParser::split(const int depth) const {
   return reinterpret_cast<const float*>(ptr(OctreeInfo::kSplit, depth));
 }
 
+const float* OctreeParser::float_ptr(vector<float>& buf,
+    const OctreeInfo::PropType ptype, const int depth) const {
+  const char* p = ptr(ptype, depth);
+  const DataType dtype = info_->dtype(ptype);
+  if (p == nullptr || dtype == kFloat32) return reinterpret_cast<const float*>(p);
+
+  int location = info_->locations(ptype);
+  int num = info_->nnum(location == -1 ? depth : location) * info_->channel(ptype);
+  buf.resize(num);
+  dequantize(buf.data(), p, num, dtype, info_->scale(ptype), info_->offset(ptype));
+  return buf.data();
+}
+
 void OctreeParser::set_octree(vector<char>& data) {
+  mapped_.reset();
   buffer_.swap(data);
   info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
 }
@@ -113,6 +310,7 @@ void OctreeParser::set_octree(const char* data, const int sz) {
 }
 
 void OctreeParser::resize_octree(const int sz) {
+  mapped_.reset();
   buffer_.resize(sz);
   info_ = reinterpret_cast<OctreeInfo*>(buffer_.data());
 }
@@ -153,7 +351,6 @@ void OctreeParser::octree2pts(Points& point_cloud, int depth_start, int depth_en
   const float kDis = 0.8660254f; // = sqrt(3.0f) / 2.0f
   const float* bbmin = info_->bbmin();
   const float kMul = info_->bbox_max_width() / float(1 << info_->depth());
-  const bool key2xyz = info_->key2xyz();
 
   // update depth_start and depth_end
   depth_start = clamp(depth_start, depth_full, depth);
@@ -162,12 +359,11 @@ void OctreeParser::octree2pts(Points& point_cloud, int depth_start, int depth_en
   if (location != -1) depth_start = depth;
   depth_end = clamp(depth_end, depth_start, depth);
 
-  vector<float> pts, normals, labels;
+  vector<float> pts, normals, labels, feature_buf, label_buf;
   for (int d = depth_start; d <= depth_end; ++d) {
-    const uint32* key_d = key(d);
-    const float* feature_d = feature(d);
+    const float* feature_d = float_ptr(feature_buf, OctreeInfo::kFeature, d);
     const int* child_d = child(d);
-    const float* label_d = label(d);
+    const float* label_d = float_ptr(label_buf, OctreeInfo::kLabel, d);
     const int num = info_->nnum(d);
     const float scale = (1 << (depth - d)) * kMul;
 
@@ -181,14 +377,8 @@ void OctreeParser::octree2pts(Points& point_cloud, int depth_start, int depth_en
       //if (node_type(pc[i]) == kLeaf) continue;
       if (len == 0 || (node_type(child_d[i]) != kLeaf && d != depth)) continue;
 
-      uint32 pt[3] = { 0, 0, 0 };
-      if (key2xyz) {
-        // todo: when depth > 8, then the channel of key is 2
-        const unsigned char* ptr = reinterpret_cast<const unsigned char*>(key_d + i);
-        for (int c = 0; c < 3; ++c) { pt[c] = ptr[c]; }
-      } else {
-        compute_pt(pt, key_d[i], d);
-      }
+      uint32 pt[3];
+      node_pt(pt, i, d);
 
       for (int c = 0; c < 3; ++c) {
         float t = pt[c] + 0.5f;
@@ -216,7 +406,6 @@ void OctreeParser::octree2mesh(vector<float>& V, vector<int>& F, int depth_start
   const float kDis = 0.8660254f; // = sqrt(3.0f) / 2.0f
   const float* bbmin = info_->bbmin();
   const float kMul = info_->bbox_max_width() / float(1 << info_->depth());
-  const bool key2xyz = info_->key2xyz();
 
   // update depth_start and depth_end
   depth_start = clamp(depth_start, depth_full, depth);
@@ -226,9 +415,9 @@ void OctreeParser::octree2mesh(vector<float>& V, vector<int>& F, int depth_start
   depth_end = clamp(depth_end, depth_start, depth);
 
   V.clear(); F.clear();
+  vector<float> feature_buf;
   for (int d = depth_start; d <= depth_end; ++d) {
-    const uint32* key_d = key(d);
-    const float* feature_d = feature(d);
+    const float* feature_d = float_ptr(feature_buf, OctreeInfo::kFeature, d);
     const int* child_d = child(d);
     const int num = info_->nnum(d);
     const float scale = (1 << (depth - d)) * kMul;
@@ -244,14 +433,8 @@ void OctreeParser::octree2mesh(vector<float>& V, vector<int>& F, int depth_start
       //if (node_type(pc[i]) == kLeaf) continue;
       if (len == 0 || (node_type(child_d[i]) != kLeaf && d != depth)) continue;
 
-      uint32 pt[3] = { 0, 0, 0 };
-      if (key2xyz) {
-        // todo: when depth > 8, then the channel of key is 2
-        const unsigned char* ptr = reinterpret_cast<const unsigned char*>(key_d + i);
-        for (int c = 0; c < 3; ++c) { pt[c] = ptr[c]; }
-      } else {
-        compute_pt(pt, key_d[i], d);
-      }
+      uint32 pt[3];
+      node_pt(pt, i, d);
       for (int c = 0; c < 3; ++c) {
         float t = pt[c] + 0.5f;
         if (has_dis) {
@@ -67,7 +67,20 @@ int PtsInfo::property_index(PropType ptype) const {
 }
 
 ////////////////////////
-bool Points::read_points(const string& filename) {
+bool Points::read_points(const string& filename, const bool use_mmap) {
+  // release the previous points, which are left empty if the read fails
+  mapped_.reset();
+  buffer_.clear();
+  info_ = nullptr;
+  if (use_mmap) {
+    std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+    if (mapped->open(filename)) {
+      mapped_ = mapped;
+      info_ = reinterpret_cast<PtsInfo*>(mapped_->data());
+      return true;
+    }
+  }
+
   std::ifstream infile(filename, std::ios::binary);
   if (!infile) return false;
 
@@ -77,16 +90,20 @@ bool Points::read_points(const string& filename) {
 
   buffer_.resize(len);
   infile.read(buffer_.data(), len);
-  info_ = reinterpret_cast<PtsInfo*>(buffer_.data());
-
   infile.close();
+  if (!infile) {
+    buffer_.clear();
+    return false;
+  }
+  info_ = reinterpret_cast<PtsInfo*>(buffer_.data());
   return true;
 }
 
 bool Points::write_points(const string& filename) const {
   std::ofstream outfile(filename, std::ios::binary);
   if (!outfile) return false;
-  outfile.write(buffer_.data(), buffer_.size());
+  size_t sz = mapped_ ? mapped_->size() : buffer_.size();
+  outfile.write(reinterpret_cast<const char*>(info_), sz);
   outfile.close();
   return true;
 }
@@ -132,7 +149,7 @@ const float* Points::ptr(PtsInfo::PropType ptype) const {
   const float* p = nullptr;
   int dis = info_->ptr_dis(ptype);
   if (-1 != dis) {
-    p = reinterpret_cast<const float*>(buffer_.data() + dis);
+    p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(info_) + dis);
   }
   return p;
 }
@@ -221,6 +238,7 @@ bool Points::set_points(const vector<float>& pts, const vector<float>& normals,
 
   /// set buffer
   int sz = info.sizeof_points();
+  mapped_.reset();
   buffer_.resize(sz);
   memcpy(buffer_.data(), &info, sizeof(PtsInfo));
   info_ = reinterpret_cast<PtsInfo*>(buffer_.data());
@@ -245,6 +263,7 @@ bool Points::set_points(const vector<float>& pts, const vector<float>& normals,
 }
 
 void Points::set_points(vector<char>& data) {
+  mapped_.reset();
   buffer_.swap(data);
   info_ = reinterpret_cast<PtsInfo*>(buffer_.data());
 }
@@ -1,5 +1,6 @@
 #include "util.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <fstream>
@@ -257,6 +258,86 @@ void normalize_nx3(float* const pts, int npt)
   }
 }
 
+void radix_sort(vector<unsigned long long>& codes, const int bit_begin,
+    const int bit_end) {
+  vector<unsigned long long> buffer;
+  radix_sort(codes, buffer, bit_begin, bit_end);
+}
+
+void radix_sort(vector<unsigned long long>& codes,
+    vector<unsigned long long>& buffer, const int bit_begin, const int bit_end) {
+  typedef unsigned long long uint64;
+  const int kRadixBits = 8, kRadix = 1 << kRadixBits;
+  const int kBlockSize = 1 << 16;    // the points processed by each task
+  const int kMinSize = 1 << 12;      // fall back to std::stable_sort
+  const int n = codes.size();
+  if (bit_begin >= bit_end) return;
+
+  if (n < kMinSize) {
+    uint64 mask = bit_end - bit_begin >= 64 ? ~0ull :
+        ((1ull << (bit_end - bit_begin)) - 1) << bit_begin;
+    std::stable_sort(codes.begin(), codes.end(),
+        [mask](uint64 a, uint64 b) { return (a & mask) < (b & mask); });
+    return;
+  }
+
+  // each block owns a contiguous range of the input and a histogram, the
+  // offsets are accumulated bucket by bucket to keep the sort stable
+  const int nblock = (n + kBlockSize - 1) / kBlockSize;
+  vector<int> hist(nblock * kRadix);
+  buffer.resize(n);
+  uint64* src = codes.data();
+  uint64* des = buffer.data();
+
+  for (int shift = bit_begin; shift < bit_end; shift += kRadixBits) {
+    int bits = std::min(kRadixBits, bit_end - shift);
+    uint64 mask = (1ull << bits) - 1;
+
+    // histogram
+    std::fill(hist.begin(), hist.end(), 0);
+    #pragma omp parallel for
+    for (int b = 0; b < nblock; ++b) {
+      int* hist_b = hist.data() + b * kRadix;
+      int end = std::min(n, (b + 1) * kBlockSize);
+      for (int i = b * kBlockSize; i < end; ++i) {
+        hist_b[(src[i] >> shift) & mask]++;
+      }
+    }
+
+    // skip the pass if all the codes have the same digit
+    bool skip = false;
+    for (int r = 0; r < kRadix && !skip; ++r) {
+      int sum = 0;
+      for (int b = 0; b < nblock; ++b) sum += hist[b * kRadix + r];
+      if (sum == n) skip = true;
+      if (sum != 0) break;
+    }
+    if (skip) continue;
+
+    // exclusive prefix sum, in the order of (radix, block)
+    for (int r = 0, sum = 0; r < kRadix; ++r) {
+      for (int b = 0; b < nblock; ++b) {
+        int t = hist[b * kRadix + r];
+        hist[b * kRadix + r] = sum;
+        sum += t;
+      }
+    }
+
+    // scatter
+    #pragma omp parallel for
+    for (int b = 0; b < nblock; ++b) {
+      int* offset_b = hist.data() + b * kRadix;
+      int end = std::min(n, (b + 1) * kBlockSize);
+      for (int i = b * kBlockSize; i < end; ++i) {
+        des[offset_b[(src[i] >> shift) & mask]++] = src[i];
+      }
+    }
+    std::swap(src, des);
+  }
+
+  if (src != codes.data()) codes.swap(buffer);
+}
+
 bool write_obj(const string& filename, const vector<float>& V, const vector<int>& F) {
   std::ofstream outfile(filename, std::ios::binary);
   if (!outfile) return false;
@@ -1,8 +1,23 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <gtest/gtest.h>
 #include <points.h>
 #include <octree.h>
+#include <dataset_builder.h>
+#include <octree_archive.h>
+#include <octree_codec.h>
 #include <util.h>
 
+// expose the protected Octree::trim_octree() to the tests
+class OctreeTrim : public Octree {
+ public:
+  using Octree::trim_octree;
+};
+
 class OctreeTest : public ::testing::Test {
  protected:
   void gen_test_point() {
@@ -10,7 +25,7 @@ class OctreeTest : public ::testing::Test {
     vector<float> normal{ 1.0f, 0.0f, 0.0f};
     vector<float> feature{ 1.0f, -1.0f, 2.0f};
     vector<float> label{ 0.0f};
-    points.set_points(pt, normal, feature, label);
+    points.set_points(pt, normal, feature, vector<float>(), vector<float>(), label);
   }
 
   void gen_test_pointcloud() {
@@ -18,7 +33,7 @@ class OctreeTest : public ::testing::Test {
     vector<float> normals { 1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
     vector<float> features{ 1.0f, -1.0f, 2.0f, -2.0f, 3.0f, -3.0f };
     vector<float> labels { 0.0f, 2.0f, 2.0f };
-    points.set_points(pts, normals, features, labels);
+    points.set_points(pts, normals, features, vector<float>(), vector<float>(), labels);
   }
 
   void build_octree() {
@@ -83,7 +98,7 @@ class OctreeTest : public ::testing::Test {
 
  protected:
   Points points;
-  Octree octree_;
+  OctreeTrim octree_;
   OctreeInfo oct_info_;
 
 };
@@ -325,6 +340,815 @@ TEST_F(OctreeTest, TestOctreeTrim) {
   }
 }
 
+TEST_F(OctreeTest, TestFeatureDtype) {
+  const float bbmin[] = { 0.0f, 0.0f, 0.0f };
+  const float bbmax[] = { 2.0f, 2.0f, 2.0f };
+  const bool adaptive = false, key2xyz = false, calc_split_label = false;
+  vector<float> pts{ 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0625f, 1.0625f, 0.0f };
+  vector<float> normals{ 1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+  vector<float> labels{ 0.0f, 2.0f, 2.0f }, empty;
+
+  // the feature channels are much smaller than the normals, so one int8
+  // scale can not cover them and fp16 is used instead
+  vector<float> features{ 0.01f, -0.01f, 0.02f, -0.02f, 0.03f, -0.03f };
+  points.set_points(pts, normals, features, empty, empty, labels);
+  this->set_octree_info(adaptive, key2xyz, calc_split_label, bbmin, bbmax);
+  oct_info_.set_dtype(OctreeInfo::kFeature, kInt8);
+  oct_info_.set_dtype(OctreeInfo::kLabel, kInt8);
+  this->build_octree();
+
+  const OctreeInfo& info = octree_.info();
+  EXPECT_EQ(info.dtype(OctreeInfo::kFeature), kFloat16);
+  EXPECT_EQ(info.dtype(OctreeInfo::kLabel), kInt8);
+  EXPECT_EQ(info.scale(OctreeInfo::kLabel), 1.0f);
+  EXPECT_EQ(info.sizeof_octree(), octree_.buffer().size());
+  const int depth = info.depth(), nnum = info.nnum(depth);
+  vector<float> buf;
+  const float* feature = octree_.float_ptr(buf, OctreeInfo::kFeature, depth);
+  const int channel = info.channel(OctreeInfo::kFeature);
+  for (int c = channel - 2; c < channel; ++c) {
+    for (int i = 0; i < nnum; ++i) {
+      EXPECT_LE(std::abs(feature[c * nnum + i]), 0.03f + 1.0e-4f);
+    }
+  }
+
+  // the channels of similar ranges keep int8
+  features = { 0.5f, -0.5f, 1.0f, -1.0f, 0.75f, -0.75f };
+  points.set_points(pts, normals, features, empty, empty, labels);
+  oct_info_.set_dtype(OctreeInfo::kFeature, kInt8);
+  this->build_octree();
+  EXPECT_EQ(octree_.info().dtype(OctreeInfo::kFeature), kInt8);
+}
+
+// the points on the unit sphere, with the normals, two feature channels of
+// different ranges and the labels; the points below ymin are skipped
+void gen_sphere_points(Points& points, const float ymin = -1.0f) {
+  const int num = 400;
+  const float kPI = 3.14159265f;
+  vector<float> pts, normals, features, feature1, labels, empty;
+  for (int i = 0; i < num; ++i) {
+    // the Fibonacci sphere
+    float y = 1.0f - 2.0f * (i + 0.5f) / num, r = sqrtf(1.0f - y * y);
+    if (y < ymin) continue;
+    float phi = i * kPI * (3.0f - sqrtf(5.0f));
+    float pt[3] = { cosf(phi) * r, y, sinf(phi) * r };
+    pts.insert(pts.end(), pt, pt + 3);
+    normals.insert(normals.end(), pt, pt + 3);
+    features.push_back(10.0f * pt[0] * pt[1]);
+    feature1.push_back(0.1f * pt[2]);
+    labels.push_back(static_cast<float>(i % 4));
+  }
+  features.insert(features.end(), feature1.begin(), feature1.end());
+  points.set_points(pts, normals, features, empty, empty, labels);
+}
+
+// the non-adaptive octree info with the split labels and the displacement
+OctreeInfo sphere_octree_info(const Points& points, const int depth,
+    const bool key2xyz, const bool node_feature) {
+  OctreeInfo info;
+  info.initialize(depth, 2, true, node_feature, true, false, depth, 0.866f,
+      0.2f, key2xyz, points);
+  PointsBounds bounds = points.get_points_bounds();
+  info.set_bbox(bounds.radius, bounds.center);
+  return info;
+}
+
+// build the octree of the sphere points
+void build_sphere_octree(Octree& octree, const int depth, const bool key2xyz,
+    const bool node_feature) {
+  Points points;
+  gen_sphere_points(points);
+  octree.build(sphere_octree_info(points, depth, key2xyz, node_feature), points);
+}
+
+struct CodecCase {
+  int depth;
+  bool key2xyz;
+  bool node_feature;
+};
+
+// the 32-bit keys, key2xyz, the features on all nodes, and the 64-bit keys
+// of key2xyz (depth > 8) and of the Morton keys (depth > 10)
+const CodecCase kCodecCases[] = {
+  { 5, false, false }, { 6, true, true }, { 9, true, false }, { 11, false, true } };
+
+TEST(OctreeCodecTest, TestLossless) {
+  for (const CodecCase& c : kCodecCases) {
+    Octree octree;
+    build_sphere_octree(octree, c.depth, c.key2xyz, c.node_feature);
+    EXPECT_EQ(octree.info().channel(OctreeInfo::kKey), c.depth > 8 ? 2 : 1);
+
+    vector<char> compact, buffer;
+    ASSERT_TRUE(compress_octree(compact, octree, 0));
+    EXPECT_TRUE(is_compact_octree(compact.data(), compact.size()));
+    EXPECT_LT(compact.size(), octree.buffer().size());
+    ASSERT_TRUE(decompress_octree(buffer, compact.data(), compact.size()));
+    EXPECT_EQ(buffer, octree.buffer()) << "depth " << c.depth;
+  }
+}
+
+TEST(OctreeCodecTest, TestQuantized) {
+  const int bits[] = { 8, 16 };
+  for (const CodecCase& c : kCodecCases) {
+    Octree octree;
+    build_sphere_octree(octree, c.depth, c.key2xyz, c.node_feature);
+    const OctreeInfo& info = octree.info();
+    for (int b : bits) {
+      vector<char> compact, buffer;
+      ASSERT_TRUE(compress_octree(compact, octree, b));
+      ASSERT_TRUE(decompress_octree(buffer, compact.data(), compact.size()));
+      ASSERT_EQ(buffer.size(), octree.buffer().size());
+      OctreeParser parser;
+      parser.set_octree(buffer);
+
+      // only the features are quantized
+      const int qmax = (1 << (b - 1)) - 1;
+      const int channel = info.channel(OctreeInfo::kFeature);
+      // the property is stored on all depths (location -1) or on one depth
+      auto stored_at = [&](OctreeInfo::PropType p, int d) {
+        int location = info.locations(p);
+        return info.has_property(p) && (location == -1 || location == d);
+      };
+      for (int d = 0; d <= info.depth(); ++d) {
+        const int nnum = info.nnum(d);
+        const OctreeInfo::PropType ptypes[] = { OctreeInfo::kKey,
+            OctreeInfo::kChild, OctreeInfo::kLabel, OctreeInfo::kSplit };
+        for (OctreeInfo::PropType p : ptypes) {
+          if (!stored_at(p, d)) continue;
+          const int sz = nnum * info.channel(p) * sizeof(float);
+          EXPECT_EQ(memcmp(parser.ptr(p, d), octree.ptr(p, d), sz), 0);
+        }
+
+        if (!stored_at(OctreeInfo::kFeature, d)) continue;
+        const float* gt = octree.feature(d);
+        const float* val = parser.feature(d);
+        for (int ch = 0; ch < channel; ++ch) {
+          float max_abs = 0;
+          for (int i = 0; i < nnum; ++i) {
+            max_abs = std::max(max_abs, std::abs(gt[ch * nnum + i]));
+          }
+          const float tol = 0.5f * max_abs / qmax + 1.0e-6f;
+          for (int i = 0; i < nnum; ++i) {
+            const int j = ch * nnum + i;
+            if (gt[j] == 0) {
+              EXPECT_EQ(val[j], 0.0f);  // the empty nodes stay exact
+            } else {
+              EXPECT_NEAR(val[j], gt[j], tol);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(OctreeCodecTest, TestReadCompact) {
+  const string filename = "test_octree_codec.octree";
+  for (const CodecCase& c : kCodecCases) {
+    Octree octree;
+    build_sphere_octree(octree, c.depth, c.key2xyz, c.node_feature);
+    ASSERT_TRUE(octree.write_octree_compact(filename, 0));
+
+    // the compact octree is decoded by both the copying and the mapped read
+    const bool use_mmap[] = { false, true };
+    for (bool m : use_mmap) {
+      OctreeParser parser;
+      ASSERT_TRUE(parser.read_octree(filename, m));
+      EXPECT_EQ(parser.buffer(), octree.buffer());
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(OctreeMmapTest, TestReadFailure) {
+  // a failed read after a mapped read releases the mapping and leaves the
+  // octree or the points empty
+  const string filename = "test_octree_mmap.octree";
+  const string filename_pts = "test_octree_mmap.points";
+  const string missing = "test_octree_mmap_missing";
+  Points points;
+  gen_sphere_points(points);
+  ASSERT_TRUE(points.write_points(filename_pts));
+  Octree octree;
+  build_sphere_octree(octree, 5, false, false);
+  ASSERT_TRUE(octree.write_octree(filename));
+
+  const bool use_mmap[] = { false, true };
+  for (bool m : use_mmap) {
+    OctreeParser parser;
+    ASSERT_TRUE(parser.read_octree(filename, true));
+    EXPECT_FALSE(parser.is_empty());
+    EXPECT_FALSE(parser.read_octree(missing, m));
+    EXPECT_TRUE(parser.is_empty());
+    EXPECT_TRUE(parser.buffer().empty());
+    ASSERT_TRUE(parser.read_octree(filename, m));
+    EXPECT_EQ(parser.get_binary_string(), octree.get_binary_string());
+
+    Points pts;
+    ASSERT_TRUE(pts.read_points(filename_pts, true));
+    EXPECT_FALSE(pts.is_empty());
+    EXPECT_FALSE(pts.read_points(missing, m));
+    EXPECT_TRUE(pts.is_empty());
+  }
+  std::remove(filename.c_str());
+  std::remove(filename_pts.c_str());
+}
+
+// expose the mapping of OctreeParser and Points to the tests
+class OctreeParserMapped : public OctreeParser {
+ public:
+  const MappedFile* mapped_file() const { return mapped_.get(); }
+  size_t mapped_size() const { return mapped_size_; }
+};
+
+class PointsMapped : public Points {
+ public:
+  const MappedFile* mapped_file() const { return mapped_.get(); }
+};
+
+string read_file(const string& filename) {
+  std::ifstream infile(filename, std::ios::binary);
+  return string((std::istreambuf_iterator<char>(infile)),
+      std::istreambuf_iterator<char>());
+}
+
+bool in_mapping(const MappedFile* mapped, const void* ptr) {
+  const char* p = reinterpret_cast<const char*>(ptr);
+  return mapped->data() <= p && p < mapped->data() + mapped->size();
+}
+
+TEST(OctreeMmapTest, TestOctreeZeroCopy) {
+  const string filename = "test_octree_mmap.octree";
+  const string filename_out = "test_octree_mmap_out.octree";
+  Octree octree;
+  build_sphere_octree(octree, 6, false, true);
+  ASSERT_TRUE(octree.write_octree(filename));
+  const string content = read_file(filename);
+
+  // the info and the properties point into the mapping
+  OctreeParserMapped parser;
+  ASSERT_TRUE(parser.read_octree(filename, true));
+  const MappedFile* mapped = parser.mapped_file();
+  ASSERT_TRUE(mapped != nullptr);
+  EXPECT_TRUE(parser.buffer().empty());
+  EXPECT_EQ(parser.mapped_size(), content.size());
+  EXPECT_EQ(reinterpret_cast<const char*>(&parser.info()), mapped->data());
+  const int depth = parser.info().depth();
+  for (int d = 0; d <= depth; ++d) {
+    EXPECT_TRUE(in_mapping(mapped, parser.key(d)));
+    EXPECT_TRUE(in_mapping(mapped, parser.child(d)));
+    EXPECT_TRUE(in_mapping(mapped, parser.feature(d)));
+  }
+
+  // the mapped parser serializes the same bytes as the copying one
+  OctreeParser parser_copy;
+  ASSERT_TRUE(parser_copy.read_octree(filename, false));
+  EXPECT_EQ(parser_copy.buffer(), octree.buffer());
+  EXPECT_EQ(parser.get_binary_string(), parser_copy.get_binary_string());
+  ASSERT_TRUE(parser.write_octree(filename_out));
+  EXPECT_EQ(read_file(filename_out), content);
+
+  // the writes are private to the parser, and never reach the file
+  float* feature = parser.mutable_feature(depth);
+  feature[0] += 1.0f;
+  parser.mutable_child(depth)[0] = -7;
+  EXPECT_EQ(parser.feature(depth)[0], feature[0]);
+  EXPECT_EQ(read_file(filename), content);
+  OctreeParser parser_new;
+  ASSERT_TRUE(parser_new.read_octree(filename, true));
+  EXPECT_EQ(parser_new.get_binary_string(), content);
+  EXPECT_NE(parser.get_binary_string(), content);
+
+  std::remove(filename.c_str());
+  std::remove(filename_out.c_str());
+}
+
+TEST(OctreeMmapTest, TestPointsZeroCopy) {
+  const string filename = "test_octree_mmap.points";
+  const string filename_out = "test_octree_mmap_out.points";
+  Points points;
+  gen_sphere_points(points);
+  ASSERT_TRUE(points.write_points(filename));
+  const string content = read_file(filename);
+
+  PointsMapped pts;
+  ASSERT_TRUE(pts.read_points(filename, true));
+  const MappedFile* mapped = pts.mapped_file();
+  ASSERT_TRUE(mapped != nullptr);
+  EXPECT_EQ(mapped->size(), content.size());
+  EXPECT_EQ(reinterpret_cast<const char*>(&pts.info()), mapped->data());
+  const PtsInfo::PropType ptypes[] = { PtsInfo::kPoint, PtsInfo::kNormal,
+      PtsInfo::kFeature, PtsInfo::kLabel };
+  for (PtsInfo::PropType p : ptypes) {
+    EXPECT_TRUE(in_mapping(mapped, pts.ptr(p)));
+  }
+
+  // the mapped points serialize the same bytes as the copying read
+  Points pts_copy;
+  ASSERT_TRUE(pts_copy.read_points(filename, false));
+  ASSERT_TRUE(pts.write_points(filename_out));
+  EXPECT_EQ(read_file(filename_out), content);
+  ASSERT_TRUE(pts_copy.write_points(filename_out));
+  EXPECT_EQ(read_file(filename_out), content);
+
+  // the points are transformed in the private pages only
+  const float dis = 0.25f;
+  pts.displace(dis);
+  pts_copy.displace(dis);
+  const int num = pts.info().pt_num() * pts.info().channel(PtsInfo::kPoint);
+  EXPECT_EQ(memcmp(pts.ptr(PtsInfo::kPoint), pts_copy.ptr(PtsInfo::kPoint),
+      num * sizeof(float)), 0);
+  EXPECT_EQ(read_file(filename), content);
+
+  std::remove(filename.c_str());
+  std::remove(filename_out.c_str());
+}
+
+// the selected properties of the partial read match the full read at the
+// depths in [d0, d1], and are zero at the other depths
+void check_partial(const OctreeParser& partial, const OctreeParser& full,
+    const int content_flags, const int d0, const int d1) {
+  const OctreeInfo& info = full.info();
+  ASSERT_EQ(partial.info().depth(), info.depth());
+  for (int i = 0; i < OctreeInfo::kPTypeNum; ++i) {
+    OctreeInfo::PropType p = static_cast<OctreeInfo::PropType>(1 << i);
+    if ((content_flags & p) == 0 || !info.has_property(p)) {
+      EXPECT_FALSE(partial.info().has_property(p)) << p;
+      continue;
+    }
+    ASSERT_TRUE(partial.info().has_property(p)) << p;
+    EXPECT_EQ(partial.info().locations(p), info.locations(p));
+    for (int d = 0; d <= info.depth(); ++d) {
+      const int location = info.locations(p);
+      if (location != -1 && location != d) continue;
+      const int sz = info.nnum(d) * info.channel(p) * info.sizeof_element(p);
+      const char* ptr = partial.ptr(p, d);
+      if (d0 <= d && d <= d1) {
+        EXPECT_EQ(memcmp(ptr, full.ptr(p, d), sz), 0) << p << ", " << d;
+      } else {
+        EXPECT_EQ(std::count(ptr, ptr + sz, 0), sz) << p << ", " << d;
+      }
+    }
+  }
+}
+
+TEST(OctreePartialTest, TestReadPartial) {
+  const string filename = "test_octree_partial.octree";
+  const string filename_compact = "test_octree_partial_compact.octree";
+  Octree octree;
+  build_sphere_octree(octree, 6, false, true);
+  ASSERT_TRUE(octree.write_octree(filename));
+  ASSERT_TRUE(octree.write_octree_compact(filename_compact, 0));
+  const int depth = octree.info().depth();
+
+  const int flags[] = {
+    OctreeInfo::kKey | OctreeInfo::kChild | OctreeInfo::kFeature | OctreeInfo::kLabel,
+    OctreeInfo::kFeature | OctreeInfo::kSplit, OctreeInfo::kChild };
+  const int ranges[][2] = { { 0, -1 }, { 2, 4 }, { 5, 5 }, { -3, 10 }, { 4, 2 } };
+  const string files[] = { filename, filename_compact };
+  for (const string& f : files) {
+    OctreeParser full;
+    ASSERT_TRUE(full.read_octree(f));
+    for (int flag : flags) {
+      for (const auto& r : ranges) {
+        OctreeParser partial;
+        ASSERT_TRUE(partial.read_octree_partial(f, flag, r[0], r[1]));
+        const int d0 = std::max(r[0], 0);
+        const int d1 = r[1] < 0 || r[1] > depth ? depth : r[1];
+        check_partial(partial, full, flag, d0, d1);
+      }
+    }
+
+    // all the properties of all the depths are the full read
+    OctreeParser partial;
+    ASSERT_TRUE(partial.read_octree_partial(f, 0xFF));
+    EXPECT_EQ(partial.buffer(), full.buffer());
+  }
+  std::remove(filename.c_str());
+  std::remove(filename_compact.c_str());
+}
+
+TEST(OctreePartialTest, TestReadPartialFailure) {
+  // the parser is left empty if the partial read fails after a mapped read
+  const string filename = "test_octree_partial.octree";
+  const string truncated = "test_octree_partial_truncated.octree";
+  Octree octree;
+  build_sphere_octree(octree, 5, false, false);
+  ASSERT_TRUE(octree.write_octree(filename));
+  {
+    std::ofstream outfile(truncated, std::ios::binary);
+    outfile.write(octree.buffer().data(), octree.buffer().size() / 2);
+  }
+
+  const string files[] = { "test_octree_partial_missing.octree", truncated };
+  for (const string& f : files) {
+    OctreeParser parser;
+    ASSERT_TRUE(parser.read_octree(filename, true));
+    EXPECT_FALSE(parser.read_octree_partial(f, OctreeInfo::kSplit));
+    EXPECT_TRUE(parser.is_empty());
+    EXPECT_TRUE(parser.buffer().empty());
+  }
+  std::remove(filename.c_str());
+  std::remove(truncated.c_str());
+}
+
+// the entries of the archive match the octrees, names, labels and poses in
+// order, and the octrees lie in file order at 8-byte aligned offsets
+void check_archive(const string& filename, const vector<string>& octrees,
+    const vector<string>& names) {
+  OctreeArchive archive;
+  ASSERT_TRUE(archive.open(filename));
+  ASSERT_EQ(archive.size(), static_cast<int>(octrees.size()));
+  for (int i = 0; i < archive.size(); ++i) {
+    EXPECT_EQ(archive.name(i), names[i]);
+    EXPECT_EQ(archive.label(i), i);
+    EXPECT_EQ(archive.pose(i), i % 3);
+    EXPECT_EQ(string(archive.data(i), archive.data_size(i)), octrees[i]);
+    EXPECT_EQ(archive.entry(i).offset % 8, 0);
+    if (i > 0) {
+      EXPECT_GE(archive.entry(i).offset,
+          archive.entry(i - 1).offset + archive.entry(i - 1).size);
+    }
+  }
+}
+
+TEST(OctreeArchiveTest, TestAppend) {
+  const string filename = "test_octree_archive.pk";
+  // the sizes are not multiples of 8, and the names have different lengths
+  vector<string> octrees, names;
+  for (int i = 0; i < 5; ++i) {
+    octrees.push_back(string(3 + 5 * i, char('a' + i)));
+    names.push_back("octree_" + string(i + 1, char('0' + i)));
+  }
+
+  OctreeArchiveWriter writer;
+  ASSERT_TRUE(writer.open(filename));
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(writer.add(octrees[i].data(), octrees[i].size(), names[i], i, i % 3));
+  }
+  ASSERT_TRUE(writer.close());
+  check_archive(filename, vector<string>(octrees.begin(), octrees.begin() + 2),
+      vector<string>(names.begin(), names.begin() + 2));
+
+  // the old index stays valid until the appending writer is closed
+  ASSERT_TRUE(writer.open(filename, true));
+  for (int i = 2; i < 4; ++i) {
+    ASSERT_TRUE(writer.add(octrees[i].data(), octrees[i].size(), names[i], i, i % 3));
+  }
+  check_archive(filename, vector<string>(octrees.begin(), octrees.begin() + 2),
+      vector<string>(names.begin(), names.begin() + 2));
+  ASSERT_TRUE(writer.close());
+  check_archive(filename, vector<string>(octrees.begin(), octrees.begin() + 4),
+      vector<string>(names.begin(), names.begin() + 4));
+
+  // append once more, and reopening without append truncates the archive
+  ASSERT_TRUE(writer.open(filename, true));
+  ASSERT_TRUE(writer.add(octrees[4].data(), octrees[4].size(), names[4], 4, 4 % 3));
+  ASSERT_TRUE(writer.close());
+  check_archive(filename, octrees, names);
+  ASSERT_TRUE(writer.open(filename));
+  ASSERT_TRUE(writer.close());
+  check_archive(filename, vector<string>(), vector<string>());
+  std::remove(filename.c_str());
+
+  // appending to a missing file creates the archive
+  ASSERT_TRUE(writer.open(filename, true));
+  ASSERT_TRUE(writer.add(octrees[0].data(), octrees[0].size(), names[0], 0, 0));
+  ASSERT_TRUE(writer.close());
+  check_archive(filename, vector<string>(1, octrees[0]), vector<string>(1, names[0]));
+  std::remove(filename.c_str());
+}
+
+TEST(OctreeArchiveTest, TestAppendInvalid) {
+  // appending to a file which is not an archive fails and keeps the file
+  const string filename = "test_octree_archive.txt";
+  const string content = "this is not an octree archive, but it is long enough "
+      "to hold the header of one";
+  {
+    std::ofstream outfile(filename, std::ios::binary);
+    outfile << content;
+  }
+  OctreeArchiveWriter writer;
+  EXPECT_FALSE(writer.open(filename, true));
+  EXPECT_FALSE(writer.is_open());
+  OctreeArchive archive;
+  EXPECT_FALSE(archive.open(filename));
+
+  std::ifstream infile(filename, std::ios::binary);
+  string read((std::istreambuf_iterator<char>(infile)),
+      std::istreambuf_iterator<char>());
+  infile.close();
+  EXPECT_EQ(read, content);
+  std::remove(filename.c_str());
+}
+
+TEST(OctreeArchiveTest, TestReadOctree) {
+  const string filename = "test_octree_archive.pk";
+  // the octrees of different depths, and every other one is compact
+  vector<string> octrees;
+  OctreeArchiveWriter writer;
+  ASSERT_TRUE(writer.open(filename));
+  for (int i = 0; i < 4; ++i) {
+    Octree octree;
+    build_sphere_octree(octree, 4 + i, i % 2 == 1, true);
+    octrees.push_back(octree.get_binary_string());
+    vector<char> data(octree.buffer());
+    if (i % 2 == 1) {
+      ASSERT_TRUE(compress_octree(data, octree, 0));
+    }
+    ASSERT_TRUE(writer.add(data.data(), data.size(), "octree", i, 0));
+  }
+  ASSERT_TRUE(writer.close());
+
+  OctreeArchive archive;
+  ASSERT_TRUE(archive.open(filename));
+  ASSERT_EQ(archive.size(), 4);
+  vector<OctreeParser> parsers(archive.size());
+  for (int i = 0; i < archive.size(); ++i) {
+    ASSERT_TRUE(parsers[i].read_octree(archive, i));
+    EXPECT_EQ(parsers[i].get_binary_string(), octrees[i]) << i;
+    if (i % 2 == 1) {
+      EXPECT_EQ(string(parsers[i].buffer().begin(), parsers[i].buffer().end()),
+          octrees[i]);
+    } else {
+      // the original octree is parsed in place
+      EXPECT_TRUE(parsers[i].buffer().empty());
+      EXPECT_EQ(reinterpret_cast<const char*>(&parsers[i].info()), archive.data(i));
+    }
+  }
+
+  // the parsers keep the mapping alive after the archive is closed
+  archive.close();
+  for (int i = 0; i < static_cast<int>(parsers.size()); ++i) {
+    EXPECT_EQ(parsers[i].get_binary_string(), octrees[i]) << i;
+  }
+
+  // an index out of range fails and leaves the parser empty
+  ASSERT_TRUE(archive.open(filename));
+  const int invalid[] = { -1, archive.size() };
+  for (int idx : invalid) {
+    OctreeParser parser;
+    ASSERT_TRUE(parser.read_octree(archive, 0));
+    EXPECT_FALSE(parser.read_octree(archive, idx));
+    EXPECT_TRUE(parser.is_empty());
+    EXPECT_TRUE(parser.buffer().empty());
+  }
+  archive.close();
+  std::remove(filename.c_str());
+}
+
+TEST(OctreeArchiveTest, TestReadInvalid) {
+  // the entries too short for the header, with an invalid header, or
+  // truncated are rejected, while the valid entry after them is still read
+  const string filename = "test_octree_archive.pk";
+  Octree octree;
+  build_sphere_octree(octree, 5, false, false);
+  const vector<char>& buffer = octree.buffer();
+  vector<string> entries;
+  entries.push_back(string(buffer.data(), sizeof(OctreeInfo) / 2));
+  entries.push_back(string(buffer.size(), 'x'));
+  entries.push_back(string(buffer.data(), buffer.size() - 4));
+  entries.push_back(string(buffer.data(), buffer.size()));
+
+  OctreeArchiveWriter writer;
+  ASSERT_TRUE(writer.open(filename));
+  for (int i = 0; i < static_cast<int>(entries.size()); ++i) {
+    ASSERT_TRUE(writer.add(entries[i].data(), entries[i].size(), "octree", i, 0));
+  }
+  ASSERT_TRUE(writer.close());
+
+  OctreeArchive archive;
+  ASSERT_TRUE(archive.open(filename));
+  for (int i = 0; i < archive.size() - 1; ++i) {
+    OctreeParser parser;
+    ASSERT_TRUE(parser.read_octree(archive, archive.size() - 1));
+    EXPECT_FALSE(parser.read_octree(archive, i)) << i;
+    EXPECT_TRUE(parser.is_empty());
+  }
+  OctreeParser parser;
+  ASSERT_TRUE(parser.read_octree(archive, archive.size() - 1));
+  EXPECT_EQ(parser.get_binary_string(), octree.get_binary_string());
+  archive.close();
+  std::remove(filename.c_str());
+}
+
+// build the octree with the per-level arrays, and compute the coarse-layer
+// signals by rescanning the covered nodes of the finest layer, which is the
+// path of the adaptive octree
+class OctreeTopDown : public Octree {
+ public:
+  void build_top_down(const OctreeInfo& octree_info, const Points& point_cloud) {
+    clear(octree_info.depth());
+    oct_info_ = octree_info;
+    normalize_pts(scratch_.pts_scaled, point_cloud, nullptr);
+    sort_keys(scratch_.node_keys, scratch_.sorted_idx, scratch_.pts_scaled);
+    unique_key(scratch_.node_keys, scratch_.unique_idx);
+    build_structure(scratch_.node_keys);
+    calc_node_num();
+    const float* normals = point_cloud.ptr(PtsInfo::kNormal);
+    calc_feature_channel(point_cloud, normals);
+    calc_signal(point_cloud, normals, scratch_.pts_scaled, scratch_.sorted_idx,
+        scratch_.unique_idx);
+    covered_depth_nodes();
+    calc_signal(false, false);
+    if (oct_info_.has_property(OctreeInfo::kSplit)) calc_split_label();
+    serialize();
+  }
+};
+
+TEST(OctreeSignalTest, TestBottomUp) {
+  // the normals of the whole sphere sum up to nearly zero at the coarse
+  // layers, whose direction is then dominated by the rounding error, so only
+  // the upper part of the sphere is used
+  const int depth = 6;
+  Points points;
+  gen_sphere_points(points, -0.5f);
+  const OctreeInfo octree_info = sphere_octree_info(points, depth, false, true);
+  Octree octree;
+  octree.build(octree_info, points);
+  OctreeTopDown octree_gt;
+  octree_gt.build_top_down(octree_info, points);
+
+  // the summation order differs, so the signals are compared with a tolerance
+  const OctreeInfo& info = octree.info();
+  ASSERT_EQ(info.sizeof_octree(), octree_gt.info().sizeof_octree());
+  const int channel = info.channel(OctreeInfo::kFeature);
+  for (int d = 0; d <= depth; ++d) {
+    const int nnum = info.nnum(d);
+    ASSERT_EQ(nnum, octree_gt.info().nnum(d));
+    for (int i = 0; i < nnum; ++i) {
+      EXPECT_EQ(octree.key(d)[i], octree_gt.key(d)[i]);
+      EXPECT_EQ(octree.child(d)[i], octree_gt.child(d)[i]);
+      EXPECT_EQ(octree.split(d)[i], octree_gt.split(d)[i]);
+      EXPECT_NEAR(octree.label(d)[i], octree_gt.label(d)[i], 1.0e-5f);
+    }
+    for (int i = 0; i < nnum * channel; ++i) {
+      EXPECT_NEAR(octree.feature(d)[i], octree_gt.feature(d)[i], 1.0e-5f);
+    }
+  }
+}
+
+TEST(OctreePosesTest, TestBuildPoses) {
+  const int depth = 6, num = 4;
+  const float axis[] = { 0.0f, 0.0f, 1.0f };
+  Points points;
+  gen_sphere_points(points);
+  const OctreeInfo octree_info = sphere_octree_info(points, depth, false, true);
+
+  vector<float> rotations(9 * num);
+  for (int i = 0; i < num; ++i) {
+    rotation_matrix(rotations.data() + 9 * i, 0.7f * i, axis);
+  }
+  Octree octree;
+  vector<vector<char> > octrees;
+  octree.build_poses(octrees, octree_info, points, rotations);
+  ASSERT_EQ(octrees.size(), num);
+
+  // the same as rotating the points and building the octree once per pose
+  for (int i = 0; i < num; ++i) {
+    Points points_rot;
+    gen_sphere_points(points_rot);
+    points_rot.rotate(0.7f * i, axis);
+    Octree octree_gt;
+    octree_gt.build(octree_info, points_rot);
+    EXPECT_EQ(octrees[i], octree_gt.buffer()) << i;
+  }
+}
+
+// OctreeProcessor.process() with the centering, displacing, axial rotation
+// and rotation augmentors, transcribed from octree_augmentor.py: the python
+// scalars are doubles, and are cast to float when passed to Points
+string process_python(const string& filename, const OctreeSettings& s,
+    const int num_aug, const double displacement, const float* axis,
+    const double rnd, const int aug_idx) {
+  const double kPI = 3.14159265358979323846;
+  Points points;
+  points.read_points(filename);
+  OctreeInfo info;
+  info.initialize(s.depth, s.full_depth, s.node_displacement, s.node_feature,
+      s.split_label, s.adaptive, s.adaptive_depth, s.threshold_distance,
+      s.threshold_normal, s.key2xyz, points);
+
+  PointsBounds bounds = points.get_points_bounds();
+  points.center_about(bounds.center);
+
+  bounds = points.get_points_bounds();
+  double radius = bounds.radius;
+  points.displace(float(displacement * 2.0 * radius / (1 << s.depth)));
+
+  double angular_step = 2 * kPI / num_aug;
+  points.rotate(float(angular_step * aug_idx), axis);
+
+  double offset = 2.0 / num_aug, increment = kPI * (3.0 - sqrt(5.0));
+  double y = ((aug_idx * offset) - 1) + (offset / 2), r = sqrt(1 - pow(y, 2));
+  double fib_phi = fmod(aug_idx + rnd, double(num_aug)) * increment;
+  double x = cos(fib_phi) * r, z = sin(fib_phi) * r;
+  double theta = acos(z), phi = atan2(y, x);
+  float rot[9] = {
+    float(cos(theta) * cos(phi)), float(-sin(phi)), float(sin(theta) * cos(phi)),
+    float(cos(theta) * sin(phi)), float(cos(phi)), float(sin(theta) * sin(phi)),
+    float(-sin(theta)), 0.0f, float(cos(theta)) };
+  points.transform(rot);
+
+  bounds = points.get_points_bounds();
+  info.set_bbox(bounds.radius, bounds.center);
+  Octree octree;
+  octree.build(info, points);
+  return octree.get_binary_string();
+}
+
+TEST(DatasetBuilderTest, TestPythonParity) {
+  // the points are scaled and cut, so that the radius is not a round number
+  const string filename = "test_dataset_builder.points";
+  const float scale[9] = { 1.37f, 0, 0, 0, 1.37f, 0, 0, 0, 1.37f };
+  Points points;
+  gen_sphere_points(points, -0.3f);
+  points.transform(scale);
+  ASSERT_TRUE(points.write_points(filename));
+
+  OctreeSettings settings;
+  settings.depth = 6;
+  settings.node_feature = true;
+  settings.split_label = true;
+  const int num_aug = 6;
+  const float axis[] = { 0.0f, 0.0f, 1.0f };
+  const double rnd = 0.123456789012345 * num_aug;
+  const double displacements[] = { 0.55, 0.3, 0.1 };
+  for (double displacement : displacements) {
+    PointsAugmentor augmentor(num_aug);
+    augmentor.add_centering();
+    augmentor.add_displacing(displacement, settings.depth);
+    augmentor.add_axial_rotation(axis);
+    augmentor.add_rotation(rnd);
+    DatasetBuilder builder(settings, augmentor);
+
+    Octree octree_builder;
+    for (int i = 0; i < num_aug; ++i) {
+      DatasetBuilder::Item item = { filename, 0, i };
+      string octree;
+      ASSERT_TRUE(builder.build_octree(octree, item, octree_builder));
+      EXPECT_TRUE(octree == process_python(filename, settings, num_aug,
+          displacement, axis, rnd, i)) << displacement << ", " << i;
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+// expose the protected Octree::unique_key() to the tests
+class OctreeUniqueKey : public Octree {
+ public:
+  using Octree::unique_key;
+};
+
+TEST(OctreeUniqueKeyTest, TestUniqueKey) {
+  OctreeUniqueKey octree;
+  vector<Octree::uint64> keys{ 1, 1, 3, 5, 5, 5, 8 };
+  vector<Octree::uint32> idx;
+  octree.unique_key(keys, idx);
+  EXPECT_EQ(keys, vector<Octree::uint64>({ 1, 3, 5, 8 }));
+  EXPECT_EQ(idx, vector<Octree::uint32>({ 0, 2, 3, 6, 7 }));
+
+  // the empty input gives one key and the index {0, 0}
+  vector<Octree::uint64> empty_keys;
+  octree.unique_key(empty_keys, idx);
+  EXPECT_EQ(empty_keys.size(), 1);
+  EXPECT_EQ(idx, vector<Octree::uint32>({ 0, 0 }));
+}
+
+TEST(OctreeUniqueKeyTest, TestUniqueKeyBlocks) {
+  // more than 2 blocks of 65536 keys, the runs of 1 to 8 duplicated keys
+  // straddle the block boundaries
+  const int n = 3 * 65536 + 100;
+  vector<Octree::uint64> keys(n);
+  unsigned int seed = 1;
+  Octree::uint64 key = 5;
+  for (int i = 0; i < n;) {
+    seed = seed * 1103515245u + 12345u;
+    int run = 1 + ((seed >> 16) & 7);
+    for (int j = 0; j < run && i < n; ++j) keys[i++] = key;
+    key += 1 + ((seed >> 8) & 3);
+  }
+  // one run across each block boundary whatever the random runs are
+  for (int b = 1; b <= 3; ++b) {
+    const int i = b * 65536;
+    keys[i - 1] = keys[i] = keys[i + 1] = keys[i - 2];
+  }
+
+  vector<Octree::uint64> keys_gt(keys);
+  keys_gt.erase(std::unique(keys_gt.begin(), keys_gt.end()), keys_gt.end());
+  vector<Octree::uint32> idx_gt;
+  for (int i = 0; i < n; ++i) {
+    if (i == 0 || keys[i] != keys[i - 1]) idx_gt.push_back(i);
+  }
+  idx_gt.push_back(n);
+
+  OctreeUniqueKey octree;
+  vector<Octree::uint32> idx;
+  octree.unique_key(keys, idx);
+  EXPECT_EQ(keys, keys_gt);
+  EXPECT_EQ(idx, idx_gt);
+}
+
 TEST(UtilTest, TestExtractPath) {
   EXPECT_EQ(extract_path("C:\\test\\test.txt"), "C:/test");
   EXPECT_EQ(extract_path("C:/test\\test.txt"), "C:/test");
@@ -340,4 +1164,27 @@ TEST(UtilTest, TestExtractFilename) {
   EXPECT_EQ(extract_filename("test.txt"), "test");
   EXPECT_EQ(extract_filename("./test.txt"), "test");
   EXPECT_EQ(extract_filename("test"), "test");
-}
\ No newline at end of file
+}
+
+TEST(UtilTest, TestRadixSort) {
+  // large enough to exercise the parallel radix passes
+  const int n = 100000;
+  vector<unsigned long long> codes(n);
+  unsigned int seed = 1;
+  for (int i = 0; i < n; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    unsigned long long key = (seed >> 8) & 0x3FFFF; // 18 bits, depth 6
+    codes[i] = (key << 32) | i;
+  }
+
+  vector<unsigned long long> gt = codes;
+  std::sort(gt.begin(), gt.end());
+  radix_sort(codes, 32, 32 + 18);
+  EXPECT_EQ(codes, gt);
+
+  // small input falls back to std::stable_sort
+  vector<unsigned long long> small{ 5ull << 32 | 0, 1ull << 32 | 1, 5ull << 32 | 2 };
+  radix_sort(small, 32, 64);
+  vector<unsigned long long> small_gt{ 1ull << 32 | 1, 5ull << 32 | 0, 5ull << 32 | 2 };
+  EXPECT_EQ(small, small_gt);
+}
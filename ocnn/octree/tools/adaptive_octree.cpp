@@ -102,10 +102,11 @@ void adaptive_octree(vector<char>& octree_output, const vector<char>& octree_inp
   const int* node_num_accu = nnum_accu_vec.data();
   const unsigned int* key = parser_in.key(0);
   const int* children = parser_in.child(0);
-  const float* data = parser_in.feature(0);
+  vector<float> feature_buf, label_buf;  // for the fp16 or int8/int16 data
+  const float* data = parser_in.float_ptr(feature_buf, OctreeInfo::kFeature, depth);
   const float* normal_ptr = data; // !!! channel x n
   const float* dis_ptr = normal_ptr + 3 * final_node_num;
-  const float* label_ptr = parser_in.label(0);
+  const float* label_ptr = parser_in.float_ptr(label_buf, OctreeInfo::kLabel, depth);
 
   /// precompute the nodes in the depth layer covered by each octree node
   vector<vector<int>> dnum_, didx_;
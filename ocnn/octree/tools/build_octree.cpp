@@ -6,6 +6,7 @@
 
 #include "cmd_flags.h"
 #include "octree.h"
+#include "octree_archive.h"
 #include "util.h"
 
 using std::vector;
@@ -30,6 +31,10 @@ DEFINE_int(adp_depth, kOptional, 4, "The starting depth of adaptive octree");
 DEFINE_float(th_distance, kOptional, 2.0f, "The threshold for simplifying octree");
 DEFINE_float(th_normal, kOptional, 0.1f, "The threshold for simplifying octree");
 DEFINE_bool(key2xyz, kOptional, false, "Convert the key to xyz when serialization");
+DEFINE_string(feature_dtype, kOptional, "float", "The element type of the features: float, half, int16 or int8");
+DEFINE_string(archive, kOptional, "", "Pack the octrees into this archive instead of writing files");
+DEFINE_int(label, kOptional, 0, "The label of the octrees stored in the archive");
+DEFINE_bool(append, kOptional, false, "Append the octrees to an existing archive");
 DEFINE_bool(verbose, kOptional, true, "Output logs");
 
 
@@ -81,24 +86,50 @@ class OctreeBuilder {
     float bbmin[] = { -radius_, -radius_, -radius_ };
     float bbmax[] = { radius_, radius_, radius_ };
     octree_info_.set_bbox(bbmin, bbmax);
+
+    // the scale of int16/int8 is computed from the features when serializing
+    if (octree_info_.has_property(OctreeInfo::kFeature)) {
+      octree_info_.set_dtype(OctreeInfo::kFeature, feature_dtype());
+    }
   }
 
-  void build_octree() {
-    octree_.build(octree_info_, point_cloud_);
+  DataType feature_dtype() {
+    if (FLAGS_feature_dtype == "half") return kFloat16;
+    if (FLAGS_feature_dtype == "int16") return kInt16;
+    if (FLAGS_feature_dtype == "int8") return kInt8;
+    return kFloat32;
   }
 
-  void save_octree(const string& output_filename) {
+  void build_octrees(const vector<float>& rotations) {
+    octree_.build_poses(octrees_, octree_info_, point_cloud_, rotations);
+  }
+
+  void save_octree(const int pose, const string& output_filename) {
     // Modify the bounding box before saving, because the center of
     // the point cloud is translated to (0, 0, 0) when building the octree
-    octree_.mutable_info().set_bbox(radius_, center_);
-    octree_.write_octree(output_filename);
+    parser_.set_octree(octrees_[pose]); // swap data, no copy
+    parser_.mutable_info().set_bbox(radius_, center_);
+    parser_.write_octree(output_filename);
+    parser_.set_octree(octrees_[pose]); // swap back, reused by the next file
+  }
+
+  bool add_octree(const int pose, const string& name, OctreeArchiveWriter& writer) {
+    parser_.set_octree(octrees_[pose]);
+    parser_.mutable_info().set_bbox(radius_, center_);
+    const vector<char>& buffer = parser_.buffer();
+    bool succ = writer.add(buffer.data(), buffer.size(), name, FLAGS_label, pose);
+    parser_.set_octree(octrees_[pose]);
+    return succ;
   }
 
  public:
+  // the members are reused by the files processed with the same builder
   Points point_cloud_;
   float radius_, center_[3];
   OctreeInfo octree_info_;
   Octree octree_;
+  vector<vector<char> > octrees_;
+  OctreeParser parser_;
 };
 
 
@@ -119,41 +150,72 @@ int main(int argc, char* argv[]) {
   vector<string> all_files;
   get_all_filenames(all_files, file_path);
 
-  #pragma omp parallel for
-  for (int i = 0; i < all_files.size(); i++) {
+  OctreeArchiveWriter writer;
+  const bool use_archive = !FLAGS_archive.empty();
+  if (use_archive && !writer.open(FLAGS_archive, FLAGS_append)) {
+    cout << "Can not open " << FLAGS_archive << endl;
+    return 1;
+  }
+
+  // one builder per thread, whose memory is reused by the files of the thread;
+  // the octrees are built in parallel, and added to the archive in file order
+  bool archive_failed = false;
+  #pragma omp parallel
+  {
     OctreeBuilder builder;
-    bool succ = builder.set_point_cloud(all_files[i]);
-    if (!succ) continue;
-    builder.set_octree_info();
-
-    // data augmentation
-    float angle = 2.0f * kPI / float(FLAGS_rot_num);
-    float axis[] = { 0.0f, 0.0f, 0.0f };
-    if (FLAGS_axis == "x") axis[0] = 1.0f;
-    else if (FLAGS_axis == "y") axis[1] = 1.0f;
-    else axis[2] = 1.0f;
-
-    string filename = extract_filename(all_files[i]);
-    if (FLAGS_verbose) cout << "Processing: " << filename << std::endl;
-    for (int v = 0; v < FLAGS_rot_num; ++v) {
-      // output filename
-      char file_suffix[64];
-      sprintf(file_suffix, "_%d_%d_%03d.octree", FLAGS_depth, FLAGS_full_depth, v);
-
-      // build
-      builder.build_octree();
-
-      // save octree
-      builder.save_octree(output_path + filename + file_suffix);
-
-      // rotate point for the next iteration
-      builder.point_cloud_.rotate(angle, axis);
-
-      // message
-      //cout << "Processing: " << filename.substr(filename.rfind('\\') + 1) << endl;
+    #pragma omp for ordered schedule(dynamic)
+    for (int i = 0; i < all_files.size(); i++) {
+      bool succ = builder.set_point_cloud(all_files[i]);
+      if (!succ) continue;
+      builder.set_octree_info();
+
+      // data augmentation
+      float angle = 2.0f * kPI / float(FLAGS_rot_num);
+      float axis[] = { 0.0f, 0.0f, 0.0f };
+      if (FLAGS_axis == "x") axis[0] = 1.0f;
+      else if (FLAGS_axis == "y") axis[1] = 1.0f;
+      else axis[2] = 1.0f;
+      vector<float> rotations(9 * FLAGS_rot_num);
+      for (int v = 0; v < FLAGS_rot_num; ++v) {
+        rotation_matrix(rotations.data() + 9 * v, angle * v, axis);
+      }
+
+      string filename = extract_filename(all_files[i]);
+      if (FLAGS_verbose) cout << "Processing: " << filename << std::endl;
+
+      // build all the poses in one call
+      builder.build_octrees(rotations);
+
+      if (use_archive) {
+        #pragma omp ordered
+        for (int v = 0; v < FLAGS_rot_num && !archive_failed; ++v) {
+          char file_suffix[64];
+          sprintf(file_suffix, "_%d_%d_%03d.octree", FLAGS_depth, FLAGS_full_depth, v);
+          if (!builder.add_octree(v, filename + file_suffix, writer)) {
+            cout << "Can not add " << filename + file_suffix << " to "
+                 << FLAGS_archive << endl;
+            archive_failed = true;
+          }
+        }
+        continue;
+      }
+
+      for (int v = 0; v < FLAGS_rot_num; ++v) {
+        // output filename
+        char file_suffix[64];
+        sprintf(file_suffix, "_%d_%d_%03d.octree", FLAGS_depth, FLAGS_full_depth, v);
+
+        // save octree
+        builder.save_octree(v, output_path + filename + file_suffix);
+      }
     }
   }
 
+  if (use_archive && (!writer.close() || archive_failed)) {
+    cout << "Can not write " << FLAGS_archive << endl;
+    return 1;
+  }
+
   cout << "Done: " << FLAGS_filenames << endl;
   return 0;
 }
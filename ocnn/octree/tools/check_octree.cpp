@@ -31,7 +31,7 @@ int main(int argc, char* argv[]) {
 
     // load octree
     Octree octree;
-    bool succ = octree.read_octree(all_files[i]);
+    bool succ = octree.read_octree(all_files[i], true);
     if (!succ) {
       cout << "Can not load " << filename << std::endl;
       continue;
@@ -80,6 +80,14 @@ int main(int argc, char* argv[]) {
     for (int j = 0; j < OctreeInfo::kPTypeNum; ++j) {
       cout << octree.info().locations(static_cast<OctreeInfo::PropType>(1 << j)) << " ";
     }
+    cout << endl << "dtypes: ";
+    for (int j = 0; j < OctreeInfo::kPTypeNum; ++j) {
+      cout << octree.info().dtype(static_cast<OctreeInfo::PropType>(1 << j)) << " ";
+    }
+    cout << endl << "scales: ";
+    for (int j = 0; j < OctreeInfo::kPTypeNum; ++j) {
+      cout << octree.info().scale(static_cast<OctreeInfo::PropType>(1 << j)) << " ";
+    }
     cout << endl << "bbox_max_width: " << octree.info().bbox_max_width() << endl;
     cout << "key2xyz: " << octree.info().key2xyz() << endl;
     cout << "sizeof_octree: " << octree.info().sizeof_octree() << endl;
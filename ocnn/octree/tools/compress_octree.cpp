@@ -0,0 +1,65 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "util.h"
+#include "octree_parser.h"
+#include "cmd_flags.h"
+
+using namespace std;
+
+DEFINE_string(filenames, kRequired, "", "The input filenames");
+DEFINE_string(output_path, kOptional, ".", "The output path");
+DEFINE_int(quant_bits, kOptional, 0, "Quantize the features to 8 or 16 bits, 0 is lossless");
+DEFINE_bool(decompress, kOptional, false, "Convert the compact octrees back");
+DEFINE_bool(verbose, kOptional, true, "Output logs");
+
+
+int main(int argc, char* argv[]) {
+  bool succ = cflags::ParseCmd(argc, argv);
+  if (!succ) {
+    cflags::PrintHelpInfo("\nUsage: compress_octree.exe");
+    return 0;
+  }
+
+  // file path
+  string file_path = FLAGS_filenames;
+  string output_path = FLAGS_output_path;
+  if (output_path != ".") mkdir(output_path);
+  else output_path = extract_path(file_path);
+  output_path += "/";
+
+  vector<string> all_files;
+  get_all_filenames(all_files, file_path);
+
+  for (int i = 0; i < all_files.size(); i++) {
+    string filename = extract_filename(all_files[i]);
+    if (FLAGS_verbose) cout << "Processing: " << filename << std::endl;
+
+    // load octree, the compact octree is decoded by read_octree()
+    OctreeParser octree;
+    bool succ = octree.read_octree(all_files[i], true);
+    if (!succ) {
+      if (FLAGS_verbose) cout << "Can not load " << filename << std::endl;
+      continue;
+    }
+    string msg;
+    succ = octree.info().check_format(msg);
+    if (!succ) {
+      if (FLAGS_verbose) cout << filename << std::endl << msg << std::endl;
+      continue;
+    }
+
+    // save octree
+    if (FLAGS_decompress) {
+      filename = output_path + filename + "_raw.octree";
+      succ = octree.write_octree(filename);
+    } else {
+      filename = output_path + filename + "_cz.octree";
+      succ = octree.write_octree_compact(filename, FLAGS_quant_bits);
+    }
+    if (!succ && FLAGS_verbose) cout << "Can not save " << filename << std::endl;
+  }
+
+  return 0;
+}
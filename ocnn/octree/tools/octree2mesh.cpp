@@ -43,7 +43,7 @@ int main(int argc, char* argv[]) {
 
     // load octree
     Octree octree;
-    bool succ = octree.read_octree(all_files[i]);
+    bool succ = octree.read_octree(all_files[i], true);
     if (!succ) {
       cout << "Can not load " << filename << std::endl;
       continue;
@@ -37,9 +37,11 @@ int main(int argc, char* argv[]) {
     string filename = extract_filename(all_files[i]);;
     if (FLAGS_verbose) cout << "Processing: " << filename << std::endl;
 
-    // load octree
+    // load octree, the split labels and neighbors are not needed
     Octree octree;
-    bool succ = octree.read_octree(all_files[i]);
+    const int content_flags = OctreeInfo::kKey | OctreeInfo::kChild |
+        OctreeInfo::kFeature | OctreeInfo::kLabel;
+    bool succ = octree.read_octree_partial(all_files[i], content_flags);
     if (!succ) {
       if (FLAGS_verbose) cout << "Can not load " << filename << std::endl;
       continue;
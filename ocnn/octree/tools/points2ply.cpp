@@ -33,7 +33,7 @@ int main(int argc, char* argv[]) {
 
   for (int i = 0; i < all_files.size(); i++) {
     Points pts;
-    pts.read_points(all_files[i]);
+    pts.read_points(all_files[i], true);
 
     string filename = extract_filename(all_files[i]);
     if (FLAGS_verbose) cout << "Processing: " << filename << std::endl;